@@ -0,0 +1,94 @@
+/// CovarianceTracker
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Windowed covariance and correlation between channels (e.g. x, y and z axes), O(1) to read
+public class CovarianceTracker {
+    
+    private var tracker: OpaquePointer
+    private var numChannels: Int
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter windowSize: Number of latest samples
+    /// - parameter numChannels: Number of channels (at most 8), e.g. 2 for a pair or 3 for x, y and z
+    init(windowSize: Int, numChannels: Int) {
+        self.numChannels = numChannels
+        self.tracker = covtrack_new(windowSize, numChannels)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        covtrack_free_unsafe(self.tracker)
+    }
+    
+    // MARK: Regular operations
+    
+    /// Push new sample of all channels
+    func push(_ values: [Float]) {
+        assert (values.count == self.numChannels)
+        covtrack_push(self.tracker, values)
+    }
+    
+    
+    /// Push samples interleaved channel by channel, e.g. [x0, y0, z0, x1, y1, z1, ...]
+    func pushBatch(_ values: [Float]) {
+        assert (values.count % self.numChannels == 0)
+        covtrack_push_batch(self.tracker, values, values.count / self.numChannels)
+    }
+    
+    
+    /// Reset window to zeros
+    func clear() {
+        covtrack_clear(self.tracker)
+    }
+    
+    // MARK: Statistics
+    
+    /// Mean of channel
+    func mean(_ channel: Int) -> Float {
+        return covtrack_mean(self.tracker, channel)
+    }
+    
+    
+    /// Variance of channel
+    func variance(_ channel: Int) -> Float {
+        return covtrack_variance(self.tracker, channel)
+    }
+    
+    
+    /// Covariance of two channels
+    func covariance(_ i: Int, _ j: Int) -> Float {
+        return covtrack_covariance(self.tracker, i, j)
+    }
+    
+    
+    /// Pearson correlation of two channels
+    func correlation(_ i: Int, _ j: Int) -> Float {
+        return covtrack_correlation(self.tracker, i, j)
+    }
+    
+    
+    /// Covariance matrix, numChannels x numChannels row major
+    var covarianceMatrix: [Float] {
+        var output = [Float](repeating: 0.0, count: self.numChannels * self.numChannels)
+        covtrack_covariance_matrix(self.tracker, &output)
+        return output
+    }
+    
+    
+    /// Correlation matrix, numChannels x numChannels row major
+    var correlationMatrix: [Float] {
+        var output = [Float](repeating: 0.0, count: self.numChannels * self.numChannels)
+        covtrack_correlation_matrix(self.tracker, &output)
+        return output
+    }
+}
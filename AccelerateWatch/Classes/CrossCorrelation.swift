@@ -0,0 +1,71 @@
+/// CrossCorrelation
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Cross-correlation and lag estimation between two signals of same size
+public class CrossCorrelation {
+    
+    private var xcorr: OpaquePointer
+    private var size: Int
+    private var maxLag: Int
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter size: Size of signals
+    /// - parameter maxLag: Lags within [-maxLag, maxLag] are evaluated
+    ///
+    /// FFT or direct dot products are chosen automatically, whichever is cheaper.
+    init(size: Int, maxLag: Int) {
+        self.size = size
+        self.maxLag = maxLag
+        self.xcorr = xcorr_new(size, maxLag, XCORR_AUTO)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        xcorr_free_unsafe(self.xcorr)
+    }
+    
+    // MARK: Operations
+    
+    /// Cross-correlation r[k] = sum(x[t] * y[t+k]) for k = -maxLag...maxLag
+    ///
+    /// - returns: array of size 2*maxLag+1, lag 0 at index maxLag
+    func correlate(_ x: [Float], _ y: [Float]) -> [Float] {
+        assert (x.count == self.size && y.count == self.size)
+        var output = [Float](repeating: 0.0, count: 2*self.maxLag+1)
+        xcorr_compute(self.xcorr, x, y, &output)
+        return output
+    }
+    
+    
+    /// Cross-correlation of data of two buffers
+    func correlate(_ x: DSBuffer, _ y: DSBuffer) -> [Float] {
+        assert (x.bufferSize == self.size && y.bufferSize == self.size)
+        var output = [Float](repeating: 0.0, count: 2*self.maxLag+1)
+        xcorr_compute_buffers(self.xcorr, x.buffer, y.buffer, &output)
+        return output
+    }
+    
+    
+    /// Lag of maximum cross-correlation with sub-sample precision. Positive if y is delayed relative to x.
+    func bestLag(_ x: [Float], _ y: [Float]) -> Float {
+        assert (x.count == self.size && y.count == self.size)
+        return xcorr_best_lag(self.xcorr, x, y, nil)
+    }
+    
+    
+    /// Lag of maximum cross-correlation between data of two buffers
+    func bestLag(_ x: DSBuffer, _ y: DSBuffer) -> Float {
+        assert (x.bufferSize == self.size && y.bufferSize == self.size)
+        return xcorr_best_lag_buffers(self.xcorr, x.buffer, y.buffer, nil)
+    }
+}
@@ -7,15 +7,41 @@
 import Foundation
 
 
+/// Window functions applied to buffer data before FFT
+public enum WindowFunction {
+    case rectangular
+    case hann
+    case hamming
+    case blackmanHarris
+    case kaiser(beta: Float)
+    case flatTop
+    
+    // C window type and parameter
+    var cValue: (type: window_type, param: Float) {
+        switch self {
+        case .rectangular: return (WINDOW_RECTANGULAR, 0)
+        case .hann: return (WINDOW_HANN, 0)
+        case .hamming: return (WINDOW_HAMMING, 0)
+        case .blackmanHarris: return (WINDOW_BLACKMAN_HARRIS, 0)
+        case .kaiser(let beta): return (WINDOW_KAISER, beta)
+        case .flatTop: return (WINDOW_FLAT_TOP, 0)
+        }
+    }
+}
+
+
 /// Fixed-length buffer for windowed signal processing
 public class DSBuffer {
     
-    private var buffer: OpaquePointer
+    private(set) var buffer: OpaquePointer
     private var size: Int
     
     private var fftIsSupported: Bool
     private var fftData: [dsbuffer_complex]?
     private var fftIsUpdated: Bool?
+    private var windowCoherentGain: Float = 1.0
+    private var windowPowerGain: Float = 1.0
+    private var zoomFFTData: [dsbuffer_complex]?
     
     // MARK: Initializer and deinitializer
     
@@ -92,6 +118,12 @@ public class DSBuffer {
     }
     
     
+    /// Accumulate sums (mean, variance, energy, FIR filter, ...) in Double, e.g. for long windows. Data is still stored as Float.
+    func setupDoubleAccumulation(_ enable: Bool) {
+        dsbuffer_setup_double_accumulation(self.buffer, enable)
+    }
+    
+    
     /// Print buffer
     func printBuffer(_ dataFormat: String) {
         print("DSBuffer size: \(self.size)")
@@ -120,6 +152,24 @@ public class DSBuffer {
     }
     
     
+    /// Add vector (of buffer size) to buffer data element-wise
+    func add(vector: [Float]) -> [Float] {
+        assert(vector.count == self.size)
+        var result = [Float](repeating: 0.0, count: self.size)
+        dsbuffer_add_vector(self.buffer, vector, &result)
+        return result
+    }
+    
+    
+    /// Multiply buffer data with vector (of buffer size) element-wise, e.g. a window
+    func multiply(vector: [Float]) -> [Float] {
+        assert(vector.count == self.size)
+        var result = [Float](repeating: 0.0, count: self.size)
+        dsbuffer_multiply_vector(self.buffer, vector, &result)
+        return result
+    }
+    
+    
     /// Modulus by value of each buffer data
     func mod(_ withValue: Float) -> [Float] {
         var result = [Float](repeating: 0.0, count: self.size)
@@ -213,13 +263,25 @@ public class DSBuffer {
     }
     
     
+    /// Compute several time-domain features in one pass over buffer data
+    ///
+    /// - parameter mask: dsbuffer_feature flags, e.g. DSBUFFER_FEATURE_ALL.rawValue
+    /// - returns: Mean, variance, std, max, min, energy, rms, skewness, excess kurtosis, zero and mean crossing rates. Fields not in mask are 0.
+    func features(_ mask: UInt32 = DSBUFFER_FEATURE_ALL.rawValue) -> dsbuffer_time_features {
+        var features = dsbuffer_time_features()
+        dsbuffer_features(self.buffer, mask, &features)
+        return features
+    }
+    
+    
     // MARK: FFT & frequency-domain features
     
     // Perform FFT if it is not updated
     private func updateFFT() {
         assert (self.fftIsSupported)
         if (!self.fftIsUpdated!) {
-            _ = fft()
+            dsbuffer_fftr(self.buffer, &self.fftData!)
+            self.fftIsUpdated = true
         }
     }
     
@@ -239,6 +301,56 @@ public class DSBuffer {
     }
     
     
+    /// Inverse FFT, i.e. the signal whose fft() is (real, imaginary)
+    ///
+    /// - parameter real: Real parts of size/2+1 frequency bins
+    /// - parameter imaginary: Imaginary parts of size/2+1 frequency bins
+    /// - returns: array of buffer size
+    func ifft(_ real: [Float], imaginary: [Float]) -> [Float] {
+        assert (self.fftIsSupported, "FFT is not supported on this buffer")
+        assert (real.count == self.size/2+1 && imaginary.count == self.size/2+1)
+        let spectrum = (0..<real.count).map{dsbuffer_complex(real: real[$0], imag: imaginary[$0])}
+        var output = [Float](repeating: 0.0, count: self.size)
+        dsbuffer_ifftr(self.buffer, spectrum, &output)
+        return output
+    }
+    
+    
+    /// Filter buffer in frequency domain: multiply spectrum by mask and transform back
+    ///
+    /// Cheaper than FIR filtering for wide masks on long buffers. Filtering is circular over the buffer, and window is not applied.
+    ///
+    /// - parameter mask: Real gains of size/2+1 frequency bins
+    /// - parameter output: Array of buffer size which receives the filtered signal
+    func FFTFilter(_ mask: [Float], output: inout [Float]) {
+        assert (self.fftIsSupported, "FFT is not supported on this buffer")
+        assert (mask.count == self.size/2+1)
+        assert (output.count == self.size)
+        dsbuffer_fft_filter(self.buffer, mask, &output)
+    }
+    
+    
+    /// Buffer filtered in frequency domain by mask of size/2+1 real gains
+    func FFTFiltered(_ mask: [Float]) -> [Float] {
+        var output = [Float](repeating: 0.0, count: self.size)
+        FFTFilter(mask, output: &output)
+        return output
+    }
+    
+    
+    /// Setup window function which is applied to buffer data before FFT
+    ///
+    /// Spectra from squaredPowerSpectrum, meanSquaredPowerSpectrum, powerSpectralDensity and averageBandPower are corrected for the gain of the window.
+    func setupWindow(_ window: WindowFunction) {
+        assert (self.fftIsSupported, "FFT is not supported on this buffer")
+        let (windowType, windowParam) = window.cValue
+        dsbuffer_setup_window(self.buffer, windowType, windowParam)
+        self.windowCoherentGain = dsbuffer_window_coherent_gain(self.buffer)
+        self.windowPowerGain = dsbuffer_window_power_gain(self.buffer)
+        self.fftIsUpdated = false
+    }
+    
+    
     /// FFT sample frequencies
     ///
     /// - returns: array of size nfft/2+1
@@ -264,7 +376,8 @@ public class DSBuffer {
     /// - returns: array of size nfft/2+1
     func squaredPowerSpectrum() -> [Float] {
         updateFFT()
-        var sps = self.fftData!.map{($0.real*$0.real + $0.imag*$0.imag) * 2}
+        let scale = 2 / (self.windowCoherentGain * self.windowCoherentGain)
+        var sps = self.fftData!.map{($0.real*$0.real + $0.imag*$0.imag) * scale}
         sps[0] /= 2.0 // DC
         return sps
     }
@@ -275,7 +388,8 @@ public class DSBuffer {
     /// - returns: array of size nfft/2+1
     func meanSquaredPowerSpectrum() -> [Float] {
         updateFFT()
-        var pxx = self.fftData!.map{($0.real*$0.real + $0.imag*$0.imag) * 2 / Float(self.size)}
+        let scale = 2 / (Float(self.size) * self.windowCoherentGain * self.windowCoherentGain)
+        var pxx = self.fftData!.map{($0.real*$0.real + $0.imag*$0.imag) * scale}
         pxx[0] /= 2.0 // DC
         return pxx
     }
@@ -286,12 +400,66 @@ public class DSBuffer {
     /// - returns: array of size nfft/2+1
     func powerSpectralDensity(_ fs: Float) -> [Float] {
         updateFFT()
-        var psd = self.fftData!.map{($0.real*$0.real + $0.imag*$0.imag) * 2.0 / (fs * Float(self.size))}
+        let scale = 2.0 / (fs * Float(self.size) * self.windowPowerGain)
+        var psd = self.fftData!.map{($0.real*$0.real + $0.imag*$0.imag) * scale}
         psd[0] /= 2.0 // DC
         return psd
     }
     
     
+    /// Setup zoom FFT (chirp-z transform) which evaluates the spectrum on a dense frequency grid over a narrow band
+    ///
+    /// - parameter fs: Sampling frequency
+    /// - parameter fromFreq: Lowest frequency of the band
+    /// - parameter toFreq: Highest frequency of the band (inclusive)
+    /// - parameter numBins: Number of frequencies evenly spaced over the band
+    func setupZoomFFT(_ fs: Float, fromFreq: Float, toFreq: Float, numBins: Int) {
+        assert (self.fftIsSupported, "FFT is not supported on this buffer")
+        assert (fromFreq <= toFreq)
+        assert (numBins > 0)
+        dsbuffer_setup_zoom_fft(self.buffer, fs, fromFreq, toFreq, numBins)
+        self.zoomFFTData = [dsbuffer_complex](repeating: dsbuffer_complex(real: 0.0, imag: 0.0), count: numBins)
+    }
+    
+    
+    /// Perform zoom FFT. Call setupZoomFFT first.
+    ///
+    /// - returns: numBins complex frequency bins
+    func zoomFFT() -> (real: [Float], imaginary: [Float]) {
+        assert (self.zoomFFTData != nil, "Zoom FFT is not setup")
+        dsbuffer_zoom_fft(self.buffer, &self.zoomFFTData!)
+        return (self.zoomFFTData!.map{$0.real}, self.zoomFFTData!.map{$0.imag})
+    }
+    
+    
+    /// Zoom FFT sample frequencies
+    ///
+    /// - returns: array of size numBins
+    func zoomFFTFrequencies() -> [Float] {
+        assert (self.zoomFFTData != nil, "Zoom FFT is not setup")
+        var freq = [Float](repeating: 0.0, count: self.zoomFFTData!.count)
+        dsbuffer_zoom_fft_freq(self.buffer, &freq)
+        return freq
+    }
+    
+    
+    /// Spectral features computed in a single pass over the FFT, without allocation
+    ///
+    /// - parameter fs: Sampling frequency
+    /// - parameter bandEdges: numBands+1 ascending frequencies for band powers (at most 8 bands)
+    /// - parameter rolloffRatio: Fraction of power below the roll-off frequency
+    /// - parameter numPeaks: Number of strongest spectral peaks reported (at most 8)
+    /// - returns: Total power, band powers, centroid, spread, flatness, entropy, roll-off and peaks. Power is not corrected for window gain.
+    func spectralFeatures(_ fs: Float, bandEdges: [Float] = [], rolloffRatio: Float = 0.85, numPeaks: Int = 3) -> dsbuffer_spectral_features {
+        assert (bandEdges.count <= Int(DSBUFFER_MAX_BANDS) + 1)
+        assert (numPeaks <= Int(DSBUFFER_MAX_PEAKS))
+        updateFFT()
+        var features = dsbuffer_spectral_features()
+        dsbuffer_fft_features(self.fftData!, self.size/2+1, fs, bandEdges, Swift.max(bandEdges.count-1, 0), rolloffRatio, numPeaks, &features)
+        return features
+    }
+    
+    
     /// Average power over specific frequency band, i.e. mean(abs(fft(from...to))^2)
     func averageBandPower(_ fromFreq: Float = 0, toFreq: Float, fs: Float) -> Float {
         assert (fromFreq >= 0)
@@ -308,7 +476,121 @@ public class DSBuffer {
         let bandPower = self.fftData![fromIdx...toIdx].map{$0.real*$0.real+$0.imag*$0.imag}
         
         // Averaging
-        return bandPower.reduce(0.0, +) / Float(toIdx - fromIdx + 1)
+        return bandPower.reduce(0.0, +) / (Float(toIdx - fromIdx + 1) * self.windowCoherentGain * self.windowCoherentGain)
+    }
+    
+    
+    // MARK: Autocorrelation
+    
+    /// Autocorrelation for lags 0...maxLag, computed by FFT
+    ///
+    /// - parameter maxLag: Largest lag, less than buffer size
+    /// - parameter centralized: Should remove mean?
+    /// - parameter unbiased: Divide lag k by (size-k) instead of size?
+    /// - returns: array of size maxLag+1
+    func autocorrelation(_ maxLag: Int, centralized: Bool = true, unbiased: Bool = false) -> [Float] {
+        assert (maxLag < self.size)
+        var output = [Float](repeating: 0.0, count: maxLag+1)
+        dsbuffer_autocorrelation(self.buffer, maxLag, centralized, unbiased, &output)
+        return output
+    }
+    
+    
+    /// Lag of the first dominant autocorrelation peak (e.g. period in samples), 0 if none
+    ///
+    /// - parameter maxLag: Largest lag searched
+    /// - parameter threshold: Fraction of the highest peak that the first peak must reach
+    func autocorrelationPeakLag(_ maxLag: Int, threshold: Float = 0.8) -> Float {
+        let acf = autocorrelation(maxLag)
+        return dsbuffer_autocorrelation_peak(acf, acf.count, threshold, nil)
+    }
+    
+    
+    // MARK: Analytic signal
+    
+    /// Amplitude envelope and unwrapped instantaneous phase (radians) of buffer data by Hilbert transform
+    func analyticSignal() -> (envelope: [Float], phase: [Float]) {
+        var envelope = [Float](repeating: 0.0, count: self.size)
+        var phase = [Float](repeating: 0.0, count: self.size)
+        dsbuffer_analytic_signal(self.buffer, &envelope, &phase)
+        return (envelope, phase)
+    }
+    
+    
+    /// Amplitude envelope of buffer data
+    func envelope() -> [Float] {
+        var envelope = [Float](repeating: 0.0, count: self.size)
+        dsbuffer_analytic_signal(self.buffer, &envelope, nil)
+        return envelope
+    }
+    
+    
+    /// Instantaneous frequency (Hz) as phase difference between adjacent samples (size-1 points)
+    ///
+    /// - parameter fs: Sampling frequency
+    func instantaneousFrequency(_ fs: Float) -> [Float] {
+        var phase = [Float](repeating: 0.0, count: self.size)
+        dsbuffer_analytic_signal(self.buffer, nil, &phase)
+        let scale = fs / (2 * Float.pi)
+        return (1..<phase.count).map { (phase[$0] - phase[$0-1]) * scale }
+    }
+    
+    
+    // MARK: Order statistics
+    
+    /// Setup order statistics of the latest windowSize values, updated by each push in O(log N)
+    ///
+    /// - parameter windowSize: Number of latest values (at most buffer size), e.g. buffer size for percentiles of the whole buffer, or a few for a median filter
+    func setupOrderStatistics(_ windowSize: Int) {
+        assert (windowSize > 0 && windowSize <= self.size)
+        dsbuffer_setup_order_statistics(self.buffer, windowSize)
+    }
+    
+    
+    /// Quantile (0...1) of the latest windowSize values, e.g. 0.1 and 0.9 for a robust range
+    func quantile(_ q: Float) -> Float {
+        return dsbuffer_quantile(self.buffer, q)
+    }
+    
+    
+    /// k-th smallest of the latest windowSize values
+    func orderStatistic(_ k: Int) -> Float {
+        return dsbuffer_order_statistic(self.buffer, k)
+    }
+    
+    
+    /// Get latest median filter output, i.e. median of the latest windowSize values
+    func latestMedianOutput() -> Float {
+        return dsbuffer_latest_median_output(self.buffer)
+    }
+    
+    
+    // MARK: Peak detection
+    
+    /// Setup streaming peak (e.g. step or tap) detection on pushed values, O(1) per push
+    ///
+    /// - parameter minHeight: Minimum peak value
+    /// - parameter minProminence: Minimum rise before and drop after a peak. A peak is reported after the drop.
+    /// - parameter minDistance: Refractory period in samples after a peak
+    /// - parameter thresholdK: Peak must also exceed running mean + thresholdK * running std (0 to disable)
+    /// - parameter thresholdWindow: Number of samples of running mean and std
+    /// - parameter maxPeaks: Number of recent peaks kept
+    func setupPeakDetector(minHeight: Float = -Float.infinity, minProminence: Float, minDistance: Int = 0, thresholdK: Float = 0, thresholdWindow: Int = 0, maxPeaks: Int = 8) {
+        dsbuffer_setup_peak_detector(self.buffer, minHeight, minProminence, minDistance, thresholdK, thresholdWindow, maxPeaks)
+    }
+    
+    
+    /// Total number of peaks detected since setup or clear
+    var peakCount: Int {
+        return dsbuffer_peak_count(self.buffer)
+    }
+    
+    
+    /// Recent peaks, latest first. Age is the number of samples pushed after the peak.
+    func recentPeaks(_ maxPeaks: Int = 8) -> [peakdetect_peak_t] {
+        var peaks = [peakdetect_peak_t](repeating: peakdetect_peak_t(), count: maxPeaks)
+        let n = dsbuffer_recent_peaks(self.buffer, &peaks, maxPeaks)
+        return Array(peaks[0..<n])
     }
     
     
@@ -0,0 +1,147 @@
+/// DSBuffer16
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Fixed-length buffer of raw Int16 samples (e.g. quantized sensor values), using half the memory of DSBuffer
+public class DSBuffer16 {
+    
+    private(set) var buffer: OpaquePointer
+    private var size: Int
+    private var firTaps: UnsafeMutablePointer<Int16>?
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter size: Buffer length (at most 65536). If you set fftIsSupperted to be true, the size should be **even** number
+    /// - parameter fftIsSupported: Whether FFT will be performed on the buffer
+    init(_ size: Int, fftIsSupported: Bool = true) {
+        assert (size <= 65536)
+        self.size = (fftIsSupported && size % 2 == 1) ? size + 1 : size
+        self.buffer = dsbuffer16_new(self.size, fftIsSupported)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        dsbuffer16_free_unsafe(self.buffer)
+        firTaps?.deallocate()
+    }
+    
+    
+    // MARK: Buffer operations
+    
+    /// Push new value to buffer
+    func push(_ value: Int16) {
+        dsbuffer16_push(self.buffer, value)
+    }
+    
+    
+    /// Get data by index
+    func dataAt(_ index: Int) -> Int16 {
+        return dsbuffer16_at(self.buffer, index)
+    }
+    
+    
+    /// Get all data as array
+    var data: [Int16] {
+        var output = [Int16](repeating: 0, count: self.size)
+        dsbuffer16_dump(self.buffer, &output)
+        return output
+    }
+    
+    
+    /// Reset buffer to be zero filled
+    func clear() {
+        dsbuffer16_clear(self.buffer)
+    }
+    
+    
+    // MARK: Time-domain features
+    
+    /// Summation of buffer
+    func sum() -> Int32 {
+        return dsbuffer16_sum(self.buffer)
+    }
+    
+    
+    /// Squared length of buffer as vector
+    func energy() -> Int64 {
+        return dsbuffer16_energy(self.buffer)
+    }
+    
+    
+    /// Max value
+    func max() -> Int16 {
+        return dsbuffer16_max(self.buffer)
+    }
+    
+    
+    /// Min value
+    func min() -> Int16 {
+        return dsbuffer16_min(self.buffer)
+    }
+    
+    
+    /// Mean value
+    func mean() -> Float {
+        return dsbuffer16_mean(self.buffer)
+    }
+    
+    
+    /// Variance
+    func variance() -> Float {
+        return dsbuffer16_variance(self.buffer)
+    }
+    
+    
+    /// Standard deviation
+    func std() -> Float {
+        return dsbuffer16_std(self.buffer)
+    }
+    
+    
+    // MARK: FFT
+    
+    /// Q15 FFT of buffer data, scaled by 1/size
+    func fft() -> [dsbuffer16_complex] {
+        var output = [dsbuffer16_complex](repeating: dsbuffer16_complex(real: 0, imag: 0), count: self.size/2+1)
+        dsbuffer16_fftr(self.buffer, &output)
+        return output
+    }
+    
+    
+    // MARK: FIR filter
+    
+    /// Setup FIR filter
+    ///
+    /// - parameter FIRTaps: Taps in fixed point
+    /// - parameter fractionalBits: Number of fractional bits of taps, e.g. 15 for Q15
+    func setupFIRFilter(_ FIRTaps: [Int16], fractionalBits: Int = 15) {
+        assert (self.size >= FIRTaps.count)
+        firTaps?.deallocate()
+        let taps = UnsafeMutablePointer<Int16>.allocate(capacity: FIRTaps.count)
+        taps.initialize(from: FIRTaps, count: FIRTaps.count)
+        firTaps = taps
+        dsbuffer16_setup_fir(self.buffer, taps, FIRTaps.count, Int32(fractionalBits))
+    }
+    
+    
+    /// Get latest FIR output
+    func latestFIROutput() -> Int16 {
+        return dsbuffer16_latest_fir_output(self.buffer)
+    }
+    
+    
+    /// FIR filtered buffer
+    func FIRFiltered() -> [Int16] {
+        var output = [Int16](repeating: 0, count: self.size)
+        dsbuffer16_fir_filter(self.buffer, &output)
+        return output
+    }
+}
@@ -0,0 +1,79 @@
+/// DTW
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Nearest template search by dynamic time warping, e.g. for gestures performed at varying speed
+public class DTW {
+    
+    private var dtw: OpaquePointer
+    private var length: Int
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter length: Length of queries and templates
+    /// - parameter band: Maximum warping in samples (Sakoe-Chiba band), e.g. 10% of length
+    /// - parameter maxTemplates: Maximum number of templates
+    /// - parameter normalize: Whether queries and templates are z-normalized
+    init(length: Int, band: Int, maxTemplates: Int, normalize: Bool = true) {
+        self.length = length
+        self.dtw = dtw_new(length, band, maxTemplates, normalize)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        dtw_free_unsafe(self.dtw)
+    }
+    
+    // MARK: Templates
+    
+    /// Add template of length points. Its envelope is computed once here.
+    ///
+    /// - returns: index of template, or -1 on error
+    func addTemplate(_ values: [Float]) -> Int {
+        assert (values.count == self.length)
+        return Int(dtw_add_template(self.dtw, values))
+    }
+    
+    
+    /// Number of templates
+    var numTemplates: Int {
+        return dtw_num_templates(self.dtw)
+    }
+    
+    // MARK: Matching
+    
+    /// DTW distance of query to template
+    func distance(_ x: [Float], templateIndex: Int) -> Float {
+        assert (x.count == self.length)
+        return dtw_distance(self.dtw, x, templateIndex)
+    }
+    
+    
+    /// Nearest template to query, with lower bound pruning and early abandoning
+    ///
+    /// - parameter maxDistance: Only templates closer than this are considered
+    /// - returns: index (nil if none) and distance
+    func nearest(_ x: [Float], maxDistance: Float = Float.infinity) -> (index: Int?, distance: Float) {
+        assert (x.count == self.length)
+        var distance: Float = 0
+        let index = Int(dtw_nearest(self.dtw, x, maxDistance, &distance))
+        return (index >= 0 ? index : nil, distance)
+    }
+    
+    
+    /// Nearest template to the latest length values of buffer
+    func nearest(_ x: DSBuffer, maxDistance: Float = Float.infinity) -> (index: Int?, distance: Float) {
+        assert (x.bufferSize >= self.length)
+        var distance: Float = 0
+        let index = Int(dtw_nearest_buffer(self.dtw, x.buffer, maxDistance, &distance))
+        return (index >= 0 ? index : nil, distance)
+    }
+}
@@ -0,0 +1,93 @@
+/// STFT
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Streaming short-time Fourier transform (spectrogram)
+public class STFT {
+    
+    /// Value stored for each time-frequency cell
+    public enum Scale {
+        case magnitude
+        case power
+        case logMagnitude
+    }
+    
+    private var stft: OpaquePointer
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter fftSize: Number of samples of each frame. Should be **even**
+    /// - parameter hopSize: A new frame is computed every hopSize pushed samples
+    /// - parameter window: Window function applied to each frame
+    /// - parameter numFrames: Number of latest frames kept
+    /// - parameter scale: Magnitude, power or natural log of magnitude
+    init(fftSize: Int, hopSize: Int, window: WindowFunction = .hann, numFrames: Int, scale: Scale = .magnitude) {
+        assert (fftSize % 2 == 0, "FFT size must be even")
+        let (windowType, windowParam) = window.cValue
+        var stftScale = STFT_MAGNITUDE
+        switch scale {
+        case .magnitude: stftScale = STFT_MAGNITUDE
+        case .power: stftScale = STFT_POWER
+        case .logMagnitude: stftScale = STFT_LOG_MAGNITUDE
+        }
+        self.stft = stft_new(fftSize, hopSize, windowType, windowParam, numFrames, stftScale)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        stft_free_unsafe(self.stft)
+    }
+    
+    // MARK: Operations
+    
+    /// Push new value
+    ///
+    /// - returns: true if a new frame was computed
+    @discardableResult
+    func push(_ value: Float) -> Bool {
+        return stft_push(self.stft, value)
+    }
+    
+    
+    /// Number of frequency bins of each frame, i.e. fftSize/2+1
+    var numBins: Int {
+        return stft_num_bins(self.stft)
+    }
+    
+    
+    /// Number of frames available
+    var numFrames: Int {
+        return stft_num_frames(self.stft)
+    }
+    
+    
+    /// Get value of bin at frame (0 for the latest)
+    func valueAt(frame: Int, bin: Int) -> Float {
+        return stft_at(self.stft, frame, bin)
+    }
+    
+    
+    /// Access latest frames without copying.
+    ///
+    /// Value of bin k at frame t (t = 0 for the oldest, count-1 for the latest) is pointer[k * stride + t].
+    /// The pointer is only valid inside body.
+    func withLatestFrames<R>(_ count: Int, _ body: (UnsafePointer<Float>, Int) -> R) -> R {
+        var stride = 0
+        let pointer = stft_latest_frames(self.stft, count, &stride)!
+        return body(pointer, stride)
+    }
+    
+    
+    /// Reset to zero data and no frames
+    func clear() {
+        stft_clear(self.stft)
+    }
+}
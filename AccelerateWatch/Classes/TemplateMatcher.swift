@@ -0,0 +1,78 @@
+/// TemplateMatcher
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Z-normalized matching of a window against a set of templates (e.g. a gesture library)
+public class TemplateMatcher {
+    
+    private var matcher: OpaquePointer
+    private var windowSize: Int
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter windowSize: Size of windows searched for templates
+    /// - parameter maxTemplates: Maximum number of templates
+    init(windowSize: Int, maxTemplates: Int) {
+        self.windowSize = windowSize
+        self.matcher = tmatch_new(windowSize, maxTemplates)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        tmatch_free_unsafe(self.matcher)
+    }
+    
+    // MARK: Templates
+    
+    /// Add template (2...windowSize points, not constant). Its spectrum is computed once here.
+    ///
+    /// - returns: index of template, or -1 on error
+    func addTemplate(_ values: [Float]) -> Int {
+        return Int(tmatch_add_template(self.matcher, values, values.count))
+    }
+    
+    
+    /// Number of templates
+    var numTemplates: Int {
+        return tmatch_num_templates(self.matcher)
+    }
+    
+    // MARK: Matching
+    
+    /// Best match of every template in window
+    ///
+    /// - returns: offset, z-normalized distance and correlation of best matching segment, one per template
+    func match(_ x: [Float]) -> [tmatch_result] {
+        assert (x.count == self.windowSize)
+        var results = [tmatch_result](repeating: tmatch_result(), count: self.numTemplates)
+        tmatch_compute(self.matcher, x, &results)
+        return results
+    }
+    
+    
+    /// Best match of every template in data of buffer
+    func match(_ x: DSBuffer) -> [tmatch_result] {
+        assert (x.bufferSize == self.windowSize)
+        var results = [tmatch_result](repeating: tmatch_result(), count: self.numTemplates)
+        tmatch_compute_buffer(self.matcher, x.buffer, &results)
+        return results
+    }
+    
+    
+    /// Z-normalized distance of template at every offset of window (windowSize-length+1 points)
+    func distanceProfile(_ x: [Float], templateIndex: Int) -> [Float] {
+        assert (x.count == self.windowSize)
+        let length = tmatch_template_length(self.matcher, templateIndex)
+        var output = [Float](repeating: 0.0, count: self.windowSize - length + 1)
+        tmatch_distance_profile(self.matcher, x, templateIndex, &output)
+        return output
+    }
+}
@@ -0,0 +1,95 @@
+/// Triaxial
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Streaming magnitude, vertical and horizontal components of 3-axis samples (e.g. accelerometer)
+public class Triaxial {
+    
+    private var triaxial: OpaquePointer
+    private var size: Int
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter size: Length of magnitude, vertical and horizontal buffers
+    /// - parameter fftIsSupported: Whether FFT will be performed on the buffers
+    /// - parameter gravityAlpha: Weight of each new sample in gravity estimate, e.g. 0.02 for about a second at 50 Hz
+    init(size: Int, fftIsSupported: Bool = false, gravityAlpha: Float = 0.02) {
+        self.size = size
+        self.triaxial = triaxial_new(size, fftIsSupported, gravityAlpha)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        triaxial_free_unsafe(self.triaxial)
+    }
+    
+    // MARK: Regular operations
+    
+    /// Push new 3-axis sample
+    func push(_ x: Float, _ y: Float, _ z: Float) {
+        triaxial_push(self.triaxial, x, y, z)
+    }
+    
+    
+    /// Push samples interleaved as [x0, y0, z0, x1, y1, z1, ...]
+    func pushInterleaved(_ xyz: [Float]) {
+        assert (xyz.count % 3 == 0)
+        triaxial_push_interleaved(self.triaxial, xyz, xyz.count / 3)
+    }
+    
+    
+    /// Reset buffers and gravity estimate
+    func clear() {
+        triaxial_clear(self.triaxial)
+    }
+    
+    // MARK: Components
+    
+    private func dump(_ buffer: OpaquePointer) -> [Float] {
+        var dumped = [Float](repeating: 0.0, count: self.size)
+        dsbuffer_dump(buffer, &dumped)
+        return dumped
+    }
+    
+    
+    /// Magnitudes sqrt(x^2+y^2+z^2)
+    var magnitude: [Float] {
+        return dump(triaxial_magnitude(self.triaxial))
+    }
+    
+    
+    /// Components along gravity minus gravity magnitude (0 at rest)
+    var vertical: [Float] {
+        return dump(triaxial_vertical(self.triaxial))
+    }
+    
+    
+    /// Magnitudes of components orthogonal to gravity
+    var horizontal: [Float] {
+        return dump(triaxial_horizontal(self.triaxial))
+    }
+    
+    
+    /// Current gravity estimate [x, y, z]
+    var gravity: [Float] {
+        var g = [Float](repeating: 0.0, count: 3)
+        triaxial_gravity(self.triaxial, &g)
+        return g
+    }
+    
+    
+    /// Time-domain features of magnitudes in one pass
+    func magnitudeFeatures(_ mask: UInt32 = DSBUFFER_FEATURE_ALL.rawValue) -> dsbuffer_time_features {
+        var features = dsbuffer_time_features()
+        dsbuffer_features(triaxial_magnitude(self.triaxial), mask, &features)
+        return features
+    }
+}
@@ -97,6 +97,146 @@ public func vMultiply(_ v: [Double], valueToMultiply: Double) -> [Double] {
 }
 
 
+/// Element-wise sum of two vectors. Float type version.
+public func vAdd(_ v1: [Float], v2: [Float]) -> [Float] {
+    assert (v1.count == v2.count)
+    var result = [Float](repeating: 0.0, count: v1.count)
+    vectorf_add_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise sum of two vectors. Double type version.
+public func vAdd(_ v1: [Double], v2: [Double]) -> [Double] {
+    assert (v1.count == v2.count)
+    var result = [Double](repeating: 0.0, count: v1.count)
+    vectord_add_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise difference v1 - v2. Float type version.
+public func vSubtract(_ v1: [Float], v2: [Float]) -> [Float] {
+    assert (v1.count == v2.count)
+    var result = [Float](repeating: 0.0, count: v1.count)
+    vectorf_subtract_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise difference v1 - v2. Double type version.
+public func vSubtract(_ v1: [Double], v2: [Double]) -> [Double] {
+    assert (v1.count == v2.count)
+    var result = [Double](repeating: 0.0, count: v1.count)
+    vectord_subtract_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise product of two vectors. Float type version.
+public func vMultiply(_ v1: [Float], v2: [Float]) -> [Float] {
+    assert (v1.count == v2.count)
+    var result = [Float](repeating: 0.0, count: v1.count)
+    vectorf_multiply_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise product of two vectors. Double type version.
+public func vMultiply(_ v1: [Double], v2: [Double]) -> [Double] {
+    assert (v1.count == v2.count)
+    var result = [Double](repeating: 0.0, count: v1.count)
+    vectord_multiply_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise quotient v1 / v2. Float type version.
+public func vDivide(_ v1: [Float], v2: [Float]) -> [Float] {
+    assert (v1.count == v2.count)
+    var result = [Float](repeating: 0.0, count: v1.count)
+    vectorf_divide_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise quotient v1 / v2. Double type version.
+public func vDivide(_ v1: [Double], v2: [Double]) -> [Double] {
+    assert (v1.count == v2.count)
+    var result = [Double](repeating: 0.0, count: v1.count)
+    vectord_divide_vector(v1, v2, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise v1 * v2 + v3 (fused where supported). Float type version.
+public func vMultiplyAdd(_ v1: [Float], v2: [Float], v3: [Float]) -> [Float] {
+    assert (v1.count == v2.count && v1.count == v3.count)
+    var result = [Float](repeating: 0.0, count: v1.count)
+    vectorf_multiply_add(v1, v2, v3, v1.count, &result)
+    return result
+}
+
+
+/// Element-wise v1 * v2 + v3 (fused where supported). Double type version.
+public func vMultiplyAdd(_ v1: [Double], v2: [Double], v3: [Double]) -> [Double] {
+    assert (v1.count == v2.count && v1.count == v3.count)
+    var result = [Double](repeating: 0.0, count: v1.count)
+    vectord_multiply_add(v1, v2, v3, v1.count, &result)
+    return result
+}
+
+
+/// v1 + value * v2 (axpy). Float type version.
+public func vAxpy(_ v1: [Float], value: Float, v2: [Float]) -> [Float] {
+    assert (v1.count == v2.count)
+    var result = [Float](repeating: 0.0, count: v1.count)
+    vectorf_axpy(v1, value, v2, v1.count, &result)
+    return result
+}
+
+
+/// v1 + value * v2 (axpy). Double type version.
+public func vAxpy(_ v1: [Double], value: Double, v2: [Double]) -> [Double] {
+    assert (v1.count == v2.count)
+    var result = [Double](repeating: 0.0, count: v1.count)
+    vectord_axpy(v1, value, v2, v1.count, &result)
+    return result
+}
+
+
+/// Limit values to [low, high]. Float type version.
+public func vClamp(_ v: [Float], low: Float, high: Float) -> [Float] {
+    var result = [Float](repeating: 0.0, count: v.count)
+    vectorf_clamp(v, v.count, low, high, &result)
+    return result
+}
+
+
+/// Limit values to [low, high]. Double type version.
+public func vClamp(_ v: [Double], low: Double, high: Double) -> [Double] {
+    var result = [Double](repeating: 0.0, count: v.count)
+    vectord_clamp(v, v.count, low, high, &result)
+    return result
+}
+
+
+/// Absolute value. Float type version.
+public func vAbs(_ v: [Float]) -> [Float] {
+    var result = [Float](repeating: 0.0, count: v.count)
+    vectorf_abs(v, v.count, &result)
+    return result
+}
+
+
+/// Absolute value. Double type version.
+public func vAbs(_ v: [Double]) -> [Double] {
+    var result = [Double](repeating: 0.0, count: v.count)
+    vectord_abs(v, v.count, &result)
+    return result
+}
+
+
 /// Remove mean value. Float type version.
 public func vRemoveMean(_ v: [Float]) -> [Float] {
     var result = [Float](repeating: 0.0, count: v.count)
@@ -129,6 +269,22 @@ public func vNormalizeToUnitLength(_ v: [Double], centralized: Bool) -> [Double]
 }
 
 
+/// Natural logarithm (fast approximation for positive numbers). Float type version.
+public func vLogFast(_ v: [Float]) -> [Float] {
+    var result = [Float](repeating: 0.0, count: v.count)
+    vectorf_log_fast(v, v.count, &result)
+    return result
+}
+
+
+/// Natural logarithm (fast approximation for positive numbers). Double type version.
+public func vLogFast(_ v: [Double]) -> [Double] {
+    var result = [Double](repeating: 0.0, count: v.count)
+    vectord_log_fast(v, v.count, &result)
+    return result
+}
+
+
 /// Sqrt. Float type version.
 public func vSqrt(_ v: [Float]) -> [Float] {
     var result = [Float](repeating: 0.0, count: v.count)
@@ -145,6 +301,78 @@ public func vSqrt(_ v: [Double]) -> [Double] {
 }
 
 
+/// Magnitude sqrt(x^2+y^2+z^2) of 3-axis samples in separate arrays. Float type version.
+public func vMagnitude(_ x: [Float], y: [Float], z: [Float]) -> [Float] {
+    assert (x.count == y.count && x.count == z.count)
+    var result = [Float](repeating: 0.0, count: x.count)
+    vectorf_magnitude3(x, y, z, x.count, &result)
+    return result
+}
+
+
+/// Magnitude of 3-axis samples interleaved as [x0, y0, z0, x1, y1, z1, ...]. Float type version.
+public func vMagnitude(interleaved xyz: [Float]) -> [Float] {
+    assert (xyz.count % 3 == 0)
+    var result = [Float](repeating: 0.0, count: xyz.count / 3)
+    vectorf_magnitude3_interleaved(xyz, xyz.count / 3, &result)
+    return result
+}
+
+
+/// Magnitude by fast reciprocal square root (relative error below 2e-3). Float type version.
+public func vMagnitudeFast(_ x: [Float], y: [Float], z: [Float]) -> [Float] {
+    assert (x.count == y.count && x.count == z.count)
+    var result = [Float](repeating: 0.0, count: x.count)
+    vectorf_magnitude3_fast(x, y, z, x.count, &result)
+    return result
+}
+
+
+/// Magnitude of interleaved samples by fast reciprocal square root. Float type version.
+public func vMagnitudeFast(interleaved xyz: [Float]) -> [Float] {
+    assert (xyz.count % 3 == 0)
+    var result = [Float](repeating: 0.0, count: xyz.count / 3)
+    vectorf_magnitude3_interleaved_fast(xyz, xyz.count / 3, &result)
+    return result
+}
+
+
+/// Magnitude sqrt(x^2+y^2+z^2) of 3-axis samples in separate arrays. Double type version.
+public func vMagnitude(_ x: [Double], y: [Double], z: [Double]) -> [Double] {
+    assert (x.count == y.count && x.count == z.count)
+    var result = [Double](repeating: 0.0, count: x.count)
+    vectord_magnitude3(x, y, z, x.count, &result)
+    return result
+}
+
+
+/// Magnitude of 3-axis samples interleaved as [x0, y0, z0, x1, y1, z1, ...]. Double type version.
+public func vMagnitude(interleaved xyz: [Double]) -> [Double] {
+    assert (xyz.count % 3 == 0)
+    var result = [Double](repeating: 0.0, count: xyz.count / 3)
+    vectord_magnitude3_interleaved(xyz, xyz.count / 3, &result)
+    return result
+}
+
+
+/// Magnitude by fast reciprocal square root (relative error below 2e-3). Double type version.
+public func vMagnitudeFast(_ x: [Double], y: [Double], z: [Double]) -> [Double] {
+    assert (x.count == y.count && x.count == z.count)
+    var result = [Double](repeating: 0.0, count: x.count)
+    vectord_magnitude3_fast(x, y, z, x.count, &result)
+    return result
+}
+
+
+/// Magnitude of interleaved samples by fast reciprocal square root. Double type version.
+public func vMagnitudeFast(interleaved xyz: [Double]) -> [Double] {
+    assert (xyz.count % 3 == 0)
+    var result = [Double](repeating: 0.0, count: xyz.count / 3)
+    vectord_magnitude3_interleaved_fast(xyz, xyz.count / 3, &result)
+    return result
+}
+
+
 /// Dot production between two vectors. Float type version.
 public func vDotProduct(_ v1: [Float], v2: [Float]) -> Float {
     assert (v1.count == v2.count)
@@ -0,0 +1,79 @@
+/// Welch
+///
+/// Created by Yang Liu (gloolar [at] gmail [dot] com) on 16/6/20.
+/// Copyright © 2016年 Yang Liu. All rights reserved.
+
+
+import Foundation
+
+
+/// Streaming Welch power spectral density estimator
+public class Welch {
+    
+    private var welch: OpaquePointer
+    private var psdData: [Float]
+    
+    // MARK: Initializer and deinitializer
+    
+    /// Initializer
+    ///
+    /// - parameter segmentSize: Samples of each segment. Should be **even**
+    /// - parameter overlap: Samples shared by consecutive segments
+    /// - parameter window: Window function applied to each segment
+    /// - parameter fs: Sampling frequency
+    /// - parameter alpha: 0 to average all segments equally, or weight of the newest segment in (0, 1] for exponential averaging
+    init(segmentSize: Int, overlap: Int, window: WindowFunction = .hann, fs: Float, alpha: Float = 0) {
+        assert (segmentSize % 2 == 0, "Segment size must be even")
+        assert (overlap < segmentSize)
+        let (windowType, windowParam) = window.cValue
+        self.welch = welch_new(segmentSize, overlap, windowType, windowParam, fs, alpha)
+        self.psdData = [Float](repeating: 0.0, count: segmentSize/2+1)
+    }
+    
+    
+    /// :nodoc: deinitializer
+    deinit {
+        welch_free_unsafe(self.welch)
+    }
+    
+    // MARK: Operations
+    
+    /// Push new value
+    ///
+    /// - returns: true if a new segment was averaged
+    @discardableResult
+    func push(_ value: Float) -> Bool {
+        return welch_push(self.welch, value)
+    }
+    
+    
+    /// Number of segments averaged so far
+    var numSegments: Int {
+        return welch_num_segments(self.welch)
+    }
+    
+    
+    /// Averaged one-sided power spectral density
+    ///
+    /// - returns: array of size segmentSize/2+1
+    var powerSpectralDensity: [Float] {
+        welch_psd(self.welch, &self.psdData)
+        return self.psdData
+    }
+    
+    
+    /// PSD sample frequencies
+    ///
+    /// - returns: array of size segmentSize/2+1
+    var frequencies: [Float] {
+        var freq = [Float](repeating: 0.0, count: self.psdData.count)
+        welch_freq(self.welch, &freq)
+        return freq
+    }
+    
+    
+    /// Reset to zero data and no segments
+    func clear() {
+        welch_clear(self.welch)
+    }
+}
@@ -8,8 +8,23 @@
 #ifndef __ACCELERATELIB_H__
 #define __ACCELERATELIB_H__
 
+#include "window.h"
 #include "dsbuffer.h"
+#include "dsbufferd.h"
+#include "dsbuffer_fixed.h"
+#include "orderstat.h"
+#include "peakdetect.h"
+#include "stft.h"
+#include "welch.h"
+#include "xcorr.h"
+#include "tmatch.h"
+#include "dtw.h"
+#include "covtrack.h"
+#include "triaxial.h"
 #include "vectorf.h"
 #include "vectord.h"
+#include "vector_simd.h"
+#include "vector_parallel.h"
+#include "vector_expr.h"
 
 #endif
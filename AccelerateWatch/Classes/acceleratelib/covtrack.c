@@ -0,0 +1,298 @@
+/*  =========================================================================
+    covtrack - windowed covariance and correlation between channels
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "covtrack.h"
+
+#define COVTRACK_MAX_PRODUCTS (COVTRACK_MAX_CHANNELS * (COVTRACK_MAX_CHANNELS + 1) / 2)
+
+struct _covtrack_t {
+    size_t size;
+    size_t num_channels;
+    float *window; // size samples of num_channels values
+    size_t oldest; // sample to be replaced by next push
+    size_t pushes_since_rebuild;
+
+    // sums of (value - shift) and of products of them, upper triangle of
+    // products packed row by row
+    double shift[COVTRACK_MAX_CHANNELS];
+    double sum[COVTRACK_MAX_CHANNELS];
+    double product_sum[COVTRACK_MAX_PRODUCTS];
+};
+
+
+// Index of product of channels i <= j
+static size_t covtrack_product_index (covtrack_t *self, size_t i, size_t j) {
+    if (i > j) {
+        size_t tmp = i;
+        i = j;
+        j = tmp;
+    }
+    return i * self->num_channels - i * (i - 1) / 2 + (j - i);
+}
+
+
+// Recompute sums from window, relative to window mean
+static void covtrack_rebuild (covtrack_t *self) {
+    size_t c = self->num_channels;
+    for (size_t i = 0; i < c; i++) {
+        double sum = 0;
+        for (size_t t = 0; t < self->size; t++)
+            sum += self->window[t * c + i];
+        self->shift[i] = sum / self->size;
+        self->sum[i] = 0;
+    }
+    memset (self->product_sum, 0, sizeof (self->product_sum));
+    double d[COVTRACK_MAX_CHANNELS];
+    for (size_t t = 0; t < self->size; t++) {
+        for (size_t i = 0; i < c; i++) {
+            d[i] = self->window[t * c + i] - self->shift[i];
+            self->sum[i] += d[i];
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < c; i++)
+            for (size_t j = i; j < c; j++)
+                self->product_sum[k++] += d[i] * d[j];
+    }
+    self->pushes_since_rebuild = 0;
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+covtrack_t *covtrack_new (size_t window_size, size_t num_channels) {
+    if (window_size < 2) {
+        printf("ERROR: window size must be at least 2.\n");
+        return NULL;
+    }
+    if (num_channels == 0 || num_channels > COVTRACK_MAX_CHANNELS) {
+        printf("ERROR: number of channels must be in [1, %d].\n", COVTRACK_MAX_CHANNELS);
+        return NULL;
+    }
+
+    covtrack_t *self = (covtrack_t *) malloc (sizeof (covtrack_t));
+    assert (self);
+    self->size = window_size;
+    self->num_channels = num_channels;
+    self->window = (float *) malloc (sizeof (float) * window_size * num_channels);
+    assert (self->window);
+
+    covtrack_clear (self);
+    return self;
+}
+
+
+void covtrack_push (covtrack_t *self, const float *values) {
+    assert (self);
+    assert (values);
+    size_t c = self->num_channels;
+    float *old = self->window + self->oldest * c;
+
+    double d_new[COVTRACK_MAX_CHANNELS], d_old[COVTRACK_MAX_CHANNELS];
+    for (size_t i = 0; i < c; i++) {
+        d_new[i] = values[i] - self->shift[i];
+        d_old[i] = old[i] - self->shift[i];
+        self->sum[i] += d_new[i] - d_old[i];
+        old[i] = values[i];
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < c; i++)
+        for (size_t j = i; j < c; j++)
+            self->product_sum[k++] += d_new[i] * d_new[j] - d_old[i] * d_old[j];
+
+    if (++self->oldest == self->size)
+        self->oldest = 0;
+    if (++self->pushes_since_rebuild == self->size)
+        covtrack_rebuild (self);
+}
+
+
+void covtrack_push_batch (covtrack_t *self, const float *values, size_t count) {
+    assert (self);
+    assert (values);
+    for (size_t t = 0; t < count; t++)
+        covtrack_push (self, values + t * self->num_channels);
+}
+
+
+void covtrack_clear (covtrack_t *self) {
+    assert (self);
+    memset (self->window, 0, sizeof (float) * self->size * self->num_channels);
+    self->oldest = 0;
+    covtrack_rebuild (self);
+}
+
+
+size_t covtrack_size (covtrack_t *self) {
+    assert (self);
+    return self->size;
+}
+
+
+size_t covtrack_num_channels (covtrack_t *self) {
+    assert (self);
+    return self->num_channels;
+}
+
+
+float covtrack_mean (covtrack_t *self, size_t i) {
+    assert (self);
+    assert (i < self->num_channels);
+    return (float) (self->shift[i] + self->sum[i] / self->size);
+}
+
+
+// Covariance in double; shift does not change it
+static double covtrack_covariance_double (covtrack_t *self, size_t i, size_t j) {
+    double n = self->size;
+    double cov = (self->product_sum[covtrack_product_index (self, i, j)] -
+                  self->sum[i] * self->sum[j] / n) / (n - 1);
+    if (i == j && cov < 0)
+        cov = 0;
+    return cov;
+}
+
+
+float covtrack_variance (covtrack_t *self, size_t i) {
+    assert (self);
+    assert (i < self->num_channels);
+    return (float) covtrack_covariance_double (self, i, i);
+}
+
+
+float covtrack_covariance (covtrack_t *self, size_t i, size_t j) {
+    assert (self);
+    assert (i < self->num_channels && j < self->num_channels);
+    return (float) covtrack_covariance_double (self, i, j);
+}
+
+
+float covtrack_correlation (covtrack_t *self, size_t i, size_t j) {
+    assert (self);
+    assert (i < self->num_channels && j < self->num_channels);
+    double var_i = covtrack_covariance_double (self, i, i);
+    double var_j = covtrack_covariance_double (self, j, j);
+    if (var_i <= 0 || var_j <= 0)
+        return 0;
+    double r = covtrack_covariance_double (self, i, j) / sqrt (var_i * var_j);
+    return (float) ((r > 1) ? 1 : (r < -1) ? -1 : r);
+}
+
+
+void covtrack_covariance_matrix (covtrack_t *self, float *output) {
+    assert (self);
+    assert (output);
+    size_t c = self->num_channels;
+    for (size_t i = 0; i < c; i++)
+        for (size_t j = i; j < c; j++)
+            output[i * c + j] = output[j * c + i] = (float) covtrack_covariance_double (self, i, j);
+}
+
+
+void covtrack_correlation_matrix (covtrack_t *self, float *output) {
+    assert (self);
+    assert (output);
+    size_t c = self->num_channels;
+    for (size_t i = 0; i < c; i++)
+        for (size_t j = i; j < c; j++)
+            output[i * c + j] = output[j * c + i] = covtrack_correlation (self, i, j);
+}
+
+
+void covtrack_free (covtrack_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        covtrack_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void covtrack_free_unsafe (covtrack_t *self) {
+    assert (self);
+    free (self->window);
+    free (self);
+}
+
+
+// ---------------------------------------------------------------------------
+void covtrack_test (void) {
+    printf ("\n[covtrack] Test...\n");
+
+    // 1. Three axes with large offset, against two-pass computation over
+    // the window, across many rebuilds
+    size_t size = 50, c = 3;
+    covtrack_t *ct = covtrack_new (size, c);
+    assert (ct);
+    float *history = (float *) malloc (sizeof (float) * 2000 * c);
+    assert (history);
+    for (size_t t = 0; t < 2000; t++) {
+        float a = sinf (0.1f * t), b = cosf (0.23f * t);
+        float noise = ((float) (rand () % 201) - 100) / 1000;
+        history[t*c+0] = 1000 + a;
+        history[t*c+1] = -500 + 0.5f * a + b + noise;
+        history[t*c+2] = 9.81f - 2 * b;
+        covtrack_push (ct, history + t*c);
+
+        if (t + 1 < size || t % 37 != 0)
+            continue;
+        const float *w = history + (t + 1 - size) * c;
+        double mean[3] = {0, 0, 0};
+        for (size_t s = 0; s < size; s++)
+            for (size_t i = 0; i < c; i++)
+                mean[i] += w[s*c+i];
+        for (size_t i = 0; i < c; i++)
+            mean[i] /= size;
+        float matrix[9], corr_matrix[9];
+        covtrack_covariance_matrix (ct, matrix);
+        covtrack_correlation_matrix (ct, corr_matrix);
+        for (size_t i = 0; i < c; i++) {
+            assert (fabs (covtrack_mean (ct, i) - mean[i]) < 1e-4 * (1 + fabs (mean[i])));
+            for (size_t j = 0; j < c; j++) {
+                double cov = 0, var_i = 0, var_j = 0;
+                for (size_t s = 0; s < size; s++) {
+                    cov += (w[s*c+i] - mean[i]) * (w[s*c+j] - mean[j]);
+                    var_i += (w[s*c+i] - mean[i]) * (w[s*c+i] - mean[i]);
+                    var_j += (w[s*c+j] - mean[j]) * (w[s*c+j] - mean[j]);
+                }
+                double r = cov / sqrt (var_i * var_j);
+                cov /= size - 1;
+                assert (fabs (covtrack_covariance (ct, i, j) - cov) < 1e-3 * (1e-2 + fabs (cov)));
+                assert (matrix[i*c+j] == covtrack_covariance (ct, i, j));
+                assert (fabs (covtrack_correlation (ct, i, j) - r) < 1e-3);
+                assert (corr_matrix[i*c+j] == covtrack_correlation (ct, i, j));
+            }
+        }
+    }
+    covtrack_free (&ct);
+    assert (ct == NULL);
+
+    // 2. Pair: perfectly correlated and anti-correlated, constant channel,
+    // batch push
+    ct = covtrack_new (10, 2);
+    float pairs[2 * 20];
+    for (size_t t = 0; t < 20; t++) {
+        pairs[2*t] = (float) t;
+        pairs[2*t+1] = 3 - 2.0f * t;
+    }
+    covtrack_push_batch (ct, pairs, 20);
+    assert (fabsf (covtrack_correlation (ct, 0, 1) + 1) < 1e-6);
+    assert (fabsf (covtrack_variance (ct, 0) - 55.0f / 6) < 1e-4);
+    covtrack_clear (ct);
+    assert (covtrack_correlation (ct, 0, 1) == 0 && covtrack_mean (ct, 1) == 0);
+    covtrack_free (&ct);
+    free (history);
+
+    printf ("OK\n");
+}
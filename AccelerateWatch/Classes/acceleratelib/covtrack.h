@@ -0,0 +1,79 @@
+/*  =========================================================================
+    covtrack - windowed covariance and correlation between channels
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __COVTRACK_H__
+#define __COVTRACK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#define COVTRACK_MAX_CHANNELS 8
+
+typedef struct _covtrack_t covtrack_t;
+
+// Create a new covtrack object over the latest window_size samples of
+// num_channels channels (e.g. 2 for a pair, 3 for x, y and z axes).
+// The window starts filled with zeros, like dsbuffer.
+// Running sums of every channel and every channel product are updated as
+// samples enter and leave the window, so each push is O(num_channels^2) and
+// reading a mean, variance, covariance or correlation is O(1).
+// Sums are kept in double relative to a recent window mean, and rebuilt from
+// the window every window_size pushes, so rounding errors do not drift.
+covtrack_t *covtrack_new (size_t window_size, size_t num_channels);
+
+// Destroy covtrack object
+void covtrack_free (covtrack_t **self_p);
+
+// Destroy covtrack object
+void covtrack_free_unsafe (covtrack_t *self);
+
+// Add new sample of all channels (num_channels values), dropping the oldest
+void covtrack_push (covtrack_t *self, const float *values);
+
+// Add count samples, interleaved (num_channels values each), e.g. a batch
+// of accelerometer readings
+void covtrack_push_batch (covtrack_t *self, const float *values, size_t count);
+
+// Reset window to zeros
+void covtrack_clear (covtrack_t *self);
+
+// Window size
+size_t covtrack_size (covtrack_t *self);
+
+// Number of channels
+size_t covtrack_num_channels (covtrack_t *self);
+
+// Mean of channel i
+float covtrack_mean (covtrack_t *self, size_t i);
+
+// Variance of channel i (with N-1, as dsbuffer_variance)
+float covtrack_variance (covtrack_t *self, size_t i);
+
+// Covariance of channels i and j (with N-1)
+float covtrack_covariance (covtrack_t *self, size_t i, size_t j);
+
+// Pearson correlation of channels i and j (0 if either is constant)
+float covtrack_correlation (covtrack_t *self, size_t i, size_t j);
+
+// Covariance matrix, num_channels x num_channels row major, in param output
+void covtrack_covariance_matrix (covtrack_t *self, float *output);
+
+// Correlation matrix, num_channels x num_channels row major, in param output
+void covtrack_correlation_matrix (covtrack_t *self, float *output);
+
+// Self test
+void covtrack_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
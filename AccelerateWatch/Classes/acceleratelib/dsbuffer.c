@@ -8,83 +8,129 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
 #include <math.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "dsbuffer.h"
+#include "vectorf.h"
+#include "orderstat.h"
+#include "peakdetect.h"
+#include "kissfft/kiss_fft.h"
 #include "kissfft/kiss_fftr.h"
+#include "kissfft/kiss_czt.h"
+
+#ifdef KISS_FFT_COUNT_ALLOCS
+// Test hook like the one of kiss_fft.h: count every heap allocation made by
+// this file, including dsbuffer_generic.inc
+static size_t dsbuffer_alloc_count = 0;
+
+static void *dsbuffer_counted_malloc (size_t size) {
+    dsbuffer_alloc_count++;
+    return malloc (size);
+}
+
+static void *dsbuffer_counted_calloc (size_t num, size_t size) {
+    dsbuffer_alloc_count++;
+    return calloc (num, size);
+}
+
+#define malloc(size)        dsbuffer_counted_malloc (size)
+#define calloc(num, size)   dsbuffer_counted_calloc (num, size)
+#endif
 
 
 struct _dsbuffer_t {
     float *data;
     size_t size;
+    size_t ring_size; // values in ring: size, or whole pages if double mapped
     size_t head; // position of first value
     void (*pusher)(dsbuffer_t *f, float new_value); // func for pushing value
 
     // for FFT
     bool fft_supported;
+    bool double_mapped; // data is the same pages mapped twice, see _new_double_mapped
     kiss_fftr_cfg fft_cfg; // fft configuration
 
+    kiss_fftr_cfg ifft_cfg; // inverse fft configuration, created on demand
+    kiss_fft_cpx *spectrum; // size/2+1 points of scratch for inverse fft
+
+    // for autocorrelation, created on demand
+    size_t acorr_max_lag;
+    size_t acorr_nfft; // zero padded fft size
+    kiss_fftr_cfg acorr_fft_cfg;
+    kiss_fftr_cfg acorr_ifft_cfg;
+    float *acorr_data; // acorr_nfft points of scratch
+    kiss_fft_cpx *acorr_spectrum; // acorr_nfft/2+1 points of scratch
+
+    // for analytic signal, created on demand
+    kiss_fft_cfg hilbert_fft_cfg;
+    kiss_fft_cfg hilbert_ifft_cfg;
+    kiss_fft_cpx *hilbert_data; // 2*size points of scratch
+
+    // for window function
+    float *window; // coefficients, NULL for rectangular window
+    float *windowed; // scratch for data multiplied by window, FFT input
+    float window_coherent_gain;
+    float window_power_gain;
+
+    // for zoom FFT
+    kiss_czt_cfg zoom_cfg; // chirp-z configuration
+    size_t num_zoom_bins;
+    float zoom_f_start;
+    float zoom_df;
+
     // for FIR filter
     const float *fir_taps;
     size_t num_fir_taps;
     float (*fir_getter)(dsbuffer_t *buf); // func of getting filtered signal
-};
 
+    // for order statistics, NULL if not setup
+    orderstat_t *order_stats;
 
-// Check if x is power of 2
-static bool is_power_of_2 (size_t x) {
-   return x && !(x & (x - 1));
-}
+    // for streaming peak detection, NULL if not setup
+    peakdetect_t *peak_detector;
 
+    // accumulating loops, in float or in double
+    const struct dsbuffer_kernels *kernels;
 
-static void dsbuffer_push_fast_with_fft (dsbuffer_t *self, float new_value) {
-    self->data[self->head] = new_value;
-    self->data[self->head + self->size] = new_value;
-    self->head = (++self->head) & (self->size-1);
-}
-
-
-static void dsbuffer_push_normal_with_fft (dsbuffer_t *self, float new_value) {
-    self->data[self->head] = new_value;
-    self->data[self->head + self->size] = new_value;
-    if (++self->head == self->size)
-        self->head = 0;
-}
-
-
-static void dsbuffer_push_fast (dsbuffer_t *self, float new_value) {
-    self->data[self->head] = new_value;
-    self->head = (++self->head) & (self->size-1);
-}
-
+    // for copy-on-write snapshots
+    pthread_mutex_t snapshot_lock; // guards snapshot list and chunk copies
+    dsbuffer_snapshot_t *snapshots; // attached, i.e. not yet completely copied
+    size_t num_snapshots; // length of list, read by producer without lock
+    size_t snapshot_chunk; // chunk saved for all attached snapshots
+};
 
-static void dsbuffer_push_normal (dsbuffer_t *self, float new_value) {
-    self->data[self->head] = new_value;
-    if (++self->head == self->size)
-        self->head = 0;
-}
 
+// Snapshot data is copied in chunks of this many values
+#define DSBUFFER_SNAPSHOT_CHUNK 256
 
-// Get latest FIR filter output (fast version)
-static float dsbuffer_fir_get_fast (dsbuffer_t *self) {
-    float fvalue = 0;
-    size_t index = self->head, i;
-    for (i = 0; i < self->num_fir_taps; ++i)
-        fvalue += self->data[(--index) & (self->size - 1)] * self->fir_taps[i];
-    return fvalue;
-}
+struct _dsbuffer_snapshot_t {
+    dsbuffer_t *source; // live buffer while attached, NULL afterwards
+    dsbuffer_t *buffer; // frozen copy, filled chunk by chunk
+    unsigned char *copied; // flag per chunk of source ring
+    size_t ring_size; // of source
+    size_t num_chunks;
+    size_t num_copied;
+    bool finished; // frozen buffer is ready to use
+    dsbuffer_snapshot_t *next; // in source's list
+};
 
 
-// Get latest FIR filter output (normal version)
-static float dsbuffer_fir_get_normal (dsbuffer_t *self) {
-    float fvalue = 0;
-    size_t index = self->head, i;
-    for (i = 0; i < self->num_fir_taps; ++i) {
-        index = (index != 0) ? (index - 1) : (self->size - 1);
-        fvalue += self->data[index] * self->fir_taps[i];
-    }
-    return fvalue;
+// Get FFT input: buffer data as is, or multiplied by window (if any) into
+// self->windowed. The window costs this one pass over the data before the
+// transform; kissfft reads its input unchanged, so it is not fused into the
+// first butterfly stage.
+static const float *dsbuffer_fft_input (dsbuffer_t *self) {
+    const float *x = &self->data[self->head];
+    if (self->window == NULL)
+        return x;
+    for (size_t i = 0; i < self->size; i++)
+        self->windowed[i] = x[i] * self->window[i];
+    return self->windowed;
 }
 
 
@@ -114,461 +160,1005 @@ static void dsbuffer_print_raw (dsbuffer_t *self, bool fft_supported) {
 }
 
 
-// ---------------------------------------------------------------------------
+// Setup and release of the fields which only the float buffer has
+static void dsbuffer_init_extensions (dsbuffer_t *self);
+static void dsbuffer_free_extensions (dsbuffer_t *self);
+static void dsbuffer_snapshot_before_write (dsbuffer_t *self);
+static void dsbuffer_snapshot_detach_all (dsbuffer_t *self);
+
+
+// Generic part shared with dsbufferd
+#define DSB_T                   dsbuffer_t
+#define DSB(name)               dsbuffer_##name
+#define DSB_SAMPLE              float
+#define DSB_NARROW_ACC          float
+#define DSB_SQRT                sqrtf
+#define DSB_FMOD                fmodf
+#define DSB_VECTOR(name)        vectorf_##name
+#define DSB_COMPLEX             dsbuffer_complex
+#define DSB_KERNELS_TAG         dsbuffer_kernels
+#define DSB_FFTR_CPX            kiss_fft_cpx
+#define DSB_FFTR_ALLOC          kiss_fftr_alloc
+#define DSB_FFTR                kiss_fftr
+#define DSB_FFTR_FREE           kiss_fftr_free
+#define DSB_FFT_INPUT           dsbuffer_fft_input
+#define DSB_INIT_EXTENSIONS     dsbuffer_init_extensions
+#define DSB_FREE_EXTENSIONS     dsbuffer_free_extensions
+#define DSB_BEFORE_PUSH(self, new_value) do { \
+    if (__atomic_load_n (&(self)->num_snapshots, __ATOMIC_RELAXED) > 0) \
+        dsbuffer_snapshot_before_write (self); \
+    if ((self)->order_stats) \
+        orderstat_push ((self)->order_stats, new_value); \
+    if ((self)->peak_detector) \
+        peakdetect_push ((self)->peak_detector, new_value); \
+} while (0)
+#define DSB_BEFORE_CLEAR(self) do { \
+    if (__atomic_load_n (&(self)->num_snapshots, __ATOMIC_RELAXED) > 0) \
+        dsbuffer_snapshot_detach_all (self); \
+} while (0)
+#define DSB_CLEAR_EXTENSIONS(self) do { \
+    if ((self)->order_stats) \
+        orderstat_clear ((self)->order_stats); \
+    if ((self)->peak_detector) \
+        peakdetect_clear ((self)->peak_detector); \
+} while (0)
+#include "dsbuffer_generic.inc"
 
 
-dsbuffer_t *dsbuffer_new (size_t size, bool fft_supported) {
-    if (fft_supported && size % 2 == 1) {
-        printf("ERROR: buffer size must be even for FFT.\n");
-        return NULL;
-    }
+// ---------------------------------------------------------------------------
 
-    dsbuffer_t *self = (dsbuffer_t *) malloc (sizeof (dsbuffer_t));
-    assert (self);
 
-    // Create signal buffer and initilize to zero
-    size_t alloc_size = fft_supported ? (size * 2) : size;
-    self->data = (float *) calloc (alloc_size, sizeof (float));
-    assert (self->data);
+static void dsbuffer_init_extensions (dsbuffer_t *self) {
+    self->ifft_cfg = NULL;
+    self->spectrum = NULL;
 
-    self->size = size;
-    self->head = 0;
+    self->acorr_max_lag = 0;
+    self->acorr_nfft = 0;
+    self->acorr_fft_cfg = NULL;
+    self->acorr_ifft_cfg = NULL;
+    self->acorr_data = NULL;
+    self->acorr_spectrum = NULL;
 
-    // If filter length equals power of 2, use the fast version, otherwise the
-    // normal version
-    if (is_power_of_2 (size))
-        self->pusher = fft_supported ?
-                       dsbuffer_push_fast_with_fft :
-                       dsbuffer_push_fast;
-    else
-        self->pusher = fft_supported ?
-                       dsbuffer_push_normal_with_fft :
-                       dsbuffer_push_normal;
+    self->hilbert_fft_cfg = NULL;
+    self->hilbert_ifft_cfg = NULL;
+    self->hilbert_data = NULL;
 
-    self->fft_supported = fft_supported;
-    if (fft_supported) {
-        self->fft_cfg = kiss_fftr_alloc ((int) size, 0, NULL, NULL);
-        assert (self->fft_cfg);
-    }
-    else
-        self->fft_cfg = NULL;
+    self->window = NULL;
+    self->windowed = NULL;
+    self->window_coherent_gain = 1;
+    self->window_power_gain = 1;
+
+    self->zoom_cfg = NULL;
+    self->num_zoom_bins = 0;
+    self->zoom_f_start = 0;
+    self->zoom_df = 0;
 
-    self->fir_taps = NULL;
-    self->num_fir_taps = 0;
-    self->fir_getter = NULL;
+    self->order_stats = NULL;
+    self->peak_detector = NULL;
 
-    return self;
+    pthread_mutex_init (&self->snapshot_lock, NULL);
+    self->snapshots = NULL;
+    self->num_snapshots = 0;
+    self->snapshot_chunk = 0;
 }
 
 
-float dsbuffer_at (dsbuffer_t *self, size_t idx) {
+void dsbuffer_setup_double_accumulation (dsbuffer_t *self, bool enable) {
     assert (self);
-    assert (idx < self->size);
-
-    if (self->fft_supported)
-        return self->data[self->head + idx];
-    else {
-        return self->data[(self->head + idx) % self->size];
-    }
+    self->kernels = enable ? &dsbuffer_kernels_dacc : &dsbuffer_kernels_facc;
+    if (self->fir_taps)
+        dsbuffer_setup_fir (self, self->fir_taps, self->num_fir_taps);
 }
 
 
-void dsbuffer_push (dsbuffer_t *self, float new_value) {
-    assert (self);
-    return self->pusher (self, new_value);
+// Create inverse fft plan and scratch on first use
+static void dsbuffer_ensure_ifft (dsbuffer_t *self) {
+    assert (self->fft_supported);
+    if (self->ifft_cfg)
+        return;
+    self->ifft_cfg = kiss_fftr_alloc ((int) self->size, 1, NULL, NULL);
+    assert (self->ifft_cfg);
+    self->spectrum = (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * (self->size/2+1));
+    assert (self->spectrum);
 }
 
 
-void dsbuffer_dump (dsbuffer_t *self, float *output) {
+void dsbuffer_ifftr (dsbuffer_t *self, const dsbuffer_complex *input, float *output) {
     assert (self);
+    assert (input);
     assert (output);
-    if (self->fft_supported)
-        memcpy (output, self->data + self->head, sizeof (float) * self->size);
-    else {
-        memcpy (output,
-                self->data + self->head,
-                sizeof (float) * (self->size - self->head));
-        memcpy (output + self->size - self->head,
-                self->data,
-                sizeof (float) * self->head);
+    dsbuffer_ensure_ifft (self);
+
+    // fold 1/N scaling into the copy
+    float scale = 1.0f / self->size;
+    for (size_t k = 0; k < self->size/2+1; k++) {
+        self->spectrum[k].r = input[k].real * scale;
+        self->spectrum[k].i = input[k].imag * scale;
     }
+    kiss_fftri (self->ifft_cfg, self->spectrum, output);
 }
 
 
-void dsbuffer_fftr (dsbuffer_t *self, dsbuffer_complex *output) {
+void dsbuffer_fft_filter (dsbuffer_t *self, const float *mask, float *output) {
     assert (self);
+    assert (mask);
     assert (output);
-    kiss_fftr (self->fft_cfg, &self->data[self->head], (kiss_fft_cpx *)output);
+    dsbuffer_ensure_ifft (self);
+
+    kiss_fftr (self->fft_cfg, &self->data[self->head], self->spectrum);
+    float scale = 1.0f / self->size;
+    for (size_t k = 0; k < self->size/2+1; k++) {
+        float gain = mask[k] * scale;
+        self->spectrum[k].r *= gain;
+        self->spectrum[k].i *= gain;
+    }
+    kiss_fftri (self->ifft_cfg, self->spectrum, output);
 }
 
 
-void dsbuffer_fft_freq (dsbuffer_t *self, float fs, float *output) {
+void dsbuffer_fft_filter_complex (dsbuffer_t *self,
+                                  const dsbuffer_complex *mask,
+                                  float *output) {
     assert (self);
+    assert (mask);
     assert (output);
-    assert (fs > 0);
-    float interval = fs/self->size;
-    output[0] = 0;
-    for (size_t idx = 1; idx < self->size/2+1; idx++) {
-        output[idx] = output[idx-1] + interval;
+    dsbuffer_ensure_ifft (self);
+
+    kiss_fftr (self->fft_cfg, &self->data[self->head], self->spectrum);
+    float scale = 1.0f / self->size;
+    for (size_t k = 0; k < self->size/2+1; k++) {
+        float re = self->spectrum[k].r, im = self->spectrum[k].i;
+        self->spectrum[k].r = (re * mask[k].real - im * mask[k].imag) * scale;
+        self->spectrum[k].i = (re * mask[k].imag + im * mask[k].real) * scale;
     }
+    kiss_fftri (self->ifft_cfg, self->spectrum, output);
 }
 
 
-void dsbuffer_setup_fir (dsbuffer_t *self, const float *fir_taps, size_t num_taps) {
+void dsbuffer_setup_window (dsbuffer_t *self, window_type type, float param) {
     assert (self);
-    assert (self->size >= num_taps);
-    if (self->size > num_taps)
-        printf ("WARNING: dsbuffer size is larger than number of FIR taps.\n");
-    self->fir_taps = fir_taps;
-    self->num_fir_taps = num_taps;
-
-    if (is_power_of_2 (self->size))
-        self->fir_getter = dsbuffer_fir_get_fast;
-    else
-        self->fir_getter = dsbuffer_fir_get_normal;
+    assert (self->fft_supported);
+
+    if (type == WINDOW_RECTANGULAR) {
+        free (self->window);
+        free (self->windowed);
+        self->window = NULL;
+        self->windowed = NULL;
+        self->window_coherent_gain = 1;
+        self->window_power_gain = 1;
+        return;
+    }
+
+    if (self->window == NULL) {
+        self->window = (float *) malloc (sizeof (float) * self->size);
+        assert (self->window);
+        self->windowed = (float *) malloc (sizeof (float) * self->size);
+        assert (self->windowed);
+    }
+    window_fill (type, self->size, param, self->window);
+    self->window_coherent_gain = window_coherent_gain (self->window, self->size);
+    self->window_power_gain = window_power_gain (self->window, self->size);
 }
 
 
-float dsbuffer_latest_fir_output (dsbuffer_t *self) {
+float dsbuffer_window_coherent_gain (dsbuffer_t *self) {
     assert (self);
-    assert (self->fir_taps);
-    return self->fir_getter (self);
+    return self->window_coherent_gain;
 }
 
 
-void dsbuffer_fir_filter (dsbuffer_t *self, float *output) {
+float dsbuffer_window_power_gain (dsbuffer_t *self) {
     assert (self);
-    assert (self->fir_taps);
-    assert (output);
+    return self->window_power_gain;
+}
 
-    // Convolution
-    for (size_t ind_fsig = 0; ind_fsig < self->size; ind_fsig++) {
-        float s = 0.0;
-        for (size_t ind_tap = 0; ind_tap < self->num_fir_taps; ind_tap++) {
-            if (ind_fsig < ind_tap)
-                break;
-            // s += self->fir_taps[ind_tap] * input_signal[ind_fsig-ind_tap];
-            s += self->fir_taps[ind_tap] *
-                 self->data[(self->head + ind_fsig - ind_tap) % self->size];
-        }
-        output[ind_fsig] = s;
+
+// Central moments of a block of values, merged pairwise (Chan/Pebay)
+typedef struct {
+    double n;
+    double mean;
+    double m2, m3, m4; // sums of powers of deviations from mean
+} dsbuffer_moments;
+
+
+static void dsbuffer_moments_merge (dsbuffer_moments *a, const dsbuffer_moments *b) {
+    if (b->n == 0)
+        return;
+    if (a->n == 0) {
+        *a = *b;
+        return;
     }
+    double na = a->n, nb = b->n, n = na + nb;
+    double delta = b->mean - a->mean;
+    double d_n = delta / n;
+    double d_n2 = d_n * d_n;
+    double m2 = a->m2 + b->m2 + delta * d_n * na * nb;
+    double m3 = a->m3 + b->m3 + d_n2 * delta * na * nb * (na - nb) +
+                3 * d_n * (na * b->m2 - nb * a->m2);
+    double m4 = a->m4 + b->m4 +
+                d_n2 * d_n * delta * na * nb * (na * na - na * nb + nb * nb) +
+                6 * d_n2 * (na * na * b->m2 + nb * nb * a->m2) +
+                4 * d_n * (na * b->m3 - nb * a->m3);
+    a->n = n;
+    a->mean += nb * d_n;
+    a->m2 = m2;
+    a->m3 = m3;
+    a->m4 = m4;
 }
 
 
-float dsbuffer_mean (dsbuffer_t *self) {
-    assert (self);
-    float sum = 0.0;
-    for (size_t i = 0; i < self->size; i++)
-        sum += self->data[i];
-    return sum / self->size;
-}
+// Block size of dsbuffer_features and dsbuffer_spectral_features: short
+// enough for float sums to stay exact enough and to stay in L1, long enough
+// to vectorize
+#define DSBUFFER_FEATURE_BLOCK 64
 
+// Independent accumulators per sum in a block, like the SIMD kernels, so that
+// the loops are not serialized on one running sum (divides the block size)
+#define DSBUFFER_FEATURE_LANES 8
 
-float dsbuffer_sum (dsbuffer_t *self) {
+void dsbuffer_features (dsbuffer_t *self, unsigned mask, dsbuffer_time_features *features) {
     assert (self);
-    float sum = 0.0;
-    for (size_t i = 0; i < self->size; i++)
-        sum += self->data[i];
-    return sum;
-}
+    assert (features);
+    assert (self->size > 1);
 
+    bool need_m3 = mask & (DSBUFFER_FEATURE_SKEWNESS | DSBUFFER_FEATURE_KURTOSIS);
+    bool need_m4 = mask & DSBUFFER_FEATURE_KURTOSIS;
+    bool need_zero_crossings = mask & DSBUFFER_FEATURE_ZERO_CROSSING_RATE;
+
+    // window in time order as at most two contiguous spans
+    const float *span[2];
+    size_t span_size[2];
+    if (self->fft_supported || self->head == 0) {
+        span[0] = self->data + self->head;
+        span_size[0] = self->size;
+        span_size[1] = 0;
+    }
+    else {
+        span[0] = self->data + self->head;
+        span_size[0] = self->size - self->head;
+        span[1] = self->data;
+        span_size[1] = self->head;
+    }
 
-float dsbuffer_length (dsbuffer_t *self) {
-    assert (self);
-    float ss = 0.0;
-    for (size_t i = 0; i < self->size; i++)
-        ss += self->data[i] * self->data[i];
-    return sqrt (ss);
-}
+    dsbuffer_moments total = {0, 0, 0, 0, 0};
+    double energy = 0;
+    float maxv = span[0][0], minv = span[0][0];
+    size_t zero_crossings = 0;
+    bool prev_negative = span[0][0] < 0;
+
+    for (int s = 0; s < 2; s++) {
+        for (size_t begin = 0; begin < span_size[s]; begin += DSBUFFER_FEATURE_BLOCK) {
+            const float *x = span[s] + begin;
+            size_t n = span_size[s] - begin;
+            if (n > DSBUFFER_FEATURE_BLOCK)
+                n = DSBUFFER_FEATURE_BLOCK;
+
+            // sums of powers of deviations from the first value of block,
+            // by lane; the tail goes to lane 0
+            const size_t L = DSBUFFER_FEATURE_LANES;
+            float shift = x[0];
+            float s1[DSBUFFER_FEATURE_LANES] = {0}, s2[DSBUFFER_FEATURE_LANES] = {0};
+            float s3[DSBUFFER_FEATURE_LANES] = {0}, s4[DSBUFFER_FEATURE_LANES] = {0};
+            float sq[DSBUFFER_FEATURE_LANES] = {0};
+            float lane_max[DSBUFFER_FEATURE_LANES], lane_min[DSBUFFER_FEATURE_LANES];
+            for (size_t j = 0; j < L; j++)
+                lane_max[j] = lane_min[j] = shift;
+
+            size_t i = 0;
+            if (need_m3) {
+                for (; i + L <= n; i += L) {
+                    for (size_t j = 0; j < L; j++) {
+                        float v = x[i+j], d = v - shift, d2 = d * d;
+                        s1[j] += d;
+                        s2[j] += d2;
+                        s3[j] += d2 * d;
+                        s4[j] += d2 * d2;
+                        sq[j] += v * v;
+                        lane_max[j] = (v > lane_max[j]) ? v : lane_max[j];
+                        lane_min[j] = (v < lane_min[j]) ? v : lane_min[j];
+                    }
+                }
+            }
+            else {
+                for (; i + L <= n; i += L) {
+                    for (size_t j = 0; j < L; j++) {
+                        float v = x[i+j], d = v - shift;
+                        s1[j] += d;
+                        s2[j] += d * d;
+                        sq[j] += v * v;
+                        lane_max[j] = (v > lane_max[j]) ? v : lane_max[j];
+                        lane_min[j] = (v < lane_min[j]) ? v : lane_min[j];
+                    }
+                }
+            }
+            for (; i < n; i++) {
+                float v = x[i], d = v - shift, d2 = d * d;
+                s1[0] += d;
+                s2[0] += d2;
+                s3[0] += d2 * d;
+                s4[0] += d2 * d2;
+                sq[0] += v * v;
+                lane_max[0] = (v > lane_max[0]) ? v : lane_max[0];
+                lane_min[0] = (v < lane_min[0]) ? v : lane_min[0];
+            }
 
+            float block_max = lane_max[0], block_min = lane_min[0];
+            for (size_t j = 1; j < L; j++) {
+                s1[0] += s1[j];
+                s2[0] += s2[j];
+                s3[0] += s3[j];
+                s4[0] += s4[j];
+                sq[0] += sq[j];
+                block_max = (lane_max[j] > block_max) ? lane_max[j] : block_max;
+                block_min = (lane_min[j] < block_min) ? lane_min[j] : block_min;
+            }
 
-float dsbuffer_energy (dsbuffer_t *self) {
-    assert (self);
-    float ss = 0.0;
-    for (size_t i = 0; i < self->size; i++)
-        ss += self->data[i] * self->data[i];
-    return ss;
-}
+            // sign changes against the previous point, carried across blocks
+            if (need_zero_crossings) {
+                unsigned crossings[DSBUFFER_FEATURE_LANES] = {0};
+                crossings[0] = ((x[0] < 0) != prev_negative);
+                for (i = 1; i + L <= n; i += L)
+                    for (size_t j = 0; j < L; j++)
+                        crossings[j] += ((x[i+j] < 0) != (x[i+j-1] < 0));
+                for (; i < n; i++)
+                    crossings[0] += ((x[i] < 0) != (x[i-1] < 0));
+                for (size_t j = 0; j < L; j++)
+                    zero_crossings += crossings[j];
+                prev_negative = x[n-1] < 0;
+            }
 
+            // to central moments of block
+            dsbuffer_moments block;
+            double mu = (double) s1[0] / n;
+            block.n = n;
+            block.mean = shift + mu;
+            block.m2 = s2[0] - n * mu * mu;
+            block.m3 = need_m3 ? s3[0] - 3 * mu * s2[0] + 2 * n * mu * mu * mu : 0;
+            block.m4 = need_m4 ? s4[0] - 4 * mu * s3[0] + 6 * mu * mu * s2[0] - 3 * n * mu * mu * mu * mu : 0;
+            if (block.m2 < 0)
+                block.m2 = 0;
+            dsbuffer_moments_merge (&total, &block);
+
+            energy += sq[0];
+            maxv = (block_max > maxv) ? block_max : maxv;
+            minv = (block_min < minv) ? block_min : minv;
+        }
+    }
 
-float dsbuffer_max (dsbuffer_t *self) {
-    assert (self);
-    assert (self->size > 0);
-    float maxv = self->data[0];
-    for (size_t i = 1; i < self->size; i++)
-        if (self->data[i] > maxv)
-            maxv = self->data[i];
-    return maxv;
+    memset (features, 0, sizeof (dsbuffer_time_features));
+    double n = self->size;
+    if (mask & DSBUFFER_FEATURE_MEAN)
+        features->mean = total.mean;
+    if (mask & DSBUFFER_FEATURE_VARIANCE) {
+        features->variance = total.m2 / (n - 1);
+        features->std = sqrt (total.m2 / (n - 1));
+    }
+    if (mask & DSBUFFER_FEATURE_MAX)
+        features->max = maxv;
+    if (mask & DSBUFFER_FEATURE_MIN)
+        features->min = minv;
+    if (mask & DSBUFFER_FEATURE_ENERGY) {
+        features->energy = energy;
+        features->rms = sqrt (energy / n);
+    }
+    if (total.m2 > 0) {
+        double m2 = total.m2 / n;
+        if (mask & DSBUFFER_FEATURE_SKEWNESS)
+            features->skewness = (total.m3 / n) / (m2 * sqrt (m2));
+        if (mask & DSBUFFER_FEATURE_KURTOSIS)
+            features->kurtosis = (total.m4 / n) / (m2 * m2) - 3;
+    }
+    if (need_zero_crossings)
+        features->zero_crossing_rate = zero_crossings / (n - 1);
+
+    if (mask & DSBUFFER_FEATURE_MEAN_CROSSING_RATE) {
+        float mean = total.mean;
+        size_t crossings = 0;
+        bool prev_below = span[0][0] < mean;
+        for (int s = 0; s < 2; s++) {
+            for (size_t i = 0; i < span_size[s]; i++) {
+                bool below = span[s][i] < mean;
+                crossings += (below != prev_below);
+                prev_below = below;
+            }
+        }
+        features->mean_crossing_rate = crossings / (n - 1);
+    }
 }
 
 
-float dsbuffer_min (dsbuffer_t *self) {
-    assert (self);
-    assert (self->size > 0);
-    float minv = self->data[0];
-    for (size_t i = 1; i < self->size; i++)
-        if (self->data[i] < minv)
-            minv = self->data[i];
-    return minv;
+// Insert peak into list sorted by descending power, keeping at most capacity
+static void dsbuffer_insert_peak (dsbuffer_spectral_features *features,
+                                  size_t capacity,
+                                  float freq,
+                                  float power) {
+    size_t pos = features->num_peaks;
+    while (pos > 0 && features->peak_power[pos-1] < power)
+        pos--;
+    if (pos >= capacity)
+        return;
+    size_t last = (features->num_peaks < capacity) ?
+                  features->num_peaks : capacity - 1;
+    for (size_t i = last; i > pos; i--) {
+        features->peak_freq[i] = features->peak_freq[i-1];
+        features->peak_power[i] = features->peak_power[i-1];
+    }
+    features->peak_freq[pos] = freq;
+    features->peak_power[pos] = power;
+    if (features->num_peaks < capacity)
+        features->num_peaks++;
 }
 
 
-float dsbuffer_variance (dsbuffer_t *self) {
-    assert (self);
-    assert (self->size > 1);
-    float mean = dsbuffer_mean(self);
-    float ss = 0.0;
-    for (size_t i = 0; i < self->size; i++) {
-        float c = self->data[i] - mean;
-        ss += c * c;
+void dsbuffer_fft_features (const dsbuffer_complex *fft_data,
+                            size_t num_bins,
+                            float fs,
+                            const float *band_edges,
+                            size_t num_bands,
+                            float rolloff_ratio,
+                            size_t num_peaks,
+                            dsbuffer_spectral_features *features) {
+    assert (fft_data);
+    assert (features);
+    assert (num_bins > 1);
+    assert (fs > 0);
+    assert (num_bands <= DSBUFFER_MAX_BANDS);
+    assert (num_bands == 0 || band_edges);
+    assert (num_peaks <= DSBUFFER_MAX_PEAKS);
+
+    // Bins are processed in blocks, so power is read once from fft_data and
+    // the logarithm can be vectorized.
+    float power[DSBUFFER_FEATURE_BLOCK], log_power[DSBUFFER_FEATURE_BLOCK];
+
+    float df = fs / (2 * (num_bins - 1));
+    float sum_p = 0, sum_fp = 0, sum_ffp = 0, sum_plogp = 0, sum_logp = 0;
+    float prev = 0, prev2 = 0; // power at bins k-1 and k-2
+    size_t band = 0;
+
+    memset (features, 0, sizeof (dsbuffer_spectral_features));
+
+    for (size_t start = 0; start < num_bins; start += DSBUFFER_FEATURE_BLOCK) {
+        size_t n = num_bins - start;
+        if (n > DSBUFFER_FEATURE_BLOCK)
+            n = DSBUFFER_FEATURE_BLOCK;
+
+        for (size_t i = 0; i < n; i++) {
+            size_t k = start + i;
+            float re = fft_data[k].real, im = fft_data[k].imag;
+            float p = re * re + im * im;
+            power[i] = (k == 0 || k == num_bins - 1) ? p : 2 * p;
+            log_power[i] = power[i] > FLT_MIN ? power[i] : FLT_MIN;
+        }
+        vectorf_log_fast (log_power, n, log_power);
+
+        for (size_t i = 0; i < n; i++) {
+            size_t k = start + i;
+            float p = power[i], f = k * df;
+            sum_p += p;
+            sum_fp += f * p;
+            sum_ffp += f * f * p;
+            sum_plogp += p * log_power[i];
+            sum_logp += log_power[i];
+
+            if (num_bands > 0) {
+                while (band < num_bands && f >= band_edges[band+1])
+                    band++;
+                if (band < num_bands && f >= band_edges[band])
+                    features->band_power[band] += p;
+            }
+
+            // bin k-1 is a peak if above both neighbours. DC and Nyquist
+            // have one neighbour only and are never peaks: DC would win for
+            // any signal with an offset, e.g. gravity in accelerometer data.
+            if (num_peaks > 0 && k >= 2 && prev > prev2 && prev >= p)
+                dsbuffer_insert_peak (features, num_peaks, (k-1) * df, prev);
+            prev2 = prev;
+            prev = p;
+        }
     }
-    return ss / (self->size - 1);
+
+    features->total_power = sum_p;
+    if (sum_p <= 0)
+        return;
+
+    features->centroid = sum_fp / sum_p;
+    float var = sum_ffp / sum_p - features->centroid * features->centroid;
+    features->spread = var > 0 ? sqrtf (var) : 0;
+    features->flatness = expf (sum_logp / num_bins) / (sum_p / num_bins);
+    // H = -sum(p/S * log(p/S)) = log(S) - sum(p*log(p))/S
+    features->entropy = (logf (sum_p) - sum_plogp / sum_p) / logf (num_bins);
+
+    // Roll-off needs the total, so it scans from the top until the
+    // remaining (1 - ratio) of power is passed, which is usually short.
+    float above = sum_p * (1 - rolloff_ratio), acc = 0;
+    size_t k = num_bins - 1;
+    for (; k > 0; k--) {
+        float re = fft_data[k].real, im = fft_data[k].imag;
+        float p = re * re + im * im;
+        acc += (k == num_bins - 1) ? p : 2 * p;
+        if (acc > above)
+            break;
+    }
+    features->rolloff = k * df;
 }
 
 
-float dsbuffer_std (dsbuffer_t *self) {
-    return sqrtf(dsbuffer_variance(self));
+void dsbuffer_setup_zoom_fft (dsbuffer_t *self,
+                              float fs,
+                              float f_start,
+                              float f_stop,
+                              size_t num_bins) {
+    assert (self);
+    assert (self->fft_supported);
+    assert (fs > 0);
+    assert (f_start <= f_stop);
+    assert (num_bins > 0);
+
+    float df = (num_bins > 1) ? (f_stop - f_start) / (num_bins - 1) : 0;
+
+    if (self->zoom_cfg)
+        kiss_czt_free (self->zoom_cfg);
+    self->zoom_cfg = kiss_czt_alloc ((int) self->size, (int) num_bins,
+                                     f_start / fs, df / fs, NULL, NULL);
+    assert (self->zoom_cfg);
+
+    self->num_zoom_bins = num_bins;
+    self->zoom_f_start = f_start;
+    self->zoom_df = df;
 }
 
 
-void dsbuffer_add (dsbuffer_t *self, float value, float *output) {
+void dsbuffer_zoom_fft (dsbuffer_t *self, dsbuffer_complex *output) {
     assert (self);
+    assert (self->zoom_cfg);
     assert (output);
-
-    if (self->fft_supported) {
-        for (size_t i = 0; i < self->size; i++)
-            output[i] = self->data[self->head+i] + value;
-    }
-    else {
-        size_t idx = self->head;
-        for (size_t i = 0; i < self->size; i++) {
-            output[i] = self->data[idx] + value;
-            if (++idx == self->size)
-                idx = 0;
-        }
-    }
+    kiss_czt_real (self->zoom_cfg, dsbuffer_fft_input (self), (kiss_fft_cpx *)output);
 }
 
 
-void dsbuffer_multiply (dsbuffer_t *self, float value, float *output) {
+void dsbuffer_zoom_fft_freq (dsbuffer_t *self, float *output) {
     assert (self);
+    assert (self->zoom_cfg);
     assert (output);
+    for (size_t idx = 0; idx < self->num_zoom_bins; idx++)
+        output[idx] = self->zoom_f_start + idx * self->zoom_df;
+}
 
-    if (self->fft_supported) {
-        for (size_t i = 0; i < self->size; i++)
-            output[i] = self->data[self->head+i] * value;
+
+void dsbuffer_analytic_signal (dsbuffer_t *self, float *envelope, float *phase) {
+    assert (self);
+
+    size_t n = self->size;
+    if (self->hilbert_fft_cfg == NULL) {
+        self->hilbert_fft_cfg = kiss_fft_alloc ((int) n, 0, NULL, NULL);
+        self->hilbert_ifft_cfg = kiss_fft_alloc ((int) n, 1, NULL, NULL);
+        self->hilbert_data = (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * 2 * n);
+        assert (self->hilbert_fft_cfg && self->hilbert_ifft_cfg);
+        assert (self->hilbert_data);
     }
-    else {
-        size_t idx = self->head;
-        for (size_t i = 0; i < self->size; i++) {
-            output[i] = self->data[idx] * value;
-            if (++idx == self->size)
-                idx = 0;
+    kiss_fft_cpx *in = self->hilbert_data, *spectrum = self->hilbert_data + n;
+
+    const float *first, *second;
+    size_t first_size = dsbuffer_view (self, &first, &second);
+    for (size_t t = 0; t < n; t++) {
+        in[t].r = (t < first_size) ? first[t] : second[t - first_size];
+        in[t].i = 0;
+    }
+    kiss_fft (self->hilbert_fft_cfg, in, spectrum);
+
+    // keep DC and Nyquist, double positive and drop negative frequencies,
+    // with 1/n of the inverse transform folded in
+    float scale = 1.0f / n;
+    size_t half = (n + 1) / 2; // first negative frequency
+    spectrum[0].r *= scale;
+    spectrum[0].i *= scale;
+    for (size_t k = 1; k < half; k++) {
+        spectrum[k].r *= 2 * scale;
+        spectrum[k].i *= 2 * scale;
+    }
+    if (n % 2 == 0) {
+        spectrum[n/2].r *= scale;
+        spectrum[n/2].i *= scale;
+        half++;
+    }
+    memset (spectrum + half, 0, sizeof (kiss_fft_cpx) * (n - half));
+    kiss_fft (self->hilbert_ifft_cfg, spectrum, in);
+
+    if (envelope) {
+        for (size_t t = 0; t < n; t++)
+            envelope[t] = sqrtf (in[t].r * in[t].r + in[t].i * in[t].i);
+    }
+    if (phase) {
+        float offset = 0, prev = 0;
+        for (size_t t = 0; t < n; t++) {
+            float p = atan2f (in[t].i, in[t].r);
+            if (t > 0) {
+                if (p - prev > M_PI)
+                    offset -= 2 * M_PI;
+                else if (p - prev < -M_PI)
+                    offset += 2 * M_PI;
+            }
+            prev = p;
+            phase[t] = p + offset;
         }
     }
 }
 
 
-void dsbuffer_mod (dsbuffer_t *self, float value, float *output) {
+// Free autocorrelation plans and scratch
+static void dsbuffer_free_autocorrelation (dsbuffer_t *self) {
+    if (self->acorr_fft_cfg)
+        kiss_fftr_free (self->acorr_fft_cfg);
+    if (self->acorr_ifft_cfg)
+        kiss_fftr_free (self->acorr_ifft_cfg);
+    free (self->acorr_data);
+    free (self->acorr_spectrum);
+    self->acorr_fft_cfg = NULL;
+    self->acorr_ifft_cfg = NULL;
+    self->acorr_data = NULL;
+    self->acorr_spectrum = NULL;
+    self->acorr_nfft = 0;
+}
+
+
+void dsbuffer_autocorrelation (dsbuffer_t *self,
+                               size_t max_lag,
+                               bool remove_mean,
+                               bool unbiased,
+                               float *output) {
     assert (self);
     assert (output);
+    assert (max_lag < self->size);
+
+    // zero padding to N+max_lag keeps lags up to max_lag free of wrap-around
+    if (self->acorr_fft_cfg == NULL || self->acorr_max_lag != max_lag) {
+        dsbuffer_free_autocorrelation (self);
+        size_t nfft = kiss_fftr_next_fast_size_real ((int) (self->size + max_lag));
+        self->acorr_fft_cfg = kiss_fftr_alloc ((int) nfft, 0, NULL, NULL);
+        self->acorr_ifft_cfg = kiss_fftr_alloc ((int) nfft, 1, NULL, NULL);
+        self->acorr_data = (float *) calloc (nfft, sizeof (float));
+        self->acorr_spectrum =
+            (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * (nfft/2+1));
+        assert (self->acorr_fft_cfg && self->acorr_ifft_cfg);
+        assert (self->acorr_data && self->acorr_spectrum);
+        self->acorr_nfft = nfft;
+        self->acorr_max_lag = max_lag;
+    }
 
-    if (self->fft_supported) {
-        for (size_t i = 0; i < self->size; i++)
-            output[i] = fmodf(self->data[self->head+i], value);
+    size_t nfft = self->acorr_nfft;
+    float *x = self->acorr_data;
+    if (remove_mean)
+        dsbuffer_remove_mean (self, x);
+    else
+        dsbuffer_dump (self, x);
+    memset (x + self->size, 0, sizeof (float) * (nfft - self->size));
+
+    // Wiener-Khinchin: autocorrelation is inverse transform of power
+    kiss_fftr (self->acorr_fft_cfg, x, self->acorr_spectrum);
+    for (size_t k = 0; k < nfft/2+1; k++) {
+        kiss_fft_cpx c = self->acorr_spectrum[k];
+        self->acorr_spectrum[k].r = c.r * c.r + c.i * c.i;
+        self->acorr_spectrum[k].i = 0;
     }
-    else {
-        size_t idx = self->head;
-        for (size_t i = 0; i < self->size; i++) {
-            output[i] = fmodf(self->data[idx], value);
-            if (++idx == self->size)
-                idx = 0;
-        }
+    kiss_fftri (self->acorr_ifft_cfg, self->acorr_spectrum, x);
+
+    for (size_t lag = 0; lag <= max_lag; lag++) {
+        size_t count = unbiased ? (self->size - lag) : self->size;
+        output[lag] = x[lag] / ((float) nfft * count);
     }
 }
 
 
-void dsbuffer_sqrt (dsbuffer_t *self, float *output) {
-    assert (self);
-    assert (output);
-
-    if (self->fft_supported) {
-        for (size_t i = 0; i < self->size; i++)
-            output[i] = sqrtf(self->data[self->head+i]);
+float dsbuffer_autocorrelation_peak (const float *acf,
+                                     size_t num_lags,
+                                     float threshold,
+                                     float *peak_value) {
+    assert (acf);
+
+    // skip the lobe around lag 0: descend until the first rise
+    size_t start = 1;
+    while (start + 1 < num_lags && acf[start] >= acf[start+1])
+        start++;
+
+    // highest local maximum
+    float highest = -FLT_MAX;
+    for (size_t k = start; k + 1 < num_lags; k++)
+        if (acf[k] > acf[k-1] && acf[k] >= acf[k+1] && acf[k] > highest)
+            highest = acf[k];
+    if (highest == -FLT_MAX) {
+        if (peak_value)
+            *peak_value = 0;
+        return 0;
     }
-    else {
-        size_t idx = self->head;
-        for (size_t i = 0; i < self->size; i++) {
-            output[i] = sqrtf(self->data[idx]);
-            if (++idx == self->size)
-                idx = 0;
+
+    // first local maximum which is high enough
+    float level = highest > 0 ? threshold * highest : highest;
+    for (size_t k = start; k + 1 < num_lags; k++) {
+        if (acf[k] > acf[k-1] && acf[k] >= acf[k+1] && acf[k] >= level) {
+            float a = acf[k-1], b = acf[k], c = acf[k+1];
+            float denom = a - 2 * b + c;
+            float delta = (denom != 0) ? 0.5f * (a - c) / denom : 0;
+            if (peak_value)
+                *peak_value = b - 0.25f * (a - c) * delta;
+            return k + delta;
         }
     }
+    return 0; // not reached
 }
 
 
-void dsbuffer_remove_mean (dsbuffer_t *self, float *output) {
-    assert (self);
-    assert (output);
+// Copy chunk of source data into snapshot (lock held)
+static void dsbuffer_snapshot_copy_chunk (dsbuffer_snapshot_t *snapshot, size_t chunk) {
+    if (snapshot->copied[chunk])
+        return;
+    size_t begin = chunk * DSBUFFER_SNAPSHOT_CHUNK;
+    size_t end = begin + DSBUFFER_SNAPSHOT_CHUNK;
+    if (end > snapshot->ring_size)
+        end = snapshot->ring_size;
+    memcpy (snapshot->buffer->data + begin,
+            snapshot->source->data + begin,
+            sizeof (float) * (end - begin));
+    snapshot->copied[chunk] = 1;
+    snapshot->num_copied++;
+}
 
-    float mean = dsbuffer_mean (self);
 
-    if (self->fft_supported) {
-        for (size_t i = 0; i < self->size; i++)
-            output[i] = self->data[self->head + i] - mean;
-    }
-    else {
-        size_t idx = self->head;
-        for (size_t i = 0; i < self->size; i++) {
-            output[i] = self->data[idx] - mean;
-            if (++idx == self->size)
-                idx = 0;
-        }
+// Remove snapshot from source's list (lock held)
+static void dsbuffer_snapshot_detach (dsbuffer_snapshot_t *snapshot) {
+    dsbuffer_t *source = snapshot->source;
+    dsbuffer_snapshot_t **link = &source->snapshots;
+    while (*link != snapshot)
+        link = &(*link)->next;
+    *link = snapshot->next;
+    snapshot->next = NULL;
+    __atomic_store_n (&snapshot->source, NULL, __ATOMIC_RELEASE);
+    __atomic_sub_fetch (&source->num_snapshots, 1, __ATOMIC_RELAXED);
+}
+
+
+// Producer side: save the chunk about to be overwritten into every attached
+// snapshot which still shares it
+static void dsbuffer_snapshot_before_write (dsbuffer_t *self) {
+    size_t chunk = ((self->head + self->size) % self->ring_size) / DSBUFFER_SNAPSHOT_CHUNK;
+    if (chunk == self->snapshot_chunk)
+        return;
+
+    pthread_mutex_lock (&self->snapshot_lock);
+    dsbuffer_snapshot_t *snapshot = self->snapshots;
+    while (snapshot) {
+        dsbuffer_snapshot_t *next = snapshot->next;
+        dsbuffer_snapshot_copy_chunk (snapshot, chunk);
+        if (snapshot->num_copied == snapshot->num_chunks)
+            dsbuffer_snapshot_detach (snapshot);
+        snapshot = next;
     }
+    pthread_mutex_unlock (&self->snapshot_lock);
+    self->snapshot_chunk = chunk;
 }
 
 
-void dsbuffer_normalize_to_unit_length (dsbuffer_t *self,
-                                        bool remove_mean,
-                                        float *output) {
+dsbuffer_snapshot_t *dsbuffer_snapshot (dsbuffer_t *self) {
     assert (self);
-    assert (output);
 
-    if (remove_mean) {
-        dsbuffer_remove_mean (self, output);
+    dsbuffer_snapshot_t *snapshot =
+        (dsbuffer_snapshot_t *) malloc (sizeof (dsbuffer_snapshot_t));
+    assert (snapshot);
+
+    // Frozen buffer with the same layout. Data and FFT plan are left for
+    // later, so that nothing proportional to size is done here.
+    dsbuffer_t *buffer = (dsbuffer_t *) malloc (sizeof (dsbuffer_t));
+    assert (buffer);
+    // source ring, and its mirror for FFT
+    size_t alloc_size = self->fft_supported ? (self->ring_size + self->size) : self->size;
+    buffer->data = (float *) malloc (sizeof (float) * alloc_size);
+    assert (buffer->data);
+    buffer->size = self->size;
+    buffer->ring_size = self->size;
+    buffer->head = self->head;
+    if (is_power_of_2 (buffer->size))
+        buffer->pusher = self->fft_supported ?
+                         dsbuffer_push_fast_with_fft :
+                         dsbuffer_push_fast;
+    else
+        buffer->pusher = self->fft_supported ?
+                         dsbuffer_push_normal_with_fft :
+                         dsbuffer_push_normal;
+    buffer->fft_supported = self->fft_supported;
+    buffer->double_mapped = false;
+    buffer->fft_cfg = NULL;
+    buffer->fir_taps = NULL;
+    buffer->num_fir_taps = 0;
+    buffer->fir_getter = NULL;
+    buffer->kernels = self->kernels;
+    dsbuffer_init_extensions (buffer);
+
+    snapshot->source = self;
+    snapshot->buffer = buffer;
+    snapshot->ring_size = self->ring_size;
+    snapshot->num_chunks = (self->ring_size + DSBUFFER_SNAPSHOT_CHUNK - 1) / DSBUFFER_SNAPSHOT_CHUNK;
+    snapshot->copied = (unsigned char *) calloc (snapshot->num_chunks, 1);
+    assert (snapshot->copied);
+    snapshot->num_copied = 0;
+    snapshot->finished = false;
+
+    pthread_mutex_lock (&self->snapshot_lock);
+    snapshot->next = self->snapshots;
+    self->snapshots = snapshot;
+    __atomic_add_fetch (&self->num_snapshots, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock (&self->snapshot_lock);
+
+    // next push must check its chunk again
+    self->snapshot_chunk = SIZE_MAX;
+    return snapshot;
+}
 
-        float length = 0.0;
-        for (size_t i = 0; i < self->size; i++) {
-            length += output[i] * output[i];
-        }
-        length = sqrtf (length);
 
-        if (length > 0) {
-            for (size_t i = 0; i < self->size; i++)
-                output[i] /= length;
+dsbuffer_t *dsbuffer_snapshot_buffer (dsbuffer_snapshot_t *snapshot) {
+    assert (snapshot);
+    if (snapshot->finished)
+        return snapshot->buffer;
+
+    dsbuffer_t *source = __atomic_load_n (&snapshot->source, __ATOMIC_ACQUIRE);
+    if (source) {
+        pthread_mutex_lock (&source->snapshot_lock);
+        if (snapshot->source) { // not detached by producer meanwhile
+            for (size_t chunk = 0; chunk < snapshot->num_chunks; chunk++)
+                dsbuffer_snapshot_copy_chunk (snapshot, chunk);
+            dsbuffer_snapshot_detach (snapshot);
         }
+        pthread_mutex_unlock (&source->snapshot_lock);
     }
-    else {
-        float length = dsbuffer_length (self);
-        if (length > 0)
-            dsbuffer_multiply (self, 1/length, output);
-        else
-            dsbuffer_dump (self, output);
+
+    dsbuffer_t *buffer = snapshot->buffer;
+    if (buffer->fft_supported) {
+        memcpy (buffer->data + snapshot->ring_size, buffer->data, sizeof (float) * buffer->size);
+        if (snapshot->ring_size != buffer->size) {
+            // window of a longer double mapped ring to the usual layout
+            memmove (buffer->data, buffer->data + buffer->head, sizeof (float) * buffer->size);
+            memcpy (buffer->data + buffer->size, buffer->data, sizeof (float) * buffer->size);
+            buffer->head = 0;
+        }
+        buffer->fft_cfg = kiss_fftr_alloc ((int) buffer->size, 0, NULL, NULL);
+        assert (buffer->fft_cfg);
     }
+    free (snapshot->copied);
+    snapshot->copied = NULL;
+    snapshot->finished = true;
+    return buffer;
 }
 
 
-void dsbuffer_normalize_to_unit_variance (dsbuffer_t *self,
-                                          bool remove_mean,
-                                          float *output) {
-    assert (self);
-    assert (output);
-    
-    if (self->size == 0)
+void dsbuffer_snapshot_free (dsbuffer_snapshot_t **snapshot_p) {
+    assert (snapshot_p);
+    dsbuffer_snapshot_t *snapshot = *snapshot_p;
+    if (snapshot == NULL)
         return;
-    
-    if (self->size == 1) {
-        output[0] = 1;
-        return;
-    }
-    
-    // Compute mean and std
-    float mean = dsbuffer_mean(self);
-    float ss = 0.0;
-    for (size_t i = 0; i < self->size; i++) {
-        float c = self->data[i] - mean;
-        ss += c * c;
-    }
-    float std = ss / (self->size - 1);
-    
-    if (remove_mean) {
-        // v -> (v-mean)/std
-        dsbuffer_add(self, -mean, output);
-        if (std > 0) {
-            for (size_t i = 0; i < self->size; i++)
-                output[i] /= std;
-        }
+
+    dsbuffer_t *source = __atomic_load_n (&snapshot->source, __ATOMIC_ACQUIRE);
+    if (source) {
+        pthread_mutex_lock (&source->snapshot_lock);
+        if (snapshot->source)
+            dsbuffer_snapshot_detach (snapshot);
+        pthread_mutex_unlock (&source->snapshot_lock);
     }
-    else {
-        // v -> v/std
-        if (std > 0) {
-            dsbuffer_multiply(self, 1/std, output);
-        }
-        else
-            dsbuffer_dump(self, output);
+    dsbuffer_free_unsafe (snapshot->buffer);
+    free (snapshot->copied);
+    free (snapshot);
+    *snapshot_p = NULL;
+}
+
+
+// Attached snapshots take their remaining chunks now, before all data is
+// overwritten or freed
+static void dsbuffer_snapshot_detach_all (dsbuffer_t *self) {
+    pthread_mutex_lock (&self->snapshot_lock);
+    while (self->snapshots) {
+        dsbuffer_snapshot_t *snapshot = self->snapshots;
+        for (size_t chunk = 0; chunk < snapshot->num_chunks; chunk++)
+            dsbuffer_snapshot_copy_chunk (snapshot, chunk);
+        dsbuffer_snapshot_detach (snapshot);
     }
+    pthread_mutex_unlock (&self->snapshot_lock);
 }
 
 
-float dsbuffer_dot_product (dsbuffer_t *self, const float *vector) {
+static void dsbuffer_free_extensions (dsbuffer_t *self) {
+    dsbuffer_snapshot_detach_all (self);
+    pthread_mutex_destroy (&self->snapshot_lock);
+
+    if (self->zoom_cfg)
+        kiss_czt_free (self->zoom_cfg);
+    if (self->ifft_cfg)
+        kiss_fftr_free (self->ifft_cfg);
+    free (self->spectrum);
+    dsbuffer_free_autocorrelation (self);
+    if (self->hilbert_fft_cfg)
+        kiss_fft_free (self->hilbert_fft_cfg);
+    if (self->hilbert_ifft_cfg)
+        kiss_fft_free (self->hilbert_ifft_cfg);
+    free (self->hilbert_data);
+    free (self->window);
+    free (self->windowed);
+    if (self->order_stats)
+        orderstat_free (&self->order_stats);
+    if (self->peak_detector)
+        peakdetect_free (&self->peak_detector);
+}
+
+
+void dsbuffer_setup_order_statistics (dsbuffer_t *self, size_t window_size) {
     assert (self);
-    assert (vector);
+    assert (window_size > 0 && window_size <= self->size);
+    if (self->order_stats)
+        orderstat_free (&self->order_stats);
+    self->order_stats = orderstat_new (window_size);
+    assert (self->order_stats);
+    for (size_t i = self->size - window_size; i < self->size; i++)
+        orderstat_push (self->order_stats, dsbuffer_at (self, i));
+}
 
-    float result = 0.0;
-    if (self->fft_supported) {
-        for (size_t i = 0; i < self->size; i++)
-            result += self->data[self->head + i] * vector[i];
-    }
-    else {
-        size_t idx = self->head;
-        for (size_t i = 0; i < self->size; i++) {
-            result += self->data[idx] * vector[i];
-            if (++idx == self->size)
-                idx = 0;
-        }
-    }
-    return result;
+
+float dsbuffer_order_statistic (dsbuffer_t *self, size_t k) {
+    assert (self);
+    assert (self->order_stats);
+    return orderstat_kth (self->order_stats, k);
 }
 
 
-void dsbuffer_clear (dsbuffer_t *self) {
+float dsbuffer_quantile (dsbuffer_t *self, float q) {
     assert (self);
-    memset (self->data, 0, sizeof (float) *
-                           (self->fft_supported ? (2*self->size) : self->size));
-    self->head = 0;
+    assert (self->order_stats);
+    return orderstat_quantile (self->order_stats, q);
 }
 
 
-void dsbuffer_print (dsbuffer_t *self) {
+float dsbuffer_latest_median_output (dsbuffer_t *self) {
     assert (self);
-    printf ("DSBuffer size: %zu\n", self->size);
+    assert (self->order_stats);
+    return orderstat_median (self->order_stats);
+}
 
-    if (self->fft_supported) {
-        for (size_t idx = 0; idx < self->size; idx++)
-            printf ("%.2f ", self->data[self->head + idx]);
-        printf ("\n");
-    }
-    else {
-        for (size_t cnt = 0, idx = 0; cnt < self->size; cnt++) {
-            printf ("%.2f ", self->data[self->head + idx]);
-            if (++idx == self->size)
-                idx = 0;
-        }
-        printf ("\n");
-    }
+
+void dsbuffer_setup_peak_detector (dsbuffer_t *self,
+                                   float min_height,
+                                   float min_prominence,
+                                   size_t min_distance,
+                                   float threshold_k,
+                                   size_t threshold_window,
+                                   size_t max_peaks) {
+    assert (self);
+    if (self->peak_detector)
+        peakdetect_free (&self->peak_detector);
+    self->peak_detector = peakdetect_new (min_height, min_prominence, min_distance,
+                                          threshold_k, threshold_window, max_peaks);
+    assert (self->peak_detector);
 }
 
 
-void dsbuffer_free (dsbuffer_t **self_p) {
-    assert (self_p);
-    if (*self_p) {
-        dsbuffer_t *self = *self_p;
-        free (self->data);
-        if (self->fft_cfg)
-            free (self->fft_cfg);
-        free (self);
-        *self_p = NULL;
-    }
+size_t dsbuffer_peak_count (dsbuffer_t *self) {
+    assert (self);
+    assert (self->peak_detector);
+    return peakdetect_count (self->peak_detector);
 }
 
 
-void dsbuffer_free_unsafe (dsbuffer_t *self) {
+size_t dsbuffer_recent_peaks (dsbuffer_t *self, peakdetect_peak_t *output, size_t max_peaks) {
     assert (self);
-    free (self->data);
-    if (self->fft_cfg)
-        free (self->fft_cfg);
-    free (self);
+    assert (self->peak_detector);
+    size_t n = peakdetect_num_recent (self->peak_detector);
+    if (n > max_peaks)
+        n = max_peaks;
+    for (size_t i = 0; i < n; i++)
+        peakdetect_recent (self->peak_detector, i, &output[i]);
+    return n;
+}
+
+
+// Producer thread of snapshot test
+static void *dsbuffer_test_producer (void *buf) {
+    for (int t = 0; t < 100000; t++)
+        dsbuffer_push ((dsbuffer_t *) buf, -t);
+    return NULL;
 }
 
 
@@ -663,6 +1253,8 @@ void dsbuffer_test () {
                idx, fft_freq[idx], fft_data[idx].real, fft_data[idx].imag);
     }
 
+    free (fft_freq);
+    free (fft_data);
     dsbuffer_free (&buf);
 
 
@@ -781,5 +1373,523 @@ void dsbuffer_test () {
     dsbuffer_free (&buf);
 
 
+    // 9. FFT of awkward size (chirp-z path) and zoom FFT, against naive DFT
+    size = 2 * 127;
+    buf = dsbuffer_new (size, true);
+    assert (buf);
+    for (size_t t = 0; t < size + 17; t++)
+        dsbuffer_push (buf, sinf (0.3f * t) + 0.5f * cosf (1.7f * t));
+
+    dumped = (float *) malloc (sizeof (float) * size);
+    assert (dumped);
+    dsbuffer_dump (buf, dumped);
+
+    fft_data = (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * (size/2+1));
+    assert (fft_data);
+    dsbuffer_fftr (buf, fft_data);
+    for (size_t k = 0; k < size/2+1; k++) {
+        double re = 0, im = 0;
+        for (size_t t = 0; t < size; t++) {
+            re += dumped[t] * cos (-2 * M_PI * k * t / size);
+            im += dumped[t] * sin (-2 * M_PI * k * t / size);
+        }
+        assert (fabs (fft_data[k].real - re) < 1e-2);
+        assert (fabs (fft_data[k].imag - im) < 1e-2);
+    }
+    free (fft_data);
+
+    size_t num_bins = 33;
+    float fs = 50.0, f_start = 2.0, f_stop = 3.0;
+    dsbuffer_setup_zoom_fft (buf, fs, f_start, f_stop, num_bins);
+    fft_data = (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * num_bins);
+    fft_freq = (float *) malloc (sizeof (float) * num_bins);
+    assert (fft_data && fft_freq);
+    dsbuffer_zoom_fft (buf, fft_data);
+    dsbuffer_zoom_fft_freq (buf, fft_freq);
+    assert (fabs (fft_freq[num_bins-1] - f_stop) < 1e-4);
+    for (size_t k = 0; k < num_bins; k++) {
+        double re = 0, im = 0;
+        for (size_t t = 0; t < size; t++) {
+            re += dumped[t] * cos (-2 * M_PI * fft_freq[k] / fs * t);
+            im += dumped[t] * sin (-2 * M_PI * fft_freq[k] / fs * t);
+        }
+        assert (fabs (fft_data[k].real - re) < 1e-2);
+        assert (fabs (fft_data[k].imag - im) < 1e-2);
+    }
+
+    free (fft_freq);
+    free (fft_data);
+    free (dumped);
+    dsbuffer_free (&buf);
+
+#ifdef KISS_FFT_COUNT_ALLOCS
+    // 10. FFT paths perform no heap allocation in steady state (power of 2,
+    //     generic radix 7*11, and chirp-z sizes): forward FFT with window,
+    //     inverse FFT, filtering and zoom FFT, once their on-demand scratch
+    //     exists. Counted are the allocations of kissfft and of this file;
+    //     the vectorf and window functions on the way do not allocate.
+    size_t sizes[] = {64, 2 * 7 * 11, 2 * 127};
+    for (size_t s = 0; s < sizeof (sizes) / sizeof (size_t); s++) {
+        size = sizes[s];
+        buf = dsbuffer_new (size, true);
+        assert (buf);
+        fft_data = (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * (size/2+1));
+        float *filtered = (float *) malloc (sizeof (float) * size);
+        float *pass = (float *) malloc (sizeof (float) * (size/2+1));
+        dsbuffer_complex zoomed[16];
+        assert (fft_data && filtered && pass);
+        for (size_t k = 0; k < size/2+1; k++)
+            pass[k] = 1;
+        dsbuffer_setup_window (buf, WINDOW_HANN, 0);
+        dsbuffer_setup_zoom_fft (buf, 100, 10, 20, 16);
+        dsbuffer_ifftr (buf, fft_data, filtered);
+        dsbuffer_fft_filter (buf, pass, filtered);
+
+        size_t alloc_count = kiss_fft_alloc_count;
+        size_t dsbuffer_count = dsbuffer_alloc_count;
+        assert (dsbuffer_count > 0); // the hook sees the setup above
+        for (size_t t = 0; t < 1000; t++) {
+            dsbuffer_push (buf, (float) rand () / RAND_MAX);
+            dsbuffer_fftr (buf, fft_data);
+            dsbuffer_ifftr (buf, fft_data, filtered);
+            dsbuffer_fft_filter (buf, pass, filtered);
+            dsbuffer_zoom_fft (buf, zoomed);
+        }
+        assert (kiss_fft_alloc_count == alloc_count);
+        assert (dsbuffer_alloc_count == dsbuffer_count);
+
+        free (fft_data);
+        free (filtered);
+        free (pass);
+        dsbuffer_free (&buf);
+    }
+#endif
+
+    // 11. Windowed FFT: DC bin of constant signal is sum of window
+    size = 64;
+    buf = dsbuffer_new (size, true);
+    assert (buf);
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (buf, 1.0);
+    dsbuffer_setup_window (buf, WINDOW_HANN, 0);
+    assert (fabs (dsbuffer_window_coherent_gain (buf) - 0.5) < 1e-6);
+    assert (fabs (dsbuffer_window_power_gain (buf) - 0.375) < 1e-6);
+
+    fft_data = (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * (size/2+1));
+    assert (fft_data);
+    dsbuffer_fftr (buf, fft_data);
+    assert (fabs (fft_data[0].real - size * 0.5) < 1e-3);
+    assert (fabs (fft_data[2].real) < 1e-3);
+
+    dsbuffer_setup_window (buf, WINDOW_KAISER, 8.6);
+    dsbuffer_setup_window (buf, WINDOW_RECTANGULAR, 0);
+    dsbuffer_fftr (buf, fft_data);
+    assert (fabs (fft_data[0].real - size) < 1e-3);
+
+    // 12. Spectral features of two tones at bins 8 and 20
+    dsbuffer_setup_window (buf, WINDOW_RECTANGULAR, 0);
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (buf, sinf (2 * M_PI * 8 * t / size) +
+                            0.5f * sinf (2 * M_PI * 20 * t / size));
+    dsbuffer_fftr (buf, fft_data);
+
+    float band_edges[] = {0, 10, 32};
+    dsbuffer_spectral_features features;
+    dsbuffer_fft_features (fft_data, size/2+1, size, band_edges, 2, 0.9,
+                           3, &features);
+    // frequency equals bin index with fs = size
+    assert (features.num_peaks == 3);
+    assert (features.peak_power[2] < 1e-6 * features.peak_power[1]);
+    assert (fabs (features.peak_freq[0] - 8) < 1e-3);
+    assert (fabs (features.peak_freq[1] - 20) < 1e-3);
+    assert (fabs (features.band_power[0] / features.band_power[1] - 4) < 1e-2);
+    assert (fabs (features.total_power -
+                  features.band_power[0] - features.band_power[1]) < 1e-2);
+    assert (fabs (features.centroid - (8 * 4 + 20) / 5.0) < 1e-2);
+    assert (fabs (features.rolloff - 20) < 1e-3);
+    assert (features.flatness < 0.01);
+    assert (features.entropy > 0 && features.entropy < 0.3);
+
+    // large DC offset (e.g. gravity) is not a peak, the tone is
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (buf, 9.8f + 0.2f * sinf (2 * M_PI * 5 * t / size));
+    dsbuffer_fftr (buf, fft_data);
+    dsbuffer_fft_features (fft_data, size/2+1, size, NULL, 0, 0.9, 2, &features);
+    assert (features.num_peaks >= 1);
+    assert (fabs (features.peak_freq[0] - 5) < 1e-3);
+    for (size_t i = 0; i < features.num_peaks; i++)
+        assert (features.peak_freq[i] > 0 && features.peak_freq[i] < size / 2);
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (buf, sinf (2 * M_PI * 8 * t / size) +
+                            0.5f * sinf (2 * M_PI * 20 * t / size));
+    dsbuffer_fftr (buf, fft_data);
+
+    // 13. Inverse FFT and frequency-domain filtering
+    dumped = (float *) malloc (sizeof (float) * size);
+    output = (float *) malloc (sizeof (float) * size);
+    float *mask = (float *) malloc (sizeof (float) * (size/2+1));
+    assert (dumped && output && mask);
+
+    dsbuffer_dump (buf, dumped);
+    dsbuffer_ifftr (buf, fft_data, output);
+    for (size_t t = 0; t < size; t++)
+        assert (fabs (output[t] - dumped[t]) < 1e-4);
+
+    // low-pass: keep bin 8, drop bin 20
+    for (size_t k = 0; k < size/2+1; k++)
+        mask[k] = k < 14 ? 1 : 0;
+    dsbuffer_fft_filter (buf, mask, output);
+    for (size_t t = 0; t < size; t++)
+        assert (fabs (output[t] - sinf (2 * M_PI * 8 * t / size)) < 1e-4);
+
+    free (mask);
+    free (output);
+    free (dumped);
+    free (fft_data);
+    dsbuffer_free (&buf);
+
+    // 14. Autocorrelation by FFT against direct sums, and period detection
+    size = 100;
+    size_t max_lag = 60;
+    buf = dsbuffer_new (size, false);
+    assert (buf);
+    for (size_t t = 0; t < size + 7; t++)
+        dsbuffer_push (buf, 1.0f + sinf (2 * M_PI * t / 12.5f) +
+                            0.1f * rand () / RAND_MAX);
+
+    dumped = (float *) malloc (sizeof (float) * size);
+    output = (float *) malloc (sizeof (float) * (max_lag + 1));
+    assert (dumped && output);
+    dsbuffer_remove_mean (buf, dumped);
+
+    for (int pass = 0; pass < 2; pass++) {
+        bool unbiased = pass == 1;
+        dsbuffer_autocorrelation (buf, max_lag, true, unbiased, output);
+        for (size_t lag = 0; lag <= max_lag; lag++) {
+            double r = 0;
+            for (size_t t = 0; t + lag < size; t++)
+                r += dumped[t] * dumped[t+lag];
+            r /= unbiased ? (size - lag) : size;
+            assert (fabs (output[lag] - r) < 1e-4);
+        }
+    }
+    float peak_lag = dsbuffer_autocorrelation_peak (output, max_lag + 1, 0.8, NULL);
+    assert (fabs (peak_lag - 12.5) < 0.5);
+
+    free (output);
+    free (dumped);
+    dsbuffer_free (&buf);
+
+    // 15. Analytic signal of AM tone: envelope and linear phase
+    size = 256;
+    for (int pass = 0; pass < 2; pass++) {
+        buf = dsbuffer_new (size + pass, pass == 0); // even and odd sizes
+        assert (buf);
+        size_t n = size + pass;
+        for (size_t t = 0; t < n + 11; t++) {
+            size_t i = (t + n - 11) % n; // index in the window once filled
+            dsbuffer_push (buf, (1 + 0.5f * cosf (2 * M_PI * 2 * i / n)) *
+                                cosf (2 * M_PI * 32 * i / n));
+        }
+        float *envelope = (float *) malloc (sizeof (float) * n);
+        float *phase = (float *) malloc (sizeof (float) * n);
+        assert (envelope && phase);
+        dsbuffer_analytic_signal (buf, envelope, phase);
+        for (size_t t = 0; t < n; t++) {
+            assert (fabs (envelope[t] - (1 + 0.5f * cosf (2 * M_PI * 2 * t / n))) < 1e-2);
+            assert (fabs (phase[t] - phase[0] - 2 * M_PI * 32 * t / n) < 1e-2 * (t + 1));
+        }
+        free (envelope);
+        free (phase);
+        dsbuffer_free (&buf);
+    }
+
+    // 16. Double mapped buffer behaves like a normal FFT buffer, for whole
+    // pages (16 KB) and sizes rounded up to whole pages
+    size_t mapped_sizes[3] = {4096, 15000, 10};
+    bool mapped = false;
+    for (int m = 0; m < 3; m++) {
+        size = mapped_sizes[m];
+        buf = dsbuffer_new_double_mapped (size);
+        dsbuffer_t *ref = dsbuffer_new (size, true);
+        assert (buf && ref);
+        if (m == 0) {
+            mapped = dsbuffer_is_double_mapped (buf);
+            printf ("double mapped: %s\n", mapped ? "yes" : "no (fallback)");
+        }
+        assert (dsbuffer_is_double_mapped (buf) == mapped);
+        float taps[8] = {0.3f, -0.2f, 0.1f, 0.4f, 0.05f, -0.1f, 0.2f, 0.25f};
+        dsbuffer_setup_fir (buf, taps, 8);
+        dsbuffer_setup_fir (ref, taps, 8);
+        for (size_t t = 0; t < 2 * size + 5000; t++) { // several times round the ring
+            float v = sinf (0.05f * t) + 0.001f * (t % 1000);
+            dsbuffer_push (buf, v);
+            dsbuffer_push (ref, v);
+            assert (dsbuffer_latest_fir_output (buf) == dsbuffer_latest_fir_output (ref));
+        }
+        float *dumped_ref = (float *) malloc (sizeof (float) * size);
+        dumped = (float *) malloc (sizeof (float) * size);
+        assert (dumped && dumped_ref);
+        dsbuffer_dump (buf, dumped);
+        dsbuffer_dump (ref, dumped_ref);
+        assert (memcmp (dumped, dumped_ref, sizeof (float) * size) == 0);
+        assert (dsbuffer_at (buf, size - 1) == dumped_ref[size - 1]);
+        dsbuffer_fir_filter (buf, dumped);
+        dsbuffer_fir_filter (ref, dumped_ref);
+        assert (memcmp (dumped, dumped_ref, sizeof (float) * size) == 0);
+        dsbuffer_complex *spectrum = (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * (size/2+1));
+        dsbuffer_complex *spectrum_ref = (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * (size/2+1));
+        assert (spectrum && spectrum_ref);
+        dsbuffer_fftr (buf, spectrum);
+        dsbuffer_fftr (ref, spectrum_ref);
+        assert (memcmp (spectrum, spectrum_ref, sizeof (dsbuffer_complex) * (size/2+1)) == 0);
+        // same values, summed in another rotation if the ring is longer
+        assert (fabsf (dsbuffer_sum (buf) - dsbuffer_sum (ref)) <= 1e-5f * dsbuffer_energy (ref));
+        assert (fabsf (dsbuffer_variance (buf) / dsbuffer_variance (ref) - 1) < 1e-4f);
+        dsbuffer_clear (buf);
+        assert (dsbuffer_energy (buf) == 0 && dsbuffer_at (buf, 0) == 0);
+        free (spectrum);
+        free (spectrum_ref);
+        free (dumped);
+        free (dumped_ref);
+        dsbuffer_free (&buf);
+        dsbuffer_free (&ref);
+    }
+
+    // 17. Snapshots: frozen data while pushes continue
+    // (FFT, normal, and double mapped whose ring is 1024 long with 4 KB pages)
+    for (int pass = 0; pass < 3; pass++) {
+        size = 1000; // 4 chunks, the last one partial
+        bool fft = (pass != 1);
+        buf = (pass == 2) ? dsbuffer_new_double_mapped (size) : dsbuffer_new (size, fft);
+        assert (buf);
+        for (size_t t = 0; t < 1500; t++)
+            dsbuffer_push (buf, t);
+        dumped = (float *) malloc (sizeof (float) * size);
+        assert (dumped);
+        dsbuffer_dump (buf, dumped);
+
+        dsbuffer_snapshot_t *snapshot = dsbuffer_snapshot (buf);
+        dsbuffer_snapshot_t *dropped = dsbuffer_snapshot (buf);
+        for (size_t t = 1500; t < 1800; t++) // overwrites 2 chunks
+            dsbuffer_push (buf, t);
+        dsbuffer_snapshot_free (&dropped);
+        assert (dropped == NULL);
+
+        dsbuffer_t *frozen = dsbuffer_snapshot_buffer (snapshot);
+        assert (frozen == dsbuffer_snapshot_buffer (snapshot));
+        for (size_t t = 1800; t < 2000; t++)
+            dsbuffer_push (buf, t);
+        for (size_t i = 0; i < size; i++)
+            assert (dsbuffer_at (frozen, i) == dumped[i]);
+        assert (dsbuffer_sum (frozen) == dsbuffer_sum (buf) - 500 * 1000);
+        assert (dsbuffer_max (frozen) == 1499 && dsbuffer_min (frozen) == 500);
+        if (fft) {
+            dsbuffer_t *ref = dsbuffer_new (size, true);
+            for (size_t i = 0; i < size; i++)
+                dsbuffer_push (ref, dumped[i]);
+            dsbuffer_complex spectrum[501], spectrum_ref[501];
+            dsbuffer_fftr (frozen, spectrum);
+            dsbuffer_fftr (ref, spectrum_ref);
+            assert (memcmp (spectrum, spectrum_ref, sizeof (spectrum)) == 0);
+            dsbuffer_free (&ref);
+        }
+
+        // snapshot outlives live buffer
+        dsbuffer_snapshot_t *orphan = dsbuffer_snapshot (buf);
+        dsbuffer_dump (buf, dumped);
+        dsbuffer_push (buf, -1);
+        dsbuffer_free (&buf);
+        frozen = dsbuffer_snapshot_buffer (orphan);
+        for (size_t i = 0; i < size; i++)
+            assert (dsbuffer_at (frozen, i) == dumped[i]);
+
+        dsbuffer_snapshot_free (&snapshot);
+        dsbuffer_snapshot_free (&orphan);
+        free (dumped);
+
+        // snapshot taken before clear keeps the data
+        buf = (pass == 2) ? dsbuffer_new_double_mapped (1020) : dsbuffer_new (1024, fft);
+        for (size_t t = 0; t < 1024; t++)
+            dsbuffer_push (buf, 1);
+        dsbuffer_snapshot_t *cleared = dsbuffer_snapshot (buf);
+        dsbuffer_clear (buf);
+        dsbuffer_push (buf, 5);
+        assert (dsbuffer_sum (buf) == 5);
+        frozen = dsbuffer_snapshot_buffer (cleared);
+        assert (dsbuffer_sum (frozen) == dsbuffer_size (frozen));
+        dsbuffer_snapshot_free (&cleared);
+        dsbuffer_free (&buf);
+    }
+
+    // analysis thread takes the snapshot data while producer keeps pushing
+    size = 4096;
+    buf = dsbuffer_new (size, true);
+    assert (buf);
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (buf, t);
+    dsbuffer_snapshot_t *snapshot = dsbuffer_snapshot (buf);
+    pthread_t producer;
+    pthread_create (&producer, NULL, dsbuffer_test_producer, buf);
+    dsbuffer_t *frozen = dsbuffer_snapshot_buffer (snapshot);
+    pthread_join (producer, NULL);
+    for (size_t i = 0; i < size; i++)
+        assert (dsbuffer_at (frozen, i) == i);
+    dsbuffer_snapshot_free (&snapshot);
+    dsbuffer_free (&buf);
+
+    // 18. Order statistics: 5-point median filter rejects spikes, and
+    // percentiles of whole buffer
+    size = 50;
+    buf = dsbuffer_new (size, false);
+    assert (buf);
+    for (size_t t = 0; t < 30; t++)
+        dsbuffer_push (buf, t);
+    dsbuffer_setup_order_statistics (buf, 5);
+    assert (dsbuffer_latest_median_output (buf) == 27); // latest 25 ... 29
+    for (size_t t = 30; t < 200; t++) {
+        float v = (t % 7 == 0) ? 1000.0f : (float) t; // isolated spikes
+        dsbuffer_push (buf, v);
+        // latest five hold at most one spike, which only shifts the median
+        // by one rank
+        float median = dsbuffer_latest_median_output (buf);
+        assert (median >= t - 3 && median <= t);
+    }
+    dsbuffer_setup_order_statistics (buf, size);
+    dumped = (float *) malloc (sizeof (float) * size);
+    assert (dumped);
+    dsbuffer_dump (buf, dumped);
+    size_t num_spikes = 0;
+    for (size_t i = 0; i < size; i++)
+        num_spikes += (dumped[i] == 1000.0f);
+    assert (dsbuffer_order_statistic (buf, size - 1) == 1000.0f);
+    assert (dsbuffer_order_statistic (buf, size - num_spikes - 1) == 199.0f);
+    assert (dsbuffer_order_statistic (buf, 0) == 150.0f);
+    assert (dsbuffer_quantile (buf, 0.1f) < dsbuffer_quantile (buf, 0.8f));
+    assert (dsbuffer_quantile (buf, 0.8f) < 1000.0f); // 7 spikes in 50
+    dsbuffer_clear (buf);
+    assert (dsbuffer_quantile (buf, 0.8f) == 0);
+    free (dumped);
+    dsbuffer_free (&buf);
+
+    // 19. Fused time-domain features against separate computations, with a
+    // large offset, in both layouts
+    for (int pass = 0; pass < 2; pass++) {
+        size = 300;
+        buf = dsbuffer_new (size, pass == 0);
+        assert (buf);
+        for (size_t t = 0; t < size + 77; t++) {
+            float u = sinf (0.21f * t) + 0.3f * sinf (0.05f * t) * sinf (0.05f * t);
+            dsbuffer_push (buf, 1000.0f + u);
+        }
+        dumped = (float *) malloc (sizeof (float) * size);
+        assert (dumped);
+        dsbuffer_dump (buf, dumped);
+        double mean = 0, energy = 0;
+        for (size_t i = 0; i < size; i++) {
+            mean += dumped[i];
+            energy += (double) dumped[i] * dumped[i];
+        }
+        mean /= size;
+        double m2 = 0, m3 = 0, m4 = 0;
+        size_t mean_crossings = 0;
+        for (size_t i = 0; i < size; i++) {
+            double d = dumped[i] - mean;
+            m2 += d * d;
+            m3 += d * d * d;
+            m4 += d * d * d * d;
+            if (i > 0)
+                mean_crossings += ((dumped[i] < mean) != (dumped[i-1] < mean));
+        }
+        double skewness = (m3 / size) / pow (m2 / size, 1.5);
+        double kurtosis = (m4 / size) / pow (m2 / size, 2) - 3;
+
+        dsbuffer_time_features features;
+        dsbuffer_features (buf, DSBUFFER_FEATURE_ALL, &features);
+        assert (fabs (features.mean - mean) < 1e-3);
+        assert (fabs (features.variance - m2 / (size - 1)) < 1e-4 * m2 / size);
+        assert (fabs (features.std - sqrt (m2 / (size - 1))) < 1e-4);
+        assert (features.max == dsbuffer_max (buf));
+        assert (features.min == dsbuffer_min (buf));
+        assert (fabs (features.energy - energy) < 1e-6 * energy);
+        assert (fabs (features.rms - sqrt (energy / size)) < 1e-3);
+        assert (fabs (features.skewness - skewness) < 1e-3);
+        assert (fabs (features.kurtosis - kurtosis) < 1e-3);
+        assert (features.zero_crossing_rate == 0); // all positive
+        assert (fabsf (features.mean_crossing_rate - mean_crossings / (size - 1.0f)) < 1e-6);
+
+        // subset leaves the others at zero
+        dsbuffer_features (buf, DSBUFFER_FEATURE_MAX | DSBUFFER_FEATURE_KURTOSIS, &features);
+        assert (features.max == dsbuffer_max (buf) && features.mean == 0);
+        assert (fabs (features.kurtosis - kurtosis) < 1e-3);
+
+        // zero crossings of centralized signal equal mean crossings
+        dsbuffer_remove_mean (buf, dumped);
+        dsbuffer_t *centered = dsbuffer_new (size, false);
+        for (size_t i = 0; i < size; i++)
+            dsbuffer_push (centered, dumped[i]);
+        dsbuffer_features (centered, DSBUFFER_FEATURE_ZERO_CROSSING_RATE, &features);
+        assert (fabsf (features.zero_crossing_rate - mean_crossings / (size - 1.0f)) < 2.0f / size);
+        dsbuffer_free (&centered);
+        free (dumped);
+        dsbuffer_free (&buf);
+    }
+
+    // 20. Peak detector on push path finds the same peaks as a scan, and
+    // is reset by clear
+    size = 64;
+    buf = dsbuffer_new (size, false);
+    dsbuffer_setup_peak_detector (buf, 0.5f, 0.2f, 5, 0, 0, 8);
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (buf, (t % 16 == 7) ? 1.0f : 0.0f);
+    assert (dsbuffer_peak_count (buf) == 4);
+    peakdetect_peak_t peaks[8];
+    assert (dsbuffer_recent_peaks (buf, peaks, 8) == 4);
+    for (size_t i = 0; i < 4; i++) {
+        assert (peaks[i].height == 1.0f);
+        assert (dsbuffer_at (buf, size - 1 - peaks[i].age) == 1.0f);
+        assert ((size - 1 - peaks[i].age) % 16 == 7);
+    }
+    assert (dsbuffer_recent_peaks (buf, peaks, 2) == 2 && peaks[1].age == peaks[0].age + 16);
+    dsbuffer_clear (buf);
+    assert (dsbuffer_peak_count (buf) == 0);
+    dsbuffer_free (&buf);
+
+    // 21. Element-wise operations with a vector follow time order, for
+    // wrapped and contiguous buffers
+    for (int fft = 0; fft < 2; fft++) {
+        size = 10;
+        buf = dsbuffer_new (size, fft);
+        for (size_t t = 0; t < size + 3; t++)
+            dsbuffer_push (buf, (float) t);
+        float weights[10], weighted[10];
+        for (size_t i = 0; i < size; i++)
+            weights[i] = (float) (i + 1);
+        dsbuffer_multiply_vector (buf, weights, weighted);
+        for (size_t i = 0; i < size; i++)
+            assert (weighted[i] == (i + 3) * (i + 1));
+        dsbuffer_add_vector (buf, weights, weighted);
+        for (size_t i = 0; i < size; i++)
+            assert (weighted[i] == (i + 3) + (i + 1));
+        dsbuffer_free (&buf);
+    }
+
+    // 22. Changing the window keeps the inverse FFT state of filtering
+    size = 32;
+    buf = dsbuffer_new (size, true);
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (buf, sinf (0.5f * t));
+    float pass[17], filtered[32];
+    for (size_t k = 0; k < size/2+1; k++)
+        pass[k] = 1;
+    dsbuffer_fft_filter (buf, pass, filtered);
+    dsbuffer_setup_window (buf, WINDOW_HANN, 0);
+    dsbuffer_setup_window (buf, WINDOW_RECTANGULAR, 0);
+    dsbuffer_fft_filter (buf, pass, filtered);
+    for (size_t i = 0; i < size; i++)
+        assert (fabsf (filtered[i] - dsbuffer_at (buf, i)) < 1e-5f);
+    dsbuffer_free (&buf);
+
+
     printf ("OK\n");
 }
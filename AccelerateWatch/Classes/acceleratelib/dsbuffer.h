@@ -15,24 +15,89 @@ extern "C" {
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "window.h"
+#include "peakdetect.h"
+
 typedef struct _dsbuffer_t dsbuffer_t;
+typedef struct _dsbuffer_snapshot_t dsbuffer_snapshot_t;
 
 typedef struct {
     float real;
     float imag;
 } dsbuffer_complex;
 
+#define DSBUFFER_MAX_BANDS 8
+#define DSBUFFER_MAX_PEAKS 8
+
+// Spectral features computed by dsbuffer_fft_features.
+// Power of bin is one-sided, i.e. abs(X)^2 doubled except DC and Nyquist,
+// and is not corrected for window gain.
+typedef struct {
+    float total_power;
+    float band_power[DSBUFFER_MAX_BANDS]; // power in [edge[b], edge[b+1])
+    float centroid;   // power-weighted mean frequency
+    float spread;     // power-weighted std of frequency
+    float flatness;   // geometric mean / arithmetic mean of power, in [0, 1]
+    float entropy;    // Shannon entropy of normalized power, divided by log(num_bins)
+    float rolloff;    // frequency below which rolloff_ratio of power lies
+    size_t num_peaks; // number of peaks found (<= requested)
+    float peak_freq[DSBUFFER_MAX_PEAKS]; // local maxima, strongest first
+    float peak_power[DSBUFFER_MAX_PEAKS];
+} dsbuffer_spectral_features;
+
+// Time-domain features computed by dsbuffer_features, selected by mask
+typedef enum {
+    DSBUFFER_FEATURE_MEAN               = 1 << 0,
+    DSBUFFER_FEATURE_VARIANCE           = 1 << 1, // also std
+    DSBUFFER_FEATURE_MAX                = 1 << 2,
+    DSBUFFER_FEATURE_MIN                = 1 << 3,
+    DSBUFFER_FEATURE_ENERGY             = 1 << 4, // also rms
+    DSBUFFER_FEATURE_SKEWNESS           = 1 << 5,
+    DSBUFFER_FEATURE_KURTOSIS           = 1 << 6,
+    DSBUFFER_FEATURE_ZERO_CROSSING_RATE = 1 << 7,
+    DSBUFFER_FEATURE_MEAN_CROSSING_RATE = 1 << 8,
+    DSBUFFER_FEATURE_ALL                = (1 << 9) - 1
+} dsbuffer_feature;
+
+typedef struct {
+    float mean;
+    float variance; // with N-1, as dsbuffer_variance
+    float std;
+    float max;
+    float min;
+    float energy;   // sum of squares, as dsbuffer_energy
+    float rms;
+    float skewness; // m3 / m2^1.5 of central moments m_k
+    float kurtosis; // excess kurtosis m4 / m2^2 - 3, i.e. 0 for normal distribution
+    float zero_crossing_rate; // sign changes per sample step
+    float mean_crossing_rate; // crossings of the mean per sample step
+} dsbuffer_time_features;
+
 // Create a new dsbuffer object
 // Set perform_fft to true if FFT will be performed on the buffer, otherwise
 // set it to false so as to save memory.
 dsbuffer_t *dsbuffer_new (size_t size, bool perform_fft);
 
+// Create a new dsbuffer object for FFT whose window is kept contiguous by mapping
+// the same memory twice back-to-back (Linux only), so that each push is a
+// single store and only size values, rounded up to whole pages, are held in
+// memory (e.g. 15360 for 15000 floats with 4 KB pages). If the mapping fails,
+// or on other systems, it is the same as dsbuffer_new (size, true); check with
+// dsbuffer_is_double_mapped.
+dsbuffer_t *dsbuffer_new_double_mapped (size_t size);
+
+// Check if buffer data is double mapped
+bool dsbuffer_is_double_mapped (dsbuffer_t *self);
+
 // Destroy dsbuffer object
 void dsbuffer_free (dsbuffer_t **self_p);
 
 // Destroy dsbuffer object
 void dsbuffer_free_unsafe (dsbuffer_t *self);
 
+// Get buffer size
+size_t dsbuffer_size (dsbuffer_t *self);
+
 // Get data at index
 float dsbuffer_at (dsbuffer_t *self, size_t idx);
     
@@ -42,24 +107,171 @@ void dsbuffer_push (dsbuffer_t *self, float new_value);
 // Dump buffer as array
 void dsbuffer_dump (dsbuffer_t *self, float *output);
 
+// Get buffer data in time order without copying, as the span of the
+// returned number of points at param first, followed by the rest (if any)
+// at param second (NULL if data is contiguous). Valid until next push.
+size_t dsbuffer_view (dsbuffer_t *self, const float **first, const float **second);
+
 // Reset buffer to zero values
 void dsbuffer_clear (dsbuffer_t *self);
 
 // Print buffer
 void dsbuffer_print (dsbuffer_t *self);
+
+// Accumulate sums (mean, variance, energy, dot product, FIR filter, ...) in
+// double instead of float, e.g. for long windows. Data is still stored as
+// float. Disabled by default.
+void dsbuffer_setup_double_accumulation (dsbuffer_t *self, bool enable);
     
 // Self test
 void dsbuffer_test (void);
 
+// ---------------------------------------------------------------------------
+// Freeze current buffer data without copying it, e.g. when a trigger fires.
+// Call it from the thread which pushes data. The snapshot shares storage with
+// the live buffer: a push first saves the chunk it is about to overwrite into
+// the snapshot, and dsbuffer_snapshot_buffer copies the rest, so the bulk of
+// the copy happens on the thread which analyzes the snapshot.
+dsbuffer_snapshot_t *dsbuffer_snapshot (dsbuffer_t *self);
+
+// Get frozen buffer of snapshot, which can be used with all dsbuffer
+// functions (read, stats, FFT, ...) from any one thread while ingest
+// continues. Window, zoom FFT and FIR filter are not inherited; set them up
+// on the frozen buffer if needed. It is owned by the snapshot.
+dsbuffer_t *dsbuffer_snapshot_buffer (dsbuffer_snapshot_t *snapshot);
+
+// Destroy snapshot and its frozen buffer.
+// Snapshots stay valid after their live buffer is freed, but the live buffer
+// must not be freed while another thread is using one of its snapshots.
+void dsbuffer_snapshot_free (dsbuffer_snapshot_t **snapshot_p);
+
 // ---------------------------------------------------------------------------
 // Perform FFT on data buffer (real value time series)
+// Data is multiplied by the window (if setup) into a scratch array first.
 // Return results in param output (size/2+1 complex points)
 void dsbuffer_fftr (dsbuffer_t *self, dsbuffer_complex *output);
 
+// Perform inverse FFT, scaled so that it undoes dsbuffer_fftr (without window).
+// Param input has size/2+1 complex points, output has size points.
+// The inverse plan is created on first call.
+void dsbuffer_ifftr (dsbuffer_t *self, const dsbuffer_complex *input, float *output);
+
+// Frequency-domain filtering: transform buffer data, multiply the spectrum by
+// mask (size/2+1 real gains), and transform back. Filtering is circular over
+// the buffer and the window setup is not applied.
+// Return results in param output which size is the same as the buffer.
+void dsbuffer_fft_filter (dsbuffer_t *self, const float *mask, float *output);
+
+// Same as dsbuffer_fft_filter with complex mask (size/2+1 points), e.g. the
+// frequency response of a filter.
+void dsbuffer_fft_filter_complex (dsbuffer_t *self, const dsbuffer_complex *mask, float *output);
+
+// Setup window function applied to buffer data before FFT.
+// Coefficients are computed once here. param is beta for Kaiser window, and
+// is ignored by the others. WINDOW_RECTANGULAR removes the window.
+void dsbuffer_setup_window (dsbuffer_t *self, window_type type, float param);
+
+// Coherent gain of current window, i.e. mean(w). 1 if no window.
+float dsbuffer_window_coherent_gain (dsbuffer_t *self);
+
+// Power gain of current window, i.e. mean(w^2). 1 if no window.
+float dsbuffer_window_power_gain (dsbuffer_t *self);
+
 // Get FFT frequencies
 // Return results in param output (size/2+1 points)
 void dsbuffer_fft_freq (dsbuffer_t *self, float fs, float *output);
 
+// Compute spectral features of FFT output (num_bins = size/2+1 points) in
+// one pass without allocation.
+// band_edges are num_bands+1 ascending frequencies (num_bands may be 0 and
+// band_edges NULL). Up to num_peaks strongest peaks are reported; peaks are
+// local maxima strictly between the DC and Nyquist bins.
+void dsbuffer_fft_features (const dsbuffer_complex *fft_data,
+                            size_t num_bins,
+                            float fs,
+                            const float *band_edges,
+                            size_t num_bands,
+                            float rolloff_ratio,
+                            size_t num_peaks,
+                            dsbuffer_spectral_features *features);
+
+// Setup zoom FFT (chirp-z transform) which evaluates num_bins frequencies
+// evenly spaced over [f_start, f_stop] (inclusive), with sampling rate fs.
+// Resolution is independent of buffer size, so a narrow band can be
+// inspected densely. Buffer must be created with perform_fft set to true.
+void dsbuffer_setup_zoom_fft (dsbuffer_t *self, float fs, float f_start, float f_stop, size_t num_bins);
+
+// Perform zoom FFT on data buffer
+// Return results in param output (num_bins complex points)
+void dsbuffer_zoom_fft (dsbuffer_t *self, dsbuffer_complex *output);
+
+// Get zoom FFT frequencies
+// Return results in param output (num_bins points)
+void dsbuffer_zoom_fft_freq (dsbuffer_t *self, float *output);
+
+// ---------------------------------------------------------------------------
+// Analytic signal of buffer data by Hilbert transform (via FFT).
+// Return amplitude envelope and unwrapped instantaneous phase (radians) in
+// params envelope and phase (size points each, either may be NULL).
+// Plans and scratch are created on first call and reused. Works on any
+// buffer.
+void dsbuffer_analytic_signal (dsbuffer_t *self, float *envelope, float *phase);
+
+// ---------------------------------------------------------------------------
+// Autocorrelation of buffer data for lags 0 ... max_lag, by FFT in
+// O(N log N). Set remove_mean to true to centralize first. Set unbiased to
+// true to divide lag k by (N-k) instead of N.
+// Plans and scratch are created on first call (or when max_lag changes) and
+// reused. Works on any buffer.
+// Return results in param output (max_lag+1 points).
+void dsbuffer_autocorrelation (dsbuffer_t *self, size_t max_lag, bool remove_mean, bool unbiased, float *output);
+
+// Find the first dominant peak of autocorrelation acf (num_lags points),
+// e.g. the period of a periodic signal. The initial lobe around lag 0 is
+// skipped, then the first local maximum reaching threshold (e.g. 0.8) times
+// the highest local maximum is picked, refined by parabolic interpolation.
+// Return the lag (0 if no peak), and its value in param peak_value if not NULL.
+float dsbuffer_autocorrelation_peak (const float *acf, size_t num_lags, float threshold, float *peak_value);
+
+// ---------------------------------------------------------------------------
+// Setup order statistics (quantiles, median) of the latest window_size values
+// (at most size, e.g. size for the whole buffer, or a few for a median
+// filter). They are updated by each push in O(log window_size) and read in
+// O(log window_size), instead of sorting a dumped copy.
+void dsbuffer_setup_order_statistics (dsbuffer_t *self, size_t window_size);
+
+// k-th smallest of the latest window_size values (k = 0 is the minimum)
+float dsbuffer_order_statistic (dsbuffer_t *self, size_t k);
+
+// Quantile q in [0, 1] of the latest window_size values, linearly
+// interpolated between order statistics (e.g. 0.1 and 0.9 for robust range)
+float dsbuffer_quantile (dsbuffer_t *self, float q);
+
+// Get latest median filter output, i.e. median of the latest window_size values
+float dsbuffer_latest_median_output (dsbuffer_t *self);
+
+// ---------------------------------------------------------------------------
+// Setup streaming peak (e.g. step or tap) detection on pushed values, instead
+// of scanning the dumped window every frame. Each push is looked at once in
+// O(1). See peakdetect_new for the parameters. Values already in the buffer
+// are not scanned.
+void dsbuffer_setup_peak_detector (dsbuffer_t *self,
+                                   float min_height,
+                                   float min_prominence,
+                                   size_t min_distance,
+                                   float threshold_k,
+                                   size_t threshold_window,
+                                   size_t max_peaks);
+
+// Total number of peaks detected since setup or clear. A change since last
+// call means new peaks.
+size_t dsbuffer_peak_count (dsbuffer_t *self);
+
+// Get recent peaks, latest first, in param output of at most max_peaks.
+// Peak at age a is at index size-1-a of buffer while a < size.
+// Return number of peaks written.
+size_t dsbuffer_recent_peaks (dsbuffer_t *self, peakdetect_peak_t *output, size_t max_peaks);
+
 // ---------------------------------------------------------------------------
 // Setup FIR filter
 void dsbuffer_setup_fir (dsbuffer_t *self, const float *fir_taps, size_t num_taps);
@@ -71,6 +283,15 @@ float dsbuffer_latest_fir_output (dsbuffer_t *self);
 // Return results in param output which size is the same as the buffer.
 void dsbuffer_fir_filter (dsbuffer_t *self, float *output);
 
+// ---------------------------------------------------------------------------
+// Compute the time-domain features selected by mask (dsbuffer_feature flags
+// or'ed together) in one pass over buffer data, instead of one pass per
+// feature. Moments are merged block by block in double, so skewness and
+// kurtosis stay accurate with a large offset. Mean crossing rate needs the
+// mean first and takes a second pass only when requested.
+// Fields not selected are set to 0.
+void dsbuffer_features (dsbuffer_t *self, unsigned mask, dsbuffer_time_features *features);
+
 // ---------------------------------------------------------------------------
 // Get mean value of buffer data
 float dsbuffer_mean (dsbuffer_t *self);
@@ -103,6 +324,14 @@ void dsbuffer_add (dsbuffer_t *self, float value, float *output);
 // Multiply dsbuffer data with value.
 // Return results in param output.
 void dsbuffer_multiply (dsbuffer_t *self, float value, float *output);
+
+// Add vector of size points element-wise to dsbuffer data (in time order).
+// Return results in param output.
+void dsbuffer_add_vector (dsbuffer_t *self, const float *vector, float *output);
+
+// Multiply dsbuffer data element-wise with vector of size points, e.g. a
+// window. Return results in param output.
+void dsbuffer_multiply_vector (dsbuffer_t *self, const float *vector, float *output);
     
 // modulus by value on dsbuffer data.
 // Return results in param output.
@@ -0,0 +1,177 @@
+/*  =========================================================================
+    dsbuffer_fixed - fixed-point (int16 and int32) circular buffers
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "dsbuffer_fixed.h"
+#include "kissfft/kiss_fftr_fixed.h"
+
+
+// Both variants are generated from dsbuffer_fixed.inc
+
+#define DSBX_T              dsbuffer16_t
+#define DSBX_STRUCT         _dsbuffer16_t
+#define DSBX(name)          dsbuffer16_##name
+#define DSBX_SAMPLE         int16_t
+#define DSBX_SAMPLE_MIN     INT16_MIN
+#define DSBX_SAMPLE_MAX     INT16_MAX
+#define DSBX_ACC            int32_t
+#define DSBX_ACC2           int64_t
+#define DSBX_MAX_SIZE       65536
+#define DSBX_COMPLEX        dsbuffer16_complex
+#define DSBX_FFTR_CFG       kiss_fftr_q15_cfg
+#define DSBX_FFTR_CPX       kiss_fft_q15_cpx
+#define DSBX_FFTR_ALLOC     kiss_fftr_q15_alloc
+#define DSBX_FFTR           kiss_fftr_q15
+#define DSBX_FFTR_FREE      kiss_fftr_q15_free
+#include "dsbuffer_fixed.inc"
+#undef DSBX_T
+#undef DSBX_STRUCT
+#undef DSBX
+#undef DSBX_SAMPLE
+#undef DSBX_SAMPLE_MIN
+#undef DSBX_SAMPLE_MAX
+#undef DSBX_ACC
+#undef DSBX_ACC2
+#undef DSBX_MAX_SIZE
+#undef DSBX_COMPLEX
+#undef DSBX_FFTR_CFG
+#undef DSBX_FFTR_CPX
+#undef DSBX_FFTR_ALLOC
+#undef DSBX_FFTR
+#undef DSBX_FFTR_FREE
+
+#define DSBX_T              dsbuffer32_t
+#define DSBX_STRUCT         _dsbuffer32_t
+#define DSBX(name)          dsbuffer32_##name
+#define DSBX_SAMPLE         int32_t
+#define DSBX_SAMPLE_MIN     INT32_MIN
+#define DSBX_SAMPLE_MAX     INT32_MAX
+#define DSBX_ACC            int64_t
+#define DSBX_ACC2           double
+#define DSBX_MAX_SIZE       SIZE_MAX
+#define DSBX_COMPLEX        dsbuffer32_complex
+#define DSBX_FFTR_CFG       kiss_fftr_q31_cfg
+#define DSBX_FFTR_CPX       kiss_fft_q31_cpx
+#define DSBX_FFTR_ALLOC     kiss_fftr_q31_alloc
+#define DSBX_FFTR           kiss_fftr_q31
+#define DSBX_FFTR_FREE      kiss_fftr_q31_free
+#include "dsbuffer_fixed.inc"
+
+
+// ---------------------------------------------------------------------------
+void dsbuffer_fixed_test () {
+    printf ("\n[dsbuffer_fixed] Test...\n");
+
+    // 1. Push, dump and stats against exact integer results
+    size_t size = 10;
+    dsbuffer16_t *buf16 = dsbuffer16_new (size, true);
+    assert (buf16);
+    dsbuffer32_t *buf32 = dsbuffer32_new (size, false);
+    assert (buf32);
+    for (int t = 0; t < 13; t++) {
+        dsbuffer16_push (buf16, (int16_t) (t * 1000 - 6000));
+        dsbuffer32_push (buf32, t * 100000 - 600000);
+    }
+    // window holds t = 3 ... 12
+    int16_t dump16[10];
+    int32_t dump32[10];
+    dsbuffer16_dump (buf16, dump16);
+    dsbuffer32_dump (buf32, dump32);
+    for (size_t i = 0; i < size; i++) {
+        assert (dump16[i] == (int16_t) ((i + 3) * 1000 - 6000));
+        assert (dsbuffer16_at (buf16, i) == dump16[i]);
+        assert (dump32[i] == (int32_t) ((i + 3) * 100000 - 600000));
+        assert (dsbuffer32_at (buf32, i) == dump32[i]);
+    }
+    assert (dsbuffer16_sum (buf16) == 15000);
+    assert (dsbuffer32_sum (buf32) == 1500000);
+    assert (dsbuffer16_max (buf16) == 6000 && dsbuffer16_min (buf16) == -3000);
+    assert (dsbuffer32_max (buf32) == 600000 && dsbuffer32_min (buf32) == -300000);
+    assert (fabsf (dsbuffer16_mean (buf16) - 1500) < 1e-3);
+    assert (dsbuffer16_energy (buf16) == 105000000); // 1e6 * sum(k^2), k=-3..6
+    // variance of 10 consecutive integers is 55/6
+    assert (fabs (dsbuffer16_variance (buf16) - 55.0 / 6 * 1e6) < 1);
+    assert (fabs (dsbuffer32_variance (buf32) - 55.0 / 6 * 1e10) < 1e4);
+
+    // 2. FIR: moving average of 2 taps (0.5 in Q15), rounded
+    int16_t taps16[2] = {16384, 16384};
+    dsbuffer16_setup_fir (buf16, taps16, 2, 15);
+    assert (dsbuffer16_latest_fir_output (buf16) == 5500);
+    int16_t fir16[10];
+    dsbuffer16_fir_filter (buf16, fir16);
+    assert (fir16[0] == -1500); // first point sees a single tap
+    for (size_t i = 1; i < size; i++)
+        assert (fir16[i] == (int16_t) ((i + 3) * 1000 - 6500));
+
+    // saturation instead of wrap around
+    int16_t gain16[1] = {4};
+    dsbuffer16_setup_fir (buf16, gain16, 1, 0);
+    assert (dsbuffer16_latest_fir_output (buf16) == 24000);
+    dsbuffer16_push (buf16, 10000);
+    assert (dsbuffer16_latest_fir_output (buf16) == INT16_MAX);
+
+    int32_t taps32[2] = {1 << 30, 1 << 30};
+    dsbuffer32_setup_fir (buf32, taps32, 2, 31);
+    assert (dsbuffer32_latest_fir_output (buf32) == 550000);
+
+    dsbuffer16_clear (buf16);
+    assert (dsbuffer16_sum (buf16) == 0 && dsbuffer16_max (buf16) == 0);
+    dsbuffer16_free (&buf16);
+    dsbuffer32_free (&buf32);
+    assert (buf16 == NULL && buf32 == NULL);
+
+    // 3. FFT of a tone, compared to float DFT scaled by 1/size
+    size = 64;
+    buf16 = dsbuffer16_new (size, true);
+    buf32 = dsbuffer32_new (size, true);
+    assert (buf16 && buf32);
+    for (size_t t = 0; t < size + 5; t++) {
+        double v = 0.5 * cos (2 * M_PI * 5 * t / size) + 0.25;
+        dsbuffer16_push (buf16, (int16_t) lrint (v * 32767));
+        dsbuffer32_push (buf32, (int32_t) lrint (v * 2147483647.0));
+    }
+    dsbuffer16_complex fft16[33];
+    dsbuffer32_complex fft32[33];
+    dsbuffer16_fftr (buf16, fft16);
+    dsbuffer32_fftr (buf32, fft32);
+    for (size_t k = 0; k <= size / 2; k++) {
+        // window starts at t = 5, so the tone has phase 2*pi*5*5/64
+        double re = 0, im = 0;
+        if (k == 0)
+            re = 0.25;
+        else if (k == 5) {
+            re = 0.25 * cos (2 * M_PI * 25 / size);
+            im = 0.25 * sin (2 * M_PI * 25 / size);
+        }
+        assert (fabs (fft16[k].real / 32767.0 - re) < 2e-3);
+        assert (fabs (fft16[k].imag / 32767.0 - im) < 2e-3);
+        assert (fabs (fft32[k].real / 2147483647.0 - re) < 1e-6);
+        assert (fabs (fft32[k].imag / 2147483647.0 - im) < 1e-6);
+    }
+    dsbuffer16_free (&buf16);
+    dsbuffer32_free (&buf32);
+
+    // variance of large samples close to each other
+    buf32 = dsbuffer32_new (10, false);
+    assert (buf32);
+    for (int t = 0; t < 10; t++)
+        dsbuffer32_push (buf32, 2000000000 + t);
+    assert (fabs (dsbuffer32_variance (buf32) - 55.0 / 6) < 1e-4);
+    dsbuffer32_push (buf32, -2000000000);
+    assert (fabs (dsbuffer32_variance (buf32) / 1.600000004e18 - 1) < 1e-6);
+    dsbuffer32_free (&buf32);
+
+    // 4. Invalid sizes
+    assert (dsbuffer16_new (65537, false) == NULL);
+    assert (dsbuffer32_new (7, true) == NULL);
+
+    printf ("OK\n");
+}
@@ -0,0 +1,170 @@
+/*  =========================================================================
+    dsbuffer_fixed - fixed-point (int16 and int32) circular buffers
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __DSBUFFER_FIXED_H__
+#define __DSBUFFER_FIXED_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fixed-point variants of dsbuffer for raw (quantized) sensor samples.
+// dsbuffer16 stores int16 samples and dsbuffer32 int32 samples, i.e. 1/2 and
+// the same memory as float. FFT uses the Q15/Q31 builds of kiss_fft.
+
+typedef struct _dsbuffer16_t dsbuffer16_t;
+typedef struct _dsbuffer32_t dsbuffer32_t;
+
+typedef struct {
+    int16_t real;
+    int16_t imag;
+} dsbuffer16_complex;
+
+typedef struct {
+    int32_t real;
+    int32_t imag;
+} dsbuffer32_complex;
+
+// ---------------------------------------------------------------------------
+// int16 buffer
+
+// Create a new dsbuffer16 object
+// Set perform_fft to true if FFT will be performed on the buffer.
+// Size is limited to 65536 so that sums fit in 32 bits.
+dsbuffer16_t *dsbuffer16_new (size_t size, bool perform_fft);
+
+// Destroy dsbuffer16 object
+void dsbuffer16_free (dsbuffer16_t **self_p);
+
+// Destroy dsbuffer16 object
+void dsbuffer16_free_unsafe (dsbuffer16_t *self);
+
+// Get data at index
+int16_t dsbuffer16_at (dsbuffer16_t *self, size_t idx);
+
+// Add new value to buffer
+void dsbuffer16_push (dsbuffer16_t *self, int16_t new_value);
+
+// Dump buffer as array
+void dsbuffer16_dump (dsbuffer16_t *self, int16_t *output);
+
+// Reset buffer to zero values
+void dsbuffer16_clear (dsbuffer16_t *self);
+
+// Perform Q15 fixed-point FFT on data buffer, scaled by 1/size.
+// Return results in param output (size/2+1 complex points)
+void dsbuffer16_fftr (dsbuffer16_t *self, dsbuffer16_complex *output);
+
+// Setup FIR filter with taps in fixed point of frac_bits fractional bits
+// (e.g. 15 for Q15). Products are accumulated in 32 bits, then rounded,
+// shifted back and saturated.
+// The accumulator cannot overflow while sum(abs(taps)) stays below 2.0.
+void dsbuffer16_setup_fir (dsbuffer16_t *self, const int16_t *fir_taps, size_t num_taps, int frac_bits);
+
+// Get latest FIR filtered output
+int16_t dsbuffer16_latest_fir_output (dsbuffer16_t *self);
+
+// Perform FIR filtering for the whole time series in buffer.
+// Return results in param output which size is the same as the buffer.
+void dsbuffer16_fir_filter (dsbuffer16_t *self, int16_t *output);
+
+// Summation of buffer data
+int32_t dsbuffer16_sum (dsbuffer16_t *self);
+
+// Squared length of buffer data as vector
+int64_t dsbuffer16_energy (dsbuffer16_t *self);
+
+// Max value
+int16_t dsbuffer16_max (dsbuffer16_t *self);
+
+// Min value
+int16_t dsbuffer16_min (dsbuffer16_t *self);
+
+// Mean value, from exact integer sums
+float dsbuffer16_mean (dsbuffer16_t *self);
+
+// Variance, from exact integer sums
+float dsbuffer16_variance (dsbuffer16_t *self);
+
+// Standard deviation
+float dsbuffer16_std (dsbuffer16_t *self);
+
+// ---------------------------------------------------------------------------
+// int32 buffer
+
+// Create a new dsbuffer32 object
+// Set perform_fft to true if FFT will be performed on the buffer.
+dsbuffer32_t *dsbuffer32_new (size_t size, bool perform_fft);
+
+// Destroy dsbuffer32 object
+void dsbuffer32_free (dsbuffer32_t **self_p);
+
+// Destroy dsbuffer32 object
+void dsbuffer32_free_unsafe (dsbuffer32_t *self);
+
+// Get data at index
+int32_t dsbuffer32_at (dsbuffer32_t *self, size_t idx);
+
+// Add new value to buffer
+void dsbuffer32_push (dsbuffer32_t *self, int32_t new_value);
+
+// Dump buffer as array
+void dsbuffer32_dump (dsbuffer32_t *self, int32_t *output);
+
+// Reset buffer to zero values
+void dsbuffer32_clear (dsbuffer32_t *self);
+
+// Perform Q31 fixed-point FFT on data buffer, scaled by 1/size.
+// Return results in param output (size/2+1 complex points)
+void dsbuffer32_fftr (dsbuffer32_t *self, dsbuffer32_complex *output);
+
+// Setup FIR filter with taps in fixed point of frac_bits fractional bits
+// (e.g. 31 for Q31). Products are accumulated in 64 bits, then rounded,
+// shifted back and saturated.
+void dsbuffer32_setup_fir (dsbuffer32_t *self, const int32_t *fir_taps, size_t num_taps, int frac_bits);
+
+// Get latest FIR filtered output
+int32_t dsbuffer32_latest_fir_output (dsbuffer32_t *self);
+
+// Perform FIR filtering for the whole time series in buffer.
+// Return results in param output which size is the same as the buffer.
+void dsbuffer32_fir_filter (dsbuffer32_t *self, int32_t *output);
+
+// Summation of buffer data
+int64_t dsbuffer32_sum (dsbuffer32_t *self);
+
+// Squared length of buffer data as vector
+double dsbuffer32_energy (dsbuffer32_t *self);
+
+// Max value
+int32_t dsbuffer32_max (dsbuffer32_t *self);
+
+// Min value
+int32_t dsbuffer32_min (dsbuffer32_t *self);
+
+// Mean value
+float dsbuffer32_mean (dsbuffer32_t *self);
+
+// Variance
+float dsbuffer32_variance (dsbuffer32_t *self);
+
+// Standard deviation
+float dsbuffer32_std (dsbuffer32_t *self);
+
+// ---------------------------------------------------------------------------
+// Self test of both variants
+void dsbuffer_fixed_test (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
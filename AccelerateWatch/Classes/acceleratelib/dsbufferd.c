@@ -0,0 +1,155 @@
+/*  =========================================================================
+    dsbufferd - double precision fixed-length circular buffer
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "dsbufferd.h"
+#include "dsbuffer.h"
+#include "vectord.h"
+#include "kissfft/kiss_fftr_double.h"
+
+
+struct _dsbufferd_t {
+    double *data;
+    size_t size;
+    size_t ring_size; // values in ring: size, or whole pages if double mapped
+    size_t head; // position of first value
+    void (*pusher)(dsbufferd_t *f, double new_value); // func for pushing value
+
+    // for FFT
+    bool fft_supported;
+    bool double_mapped; // data is the same pages mapped twice, see _new_double_mapped
+    kiss_fftr_d_cfg fft_cfg; // fft configuration
+
+    // for FIR filter
+    const double *fir_taps;
+    size_t num_fir_taps;
+    double (*fir_getter)(dsbufferd_t *buf); // func of getting filtered signal
+
+    // accumulating loops
+    const struct dsbufferd_kernels *kernels;
+};
+
+
+#define DSB_T                   dsbufferd_t
+#define DSB(name)               dsbufferd_##name
+#define DSB_SAMPLE              double
+#define DSB_SQRT                sqrt
+#define DSB_FMOD                fmod
+#define DSB_VECTOR(name)        vectord_##name
+#define DSB_COMPLEX             dsbufferd_complex
+#define DSB_KERNELS_TAG         dsbufferd_kernels
+#define DSB_FFTR_CPX            kiss_fft_d_cpx
+#define DSB_FFTR_ALLOC          kiss_fftr_d_alloc
+#define DSB_FFTR                kiss_fftr_d
+#define DSB_FFTR_FREE           kiss_fftr_d_free
+#define DSB_FFT_INPUT(self)     (&(self)->data[(self)->head])
+#include "dsbuffer_generic.inc"
+
+
+// ---------------------------------------------------------------------------
+void dsbufferd_test () {
+    printf ("\n[dsbufferd] Test...\n");
+
+    // 1. Same results as float buffer on simple data
+    for (int pass = 0; pass < 2; pass++) {
+        bool fft_supported = (pass == 1);
+        size_t size = 6;
+        dsbufferd_t *bufd = dsbufferd_new (size, fft_supported);
+        dsbuffer_t *buf = dsbuffer_new (size, fft_supported);
+        assert (bufd && buf);
+        for (int t = 0; t < 9; t++) {
+            dsbufferd_push (bufd, t * 0.5 - 1);
+            dsbuffer_push (buf, t * 0.5f - 1);
+        }
+        double dumped[6];
+        dsbufferd_dump (bufd, dumped);
+        for (size_t i = 0; i < size; i++) {
+            assert (dumped[i] == (i + 3) * 0.5 - 1);
+            assert (dsbufferd_at (bufd, i) == dumped[i]);
+        }
+        assert (fabs (dsbufferd_sum (bufd) - dsbuffer_sum (buf)) < 1e-6);
+        assert (fabs (dsbufferd_mean (bufd) - 1.75) < 1e-12);
+        assert (fabs (dsbufferd_variance (bufd) - dsbuffer_variance (buf)) < 1e-6);
+        assert (fabs (dsbufferd_energy (bufd) - dsbuffer_energy (buf)) < 1e-5);
+        assert (dsbufferd_max (bufd) == 3.0 && dsbufferd_min (bufd) == 0.5);
+
+        double taps[3] = {0.5, 0.25, 0.25};
+        float tapsf[3] = {0.5f, 0.25f, 0.25f};
+        double fir[6];
+        float firf[6];
+        dsbufferd_setup_fir (bufd, taps, 3);
+        dsbuffer_setup_fir (buf, tapsf, 3);
+        assert (fabs (dsbufferd_latest_fir_output (bufd) - dsbuffer_latest_fir_output (buf)) < 1e-6);
+        dsbufferd_fir_filter (bufd, fir);
+        dsbuffer_fir_filter (buf, firf);
+        for (size_t i = 0; i < size; i++)
+            assert (fabs (fir[i] - firf[i]) < 1e-6);
+
+        dsbufferd_normalize_to_unit_length (bufd, true, dumped);
+        double ss = 0;
+        for (size_t i = 0; i < size; i++)
+            ss += dumped[i] * dumped[i];
+        assert (fabs (ss - 1) < 1e-12);
+
+        dsbufferd_clear (bufd);
+        assert (dsbufferd_energy (bufd) == 0);
+        dsbufferd_free (&bufd);
+        dsbuffer_free (&buf);
+        assert (bufd == NULL);
+    }
+
+    // 2. Double FFT of a tone against DFT
+    size_t size = 48; // mixed radix
+    dsbufferd_t *bufd = dsbufferd_new (size, true);
+    assert (bufd);
+    for (size_t t = 0; t < size; t++)
+        dsbufferd_push (bufd, cos (2 * M_PI * 3 * t / size) + 0.125);
+    dsbufferd_complex spectrum[25];
+    dsbufferd_fftr (bufd, spectrum);
+    for (size_t k = 0; k <= size / 2; k++) {
+        double re = (k == 0) ? 0.125 * size : ((k == 3) ? 0.5 * size : 0);
+        assert (fabs (spectrum[k].real - re) < 1e-10);
+        assert (fabs (spectrum[k].imag) < 1e-10);
+    }
+    double freq[25];
+    dsbufferd_fft_freq (bufd, 48, freq);
+    assert (fabs (freq[24] - 24) < 1e-12);
+    dsbufferd_free (&bufd);
+
+    // 3. Long window (60 s at 100 Hz) of small motion on gravity offset:
+    // float accumulation drifts, double accumulation of float data does not
+    size = 6000;
+    bufd = dsbufferd_new (size, false);
+    dsbuffer_t *buf = dsbuffer_new (size, false);
+    assert (bufd && buf);
+    for (size_t t = 0; t < size; t++) {
+        float v = 9.81f + 0.01f * sinf (0.37f * t);
+        dsbufferd_push (bufd, v);
+        dsbuffer_push (buf, v);
+    }
+    double mean = dsbufferd_mean (bufd);
+    double variance = dsbufferd_variance (bufd);
+    double mean_error_f = fabs (dsbuffer_mean (buf) - mean);
+    dsbuffer_setup_double_accumulation (buf, true);
+    double mean_error_d = fabs (dsbuffer_mean (buf) - mean);
+    double variance_error_d = fabs (dsbuffer_variance (buf) - variance);
+    assert (mean_error_d <= 1e-6 * mean);
+    assert (mean_error_d < mean_error_f);
+    assert (variance_error_d < 1e-4 * variance);
+    dsbuffer_setup_double_accumulation (buf, false);
+    assert (fabs (dsbuffer_mean (buf) - mean) == mean_error_f);
+    dsbufferd_free (&bufd);
+    dsbuffer_free (&buf);
+
+    printf ("OK\n");
+}
@@ -0,0 +1,168 @@
+/*  =========================================================================
+    dsbufferd - double precision fixed-length circular buffer
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __DSBUFFERD_H__
+#define __DSBUFFERD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Double precision version of dsbuffer, generated from the same source
+// (dsbuffer_generic.inc). FFT uses the double build of kiss_fft.
+// Use dsbuffer_setup_double_accumulation instead if only the sums need
+// double precision.
+
+typedef struct _dsbufferd_t dsbufferd_t;
+
+typedef struct {
+    double real;
+    double imag;
+} dsbufferd_complex;
+
+// Create a new dsbufferd object
+// Set perform_fft to true if FFT will be performed on the buffer, otherwise
+// set it to false so as to save memory.
+dsbufferd_t *dsbufferd_new (size_t size, bool perform_fft);
+
+// Create a new dsbufferd object for FFT whose window is kept contiguous by mapping
+// the same memory twice back-to-back (Linux only), so that each push is a
+// single store and only size values, rounded up to whole pages, are held in
+// memory (e.g. 15360 for 15000 floats with 4 KB pages). If the mapping fails,
+// or on other systems, it is the same as dsbufferd_new (size, true); check with
+// dsbufferd_is_double_mapped.
+dsbufferd_t *dsbufferd_new_double_mapped (size_t size);
+
+// Check if buffer data is double mapped
+bool dsbufferd_is_double_mapped (dsbufferd_t *self);
+
+// Destroy dsbufferd object
+void dsbufferd_free (dsbufferd_t **self_p);
+
+// Destroy dsbufferd object
+void dsbufferd_free_unsafe (dsbufferd_t *self);
+
+// Get buffer size
+size_t dsbufferd_size (dsbufferd_t *self);
+
+// Get data at index
+double dsbufferd_at (dsbufferd_t *self, size_t idx);
+
+// Add new value to buffer
+void dsbufferd_push (dsbufferd_t *self, double new_value);
+
+// Dump buffer as array
+void dsbufferd_dump (dsbufferd_t *self, double *output);
+
+// Get buffer data in time order without copying, as the span of the
+// returned number of points at param first, followed by the rest (if any)
+// at param second (NULL if data is contiguous). Valid until next push.
+size_t dsbufferd_view (dsbufferd_t *self, const double **first, const double **second);
+
+// Reset buffer to zero values
+void dsbufferd_clear (dsbufferd_t *self);
+
+// Print buffer
+void dsbufferd_print (dsbufferd_t *self);
+
+// Self test
+void dsbufferd_test (void);
+
+// ---------------------------------------------------------------------------
+// Perform FFT on data buffer (real value time series)
+// Return results in param output (size/2+1 complex points)
+void dsbufferd_fftr (dsbufferd_t *self, dsbufferd_complex *output);
+
+// Get FFT frequencies
+// Return results in param output (size/2+1 points)
+void dsbufferd_fft_freq (dsbufferd_t *self, double fs, double *output);
+
+// ---------------------------------------------------------------------------
+// Setup FIR filter
+void dsbufferd_setup_fir (dsbufferd_t *self, const double *fir_taps, size_t num_taps);
+
+// Get latest FIR filtered output
+double dsbufferd_latest_fir_output (dsbufferd_t *self);
+
+// Perform FIR filtering for the whole time series in buffer.
+// Return results in param output which size is the same as the buffer.
+void dsbufferd_fir_filter (dsbufferd_t *self, double *output);
+
+// ---------------------------------------------------------------------------
+// Get mean value of buffer data
+double dsbufferd_mean (dsbufferd_t *self);
+
+// Get summation of buffer data
+double dsbufferd_sum (dsbufferd_t *self);
+
+// Length of buffer data as vector
+double dsbufferd_length (dsbufferd_t *self);
+
+// Squared length of buffer data as vector
+double dsbufferd_energy (dsbufferd_t *self);
+
+// Max value
+double dsbufferd_max (dsbufferd_t *self);
+
+// Min value
+double dsbufferd_min (dsbufferd_t *self);
+
+// Variance
+double dsbufferd_variance (dsbufferd_t *self);
+
+// Standard deviation
+double dsbufferd_std (dsbufferd_t *self);
+
+// Add value to dsbufferd data.
+// Return results in param output.
+void dsbufferd_add (dsbufferd_t *self, double value, double *output);
+
+// Multiply dsbufferd data with value.
+// Return results in param output.
+void dsbufferd_multiply (dsbufferd_t *self, double value, double *output);
+
+// Add vector of size points element-wise to dsbufferd data (in time order).
+// Return results in param output.
+void dsbufferd_add_vector (dsbufferd_t *self, const double *vector, double *output);
+
+// Multiply dsbufferd data element-wise with vector of size points, e.g. a
+// window. Return results in param output.
+void dsbufferd_multiply_vector (dsbufferd_t *self, const double *vector, double *output);
+
+// modulus by value on dsbufferd data.
+// Return results in param output.
+void dsbufferd_mod (dsbufferd_t *self, double value, double *output);
+
+// Square root of each dsbufferd data.
+// Return results in param output.
+void dsbufferd_sqrt (dsbufferd_t *self, double *output);
+
+// Centralize buffer data as vector
+void dsbufferd_remove_mean (dsbufferd_t *self, double *output);
+
+// Normalize buffer data as vector to have unit length.
+// Return results in param output which size is the same as the buffer.
+// Set remove_mean to true to centralize.
+void dsbufferd_normalize_to_unit_length (dsbufferd_t *self, bool remove_mean, double *output);
+
+// Normalize buffer data as vector to have unit variance.
+// Return results in param output which size is the same as the buffer.
+// Set remove_mean to true to centralize.
+void dsbufferd_normalize_to_unit_variance (dsbufferd_t *self, bool remove_mean, double *output);
+
+// Dot product with vector which size is same with buffer
+double dsbufferd_dot_product (dsbufferd_t *self, const double *vector);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
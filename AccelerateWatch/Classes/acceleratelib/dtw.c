@@ -0,0 +1,527 @@
+/*  =========================================================================
+    dtw - dynamic time warping nearest template search
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "dtw.h"
+
+
+typedef struct {
+    float *values; // length points, normalized if required
+    float *upper;  // envelope: max of values within band
+    float *lower;  // envelope: min of values within band
+} dtw_template_t;
+
+struct _dtw_t {
+    size_t length;
+    size_t band;
+    bool normalize;
+
+    dtw_template_t *templates;
+    size_t num_templates;
+    size_t max_templates;
+
+    // scratch, length points unless noted
+    float *query;
+    float *query_upper;
+    float *query_lower;
+    float *lb_query;    // per point LB_Keogh of query against template envelope
+    float *lb_template; // per point LB_Keogh of template against query envelope
+    float *cumulative_lb; // length+1 points, bound of the path from row i on
+    size_t *deque_max; // monotonic deques of envelope
+    size_t *deque_min;
+    float *cost;       // 2*band+1 points
+    float *cost_prev;  // 2*band+1 points
+
+    dtw_stats stats;
+};
+
+
+static float dtw_square (float x) {
+    return x * x;
+}
+
+
+// Upper and lower envelopes of x over [i-band, i+band] by monotonic deques,
+// O(length)
+static void dtw_envelope (dtw_t *self, const float *x, float *upper, float *lower) {
+    size_t n = self->length, r = self->band;
+    size_t *dmax = self->deque_max, *dmin = self->deque_min;
+    size_t max_head = 0, max_tail = 0, min_head = 0, min_tail = 0;
+
+    for (size_t j = 0; j < n + r; j++) {
+        // add x[j] to window
+        if (j < n) {
+            while (max_tail > max_head && x[dmax[max_tail - 1]] <= x[j])
+                max_tail--;
+            dmax[max_tail++] = j;
+            while (min_tail > min_head && x[dmin[min_tail - 1]] >= x[j])
+                min_tail--;
+            dmin[min_tail++] = j;
+        }
+        // window of point i = j - r is complete
+        if (j >= r) {
+            size_t i = j - r;
+            while (dmax[max_head] + r < i)
+                max_head++;
+            while (dmin[min_head] + r < i)
+                min_head++;
+            upper[i] = x[dmax[max_head]];
+            lower[i] = x[dmin[min_head]];
+        }
+    }
+}
+
+
+// z-normalize in place, constant input becomes zeros
+static void dtw_normalize (float *x, size_t n) {
+    double sum = 0, sum_squares = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += x[i];
+        sum_squares += (double) x[i] * x[i];
+    }
+    double mean = sum / n;
+    double var = sum_squares / n - mean * mean;
+    double inv_std = (var > 1e-12 * (sum_squares / n)) ? 1 / sqrt (var) : 0;
+    for (size_t i = 0; i < n; i++)
+        x[i] = (float) ((x[i] - mean) * inv_std);
+}
+
+
+// Squared LB_Keogh of x against envelope, with per point contributions in
+// param contributions. Abandoned (partial sum returned) once >= bound.
+static float dtw_lb_keogh (dtw_t *self,
+                           const float *x,
+                           const float *upper,
+                           const float *lower,
+                           float *contributions,
+                           float bound) {
+    float lb = 0;
+    size_t i = 0;
+    for (; i < self->length && lb < bound; i++) {
+        float d = 0;
+        if (x[i] > upper[i])
+            d = dtw_square (x[i] - upper[i]);
+        else if (x[i] < lower[i])
+            d = dtw_square (x[i] - lower[i]);
+        contributions[i] = d;
+        lb += d;
+    }
+    for (; i < self->length; i++)
+        contributions[i] = 0;
+    return lb;
+}
+
+
+// Squared DTW distance of a and b within band. If cumulative_lb is not NULL,
+// return INFINITY as soon as the distance can not be less than bound, and
+// tell so in param abandoned.
+static float dtw_banded (dtw_t *self,
+                         const float *a,
+                         const float *b,
+                         const float *cumulative_lb,
+                         float bound,
+                         bool *abandoned) {
+    size_t n = self->length, r = self->band;
+    size_t width = 2 * r + 1;
+    float *cost = self->cost, *cost_prev = self->cost_prev;
+    if (abandoned)
+        *abandoned = false;
+    for (size_t k = 0; k < width; k++)
+        cost_prev[k] = INFINITY;
+
+    // cost[k] is cell (i, j) with k = j - i + r
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = 0; k < width; k++)
+            cost[k] = INFINITY;
+        size_t j_begin = (i > r) ? i - r : 0;
+        size_t j_end = (i + r < n - 1) ? i + r : n - 1;
+        float row_min = INFINITY;
+        for (size_t j = j_begin; j <= j_end; j++) {
+            size_t k = j + r - i;
+            float d = dtw_square (a[i] - b[j]);
+            float best;
+            if (i == 0 && j == 0)
+                best = 0;
+            else {
+                best = (k > 0) ? cost[k-1] : INFINITY;            // (i, j-1)
+                if (k + 1 < width && cost_prev[k+1] < best)       // (i-1, j)
+                    best = cost_prev[k+1];
+                if (cost_prev[k] < best)                          // (i-1, j-1)
+                    best = cost_prev[k];
+            }
+            cost[k] = best + d;
+            if (cost[k] < row_min)
+                row_min = cost[k];
+        }
+        // the rest of the path passes rows i+1 ... n-1
+        if (cumulative_lb && row_min + cumulative_lb[i+1] >= bound) {
+            if (abandoned)
+                *abandoned = true;
+            return INFINITY;
+        }
+        float *tmp = cost;
+        cost = cost_prev;
+        cost_prev = tmp;
+    }
+    return cost_prev[r]; // cell (n-1, n-1)
+}
+
+
+static int dtw_search (dtw_t *self, float max_distance, float *distance) {
+    size_t n = self->length;
+    float *q = self->query;
+    memset (&self->stats, 0, sizeof (dtw_stats));
+
+    dtw_envelope (self, q, self->query_upper, self->query_lower);
+
+    float best_so_far = (max_distance < INFINITY) ? max_distance * max_distance : INFINITY;
+    int best = -1;
+    for (size_t j = 0; j < self->num_templates; j++) {
+        dtw_template_t *t = &self->templates[j];
+
+        // LB_Kim: both end points are on every path
+        float lb = dtw_square (q[0] - t->values[0]);
+        if (n > 1)
+            lb += dtw_square (q[n-1] - t->values[n-1]);
+        if (lb >= best_so_far) {
+            self->stats.pruned_by_kim++;
+            continue;
+        }
+
+        float lb_eq = dtw_lb_keogh (self, q, t->upper, t->lower, self->lb_query, best_so_far);
+        if (lb_eq >= best_so_far) {
+            self->stats.pruned_by_keogh++;
+            continue;
+        }
+
+        float lb_ec = dtw_lb_keogh (self, t->values, self->query_upper, self->query_lower,
+                                    self->lb_template, best_so_far);
+        if (lb_ec >= best_so_far) {
+            self->stats.pruned_by_keogh_ec++;
+            continue;
+        }
+
+        // cumulative_lb[m] bounds the path from row m on: the tighter of the
+        // query contributions of rows m ... n-1 and the template contributions
+        // of columns m+r ... n-1 (in row m-1 the path is at most at column
+        // m-1+r, so those columns are all still ahead).
+        size_t r = self->band;
+        float *lb_t = self->lb_template;
+        for (size_t i = n - 1; i > 0; i--)
+            lb_t[i-1] += lb_t[i];  // suffix sums in place
+        float rest_q = 0;
+        self->cumulative_lb[n] = 0;
+        for (size_t i = n; i > 0; i--) {
+            rest_q += self->lb_query[i-1];
+            float rest_t = (i - 1 + r < n) ? lb_t[i - 1 + r] : 0;
+            self->cumulative_lb[i-1] = (rest_q > rest_t) ? rest_q : rest_t;
+        }
+
+        bool abandoned;
+        float d = dtw_banded (self, q, t->values, self->cumulative_lb, best_so_far, &abandoned);
+        if (abandoned) {
+            self->stats.abandoned++;
+            continue;
+        }
+        self->stats.completed++;
+        if (d < best_so_far) {
+            best_so_far = d;
+            best = (int) j;
+        }
+    }
+
+    if (distance)
+        *distance = (best >= 0) ? sqrtf (best_so_far) : INFINITY;
+    return best;
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+dtw_t *dtw_new (size_t length, size_t band, size_t max_templates, bool normalize) {
+    if (length == 0 || max_templates == 0) {
+        printf("ERROR: invalid length or number of templates.\n");
+        return NULL;
+    }
+
+    dtw_t *self = (dtw_t *) malloc (sizeof (dtw_t));
+    assert (self);
+
+    self->length = length;
+    self->band = (band < length) ? band : length - 1;
+    self->normalize = normalize;
+
+    self->templates = (dtw_template_t *) malloc (sizeof (dtw_template_t) * max_templates);
+    assert (self->templates);
+    self->num_templates = 0;
+    self->max_templates = max_templates;
+
+    self->query = (float *) malloc (sizeof (float) * length);
+    self->query_upper = (float *) malloc (sizeof (float) * length);
+    self->query_lower = (float *) malloc (sizeof (float) * length);
+    self->lb_query = (float *) malloc (sizeof (float) * length);
+    self->lb_template = (float *) malloc (sizeof (float) * length);
+    self->cumulative_lb = (float *) malloc (sizeof (float) * (length + 1));
+    self->deque_max = (size_t *) malloc (sizeof (size_t) * length);
+    self->deque_min = (size_t *) malloc (sizeof (size_t) * length);
+    self->cost = (float *) malloc (sizeof (float) * (2 * self->band + 1));
+    self->cost_prev = (float *) malloc (sizeof (float) * (2 * self->band + 1));
+    assert (self->query && self->query_upper && self->query_lower &&
+            self->lb_query && self->lb_template && self->cumulative_lb &&
+            self->deque_max && self->deque_min && self->cost && self->cost_prev);
+
+    memset (&self->stats, 0, sizeof (dtw_stats));
+    return self;
+}
+
+
+int dtw_add_template (dtw_t *self, const float *values) {
+    assert (self);
+    assert (values);
+    if (self->num_templates == self->max_templates) {
+        printf("ERROR: too many templates.\n");
+        return -1;
+    }
+
+    size_t n = self->length;
+    dtw_template_t *t = &self->templates[self->num_templates];
+    t->values = (float *) malloc (sizeof (float) * n);
+    t->upper = (float *) malloc (sizeof (float) * n);
+    t->lower = (float *) malloc (sizeof (float) * n);
+    assert (t->values && t->upper && t->lower);
+
+    memcpy (t->values, values, sizeof (float) * n);
+    if (self->normalize)
+        dtw_normalize (t->values, n);
+    dtw_envelope (self, t->values, t->upper, t->lower);
+
+    return (int) self->num_templates++;
+}
+
+
+size_t dtw_num_templates (dtw_t *self) {
+    assert (self);
+    return self->num_templates;
+}
+
+
+float dtw_distance (dtw_t *self, const float *x, size_t index) {
+    assert (self);
+    assert (x);
+    assert (index < self->num_templates);
+    memcpy (self->query, x, sizeof (float) * self->length);
+    if (self->normalize)
+        dtw_normalize (self->query, self->length);
+    return sqrtf (dtw_banded (self, self->query, self->templates[index].values, NULL, INFINITY, NULL));
+}
+
+
+int dtw_nearest (dtw_t *self, const float *x, float max_distance, float *distance) {
+    assert (self);
+    assert (x);
+    memcpy (self->query, x, sizeof (float) * self->length);
+    if (self->normalize)
+        dtw_normalize (self->query, self->length);
+    return dtw_search (self, max_distance, distance);
+}
+
+
+int dtw_nearest_buffer (dtw_t *self, dsbuffer_t *buf, float max_distance, float *distance) {
+    assert (self);
+    assert (buf);
+    size_t size = dsbuffer_size (buf);
+    assert (size >= self->length);
+    for (size_t i = 0; i < self->length; i++)
+        self->query[i] = dsbuffer_at (buf, size - self->length + i);
+    if (self->normalize)
+        dtw_normalize (self->query, self->length);
+    return dtw_search (self, max_distance, distance);
+}
+
+
+void dtw_get_stats (dtw_t *self, dtw_stats *stats) {
+    assert (self);
+    assert (stats);
+    *stats = self->stats;
+}
+
+
+void dtw_free (dtw_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        dtw_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void dtw_free_unsafe (dtw_t *self) {
+    assert (self);
+    for (size_t j = 0; j < self->num_templates; j++) {
+        free (self->templates[j].values);
+        free (self->templates[j].upper);
+        free (self->templates[j].lower);
+    }
+    free (self->templates);
+    free (self->query);
+    free (self->query_upper);
+    free (self->query_lower);
+    free (self->lb_query);
+    free (self->lb_template);
+    free (self->cumulative_lb);
+    free (self->deque_max);
+    free (self->deque_min);
+    free (self->cost);
+    free (self->cost_prev);
+    free (self);
+}
+
+
+// ---------------------------------------------------------------------------
+// Banded DTW by full cost matrix
+static float dtw_naive (const float *a, const float *b, size_t n, size_t r) {
+    float *c = (float *) malloc (sizeof (float) * n * n);
+    assert (c);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if ((i > j + r) || (j > i + r)) {
+                c[i*n+j] = INFINITY;
+                continue;
+            }
+            float best = (i == 0 && j == 0) ? 0 : INFINITY;
+            if (i > 0 && c[(i-1)*n+j] < best)
+                best = c[(i-1)*n+j];
+            if (j > 0 && c[i*n+j-1] < best)
+                best = c[i*n+j-1];
+            if (i > 0 && j > 0 && c[(i-1)*n+j-1] < best)
+                best = c[(i-1)*n+j-1];
+            c[i*n+j] = best + (a[i] - b[j]) * (a[i] - b[j]);
+        }
+    }
+    float d = sqrtf (c[n*n-1]);
+    free (c);
+    return d;
+}
+
+
+void dtw_test (void) {
+    printf ("\n[dtw] Test...\n");
+
+    size_t length = 100, band = 10, num_templates = 30;
+    dtw_t *dtw = dtw_new (length, band, num_templates, false);
+    assert (dtw);
+
+    // templates: sines of different frequency and phase
+    float *t = (float *) malloc (sizeof (float) * length * num_templates);
+    float *x = (float *) malloc (sizeof (float) * length);
+    assert (t && x);
+    for (size_t j = 0; j < num_templates; j++) {
+        for (size_t i = 0; i < length; i++)
+            t[j*length+i] = sinf ((0.05f + 0.01f * j) * i + 0.3f * j);
+        assert (dtw_add_template (dtw, t + j*length) == (int) j);
+    }
+    assert (dtw_num_templates (dtw) == num_templates);
+
+    // query: template 17 time warped (speed changing) plus noise
+    size_t target = 17;
+    for (size_t i = 0; i < length; i++) {
+        float warped = i + 4 * sinf ((float) M_PI * i / length);
+        x[i] = sinf ((0.05f + 0.01f * target) * warped + 0.3f * target) +
+               0.05f * ((float) (rand () % 201) - 100) / 100;
+    }
+
+    // distances against full matrix
+    float best_naive = INFINITY;
+    size_t best_naive_index = 0;
+    for (size_t j = 0; j < num_templates; j++) {
+        float d = dtw_naive (x, t + j*length, length, band);
+        assert (fabsf (dtw_distance (dtw, x, j) - d) < 1e-4f * (1 + d));
+        if (d < best_naive) {
+            best_naive = d;
+            best_naive_index = j;
+        }
+    }
+    assert (best_naive_index == target);
+
+    // nearest with pruning
+    float distance;
+    assert (dtw_nearest (dtw, x, INFINITY, &distance) == (int) target);
+    assert (fabsf (distance - best_naive) < 1e-4f * (1 + best_naive));
+    dtw_stats stats;
+    dtw_get_stats (dtw, &stats);
+    assert (stats.pruned_by_kim + stats.pruned_by_keogh + stats.pruned_by_keogh_ec +
+            stats.abandoned + stats.completed == num_templates);
+    assert (stats.completed >= 1 && stats.completed < num_templates / 2);
+    assert (stats.abandoned >= 1); // stopped early, not merely no better
+
+    // nothing within max distance
+    assert (dtw_nearest (dtw, x, 0.5f * best_naive, &distance) == -1);
+    assert (distance == INFINITY);
+
+    // from buffer holding more than length values
+    dsbuffer_t *buf = dsbuffer_new (length + 37, false);
+    assert (buf);
+    for (size_t i = 0; i < 200; i++)
+        dsbuffer_push (buf, 5);
+    for (size_t i = 0; i < length; i++)
+        dsbuffer_push (buf, x[i]);
+    float buffer_distance;
+    assert (dtw_nearest_buffer (dtw, buf, INFINITY, &buffer_distance) == (int) target);
+    assert (buffer_distance == distance || fabsf (buffer_distance - best_naive) < 1e-4f * (1 + best_naive));
+    dsbuffer_free (&buf);
+    dtw_free (&dtw);
+    assert (dtw == NULL);
+
+    // normalized: invariant to offset and scale
+    dtw = dtw_new (length, band, 2, true);
+    dtw_add_template (dtw, t);
+    dtw_add_template (dtw, t + target*length);
+    for (size_t i = 0; i < length; i++)
+        x[i] = 50 + 10 * x[i];
+    assert (dtw_nearest (dtw, x, INFINITY, &distance) == 1);
+    dtw_free (&dtw);
+
+    // random walks: pruned search finds the brute force nearest distance
+    srand (7);
+    size_t walk_length = 24;
+    for (size_t walk_band = 1; walk_band <= 6; walk_band += 5) {
+        dtw = dtw_new (walk_length, walk_band, 6, false);
+        for (size_t j = 0; j < 6; j++) {
+            float v = 0;
+            for (size_t i = 0; i < walk_length; i++)
+                x[i] = (v += ((float) (rand () % 201) - 100) / 100);
+            dtw_add_template (dtw, x);
+        }
+        for (size_t run = 0; run < 2000; run++) {
+            float v = 0;
+            for (size_t i = 0; i < walk_length; i++)
+                x[i] = (v += ((float) (rand () % 201) - 100) / 100);
+            float best_brute = INFINITY;
+            for (size_t j = 0; j < 6; j++) {
+                float d = dtw_distance (dtw, x, j);
+                best_brute = (d < best_brute) ? d : best_brute;
+            }
+            int nearest = dtw_nearest (dtw, x, INFINITY, &distance);
+            assert (nearest >= 0);
+            assert (fabsf (distance - best_brute) <= 1e-5f * (1 + best_brute));
+            assert (fabsf (dtw_distance (dtw, x, nearest) - best_brute) <= 1e-5f * (1 + best_brute));
+        }
+        dtw_free (&dtw);
+    }
+
+    free (t);
+    free (x);
+
+    printf ("OK\n");
+}
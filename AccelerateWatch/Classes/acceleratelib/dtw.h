@@ -0,0 +1,80 @@
+/*  =========================================================================
+    dtw - dynamic time warping nearest template search
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __DTW_H__
+#define __DTW_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "dsbuffer.h"
+
+typedef struct _dtw_t dtw_t;
+
+// How templates were handled by the latest dtw_nearest call
+typedef struct {
+    size_t pruned_by_kim;      // first and last points
+    size_t pruned_by_keogh;    // query against template envelope
+    size_t pruned_by_keogh_ec; // template against query envelope
+    size_t abandoned;          // DTW stopped early
+    size_t completed;          // full DTW computed, better or not
+} dtw_stats;
+
+// Create a new dtw object for queries and templates of length points,
+// warping within a Sakoe-Chiba band of band points, and at most
+// max_templates templates. If normalize, queries and templates are
+// z-normalized first.
+// Distance is sqrt of the sum of squared differences along the best path.
+// Two cost rows of 2*band+1 points and all scratch are allocated here, so
+// queries never allocate.
+dtw_t *dtw_new (size_t length, size_t band, size_t max_templates, bool normalize);
+
+// Destroy dtw object
+void dtw_free (dtw_t **self_p);
+
+// Destroy dtw object
+void dtw_free_unsafe (dtw_t *self);
+
+// Add template of length points. Its upper and lower envelopes over the
+// band are computed here, once.
+// Return template index, or -1 on error.
+int dtw_add_template (dtw_t *self, const float *values);
+
+// Number of templates
+size_t dtw_num_templates (dtw_t *self);
+
+// DTW distance of query x (length points) to template, without pruning
+float dtw_distance (dtw_t *self, const float *x, size_t index);
+
+// Nearest template to query x (length points) by DTW distance.
+// Templates are skipped by cascading lower bounds (LB_Kim, LB_Keogh both
+// ways) and DTW is abandoned early once it cannot beat the best so far.
+// Only templates with distance < max_distance (INFINITY for all) are
+// considered. Return index (-1 if none) and its distance in param distance
+// if not NULL.
+int dtw_nearest (dtw_t *self, const float *x, float max_distance, float *distance);
+
+// Same as dtw_nearest on the latest length values of buffer (size >= length).
+// Values are read from the buffer in the normalization pass, no dump.
+int dtw_nearest_buffer (dtw_t *self, dsbuffer_t *buf, float max_distance, float *distance);
+
+// Statistics of the latest dtw_nearest call, in param stats
+void dtw_get_stats (dtw_t *self, dtw_stats *stats);
+
+// Self test
+void dtw_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,9 +16,18 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
    defines kiss_fft_scalar as either short or a float type
    and defines
    typedef struct { kiss_fft_scalar r; kiss_fft_scalar i; }kiss_fft_cpx; */
+#ifndef KISS_FFT_GUTS_H
+#define KISS_FFT_GUTS_H
+
 #include "kiss_fft.h"
 #include <limits.h>
 
+#if !defined(FIXED_POINT) && !defined(USE_SIMD)
+/* sizes with large prime factors are routed through a chirp-z transform */
+# define KISS_FFT_USE_CZT
+# include "kiss_czt.h"
+#endif
+
 #define MAXFACTORS 32
 /* e.g. an fft of length 128 has 4 factors 
  as far as kissfft is concerned
@@ -29,6 +38,11 @@ struct kiss_fft_state{
     int nfft;
     int inverse;
     int factors[2*MAXFACTORS];
+#ifdef KISS_FFT_USE_CZT
+    kiss_czt_cfg czt; /* non-NULL if nfft is done by Bluestein's algorithm */
+#endif
+    kiss_fft_cpx *tmpbuf;  /* nfft points, for "in-place" transforms */
+    kiss_fft_cpx *scratch; /* largest generic radix points, for kf_bfly_generic */
     kiss_fft_cpx twiddles[1];
 };
 
@@ -152,7 +166,8 @@ struct kiss_fft_state{
 
 #ifdef KISS_FFT_USE_ALLOCA
 // define this to allow use of alloca instead of malloc for temporary buffers
-// Temporary buffers are used in two case: 
+// Temporary buffers used to be needed in two cases (both now live in the cfg,
+// and these macros are only used by the OpenMP build of kf_bfly_generic):
 // 1. FFT sizes that have "bad" factors. i.e. not 2,3 and 5
 // 2. "in-place" FFTs.  Notice the quotes, since kissfft does not really do an in-place transform.
 #include <alloca.h>
@@ -162,3 +177,5 @@ struct kiss_fft_state{
 #define  KISS_FFT_TMP_ALLOC(nbytes) KISS_FFT_MALLOC(nbytes)
 #define  KISS_FFT_TMP_FREE(ptr) KISS_FFT_FREE(ptr)
 #endif
+
+#endif
@@ -0,0 +1,194 @@
+/*  =========================================================================
+    kiss_czt - chirp-z transform (Bluestein's algorithm) on top of kiss_fft
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include "kiss_czt.h"
+#include "_kiss_fft_guts.h"
+
+/* keep every sub-block of the contiguous cfg suitably aligned */
+#define CZT_ALIGN(nbytes) (((nbytes) + 15) & ~((size_t) 15))
+
+struct kiss_czt_state {
+    int n;                  /* input length */
+    int m;                  /* output length */
+    int nfft;               /* power-of-two convolution length >= n+m-1 */
+    kiss_fft_cfg fft;       /* forward fft of length nfft */
+    kiss_fft_cpx *pre;      /* n points: A^-i * W^(i^2/2) */
+    kiss_fft_cpx *post;     /* m points: W^(k^2/2) */
+    kiss_fft_cpx *kernel;   /* nfft points: fft(W^(-i^2/2)) / nfft */
+    kiss_fft_cpx *work;     /* nfft points of scratch */
+    kiss_fft_cpx *work2;    /* nfft points of scratch */
+};
+
+/* x = exp(-2*pi*j*turns), with the argument reduced to one cycle first so
+   that large chirp indices keep full precision */
+static void czt_cexp(kiss_fft_cpx *x, double turns)
+{
+    const double pi=3.141592653589793238462643383279502884197169399375105820974944;
+    turns -= floor(turns);
+    kf_cexp(x, -2 * pi * turns);
+}
+
+int kiss_czt_fft_size(int n, int m)
+{
+    int nfft = 1;
+    while (nfft < n + m - 1)
+        nfft <<= 1;
+    return nfft;
+}
+
+/* sum of the radices kiss_fft would use for n (same order as kf_factor) */
+static int czt_radix_sum(int n, int *max_radix)
+{
+    int p = 4, sum = 0;
+    double floor_sqrt = floor(sqrt((double) n));
+
+    *max_radix = 1;
+    while (n > 1) {
+        while (n % p) {
+            switch (p) {
+                case 4: p = 2; break;
+                case 2: p = 3; break;
+                default: p += 2; break;
+            }
+            if (p > floor_sqrt)
+                p = n;
+        }
+        n /= p;
+        sum += p;
+        if (p > *max_radix)
+            *max_radix = p;
+    }
+    return sum;
+}
+
+int kiss_czt_preferred(int n)
+{
+    int max_radix, nfft, dummy;
+    double mixed_cost, czt_cost;
+
+    if (n < 2)
+        return 0;
+    /* every stage of a mixed-radix fft costs about n*p operations */
+    mixed_cost = (double) n * czt_radix_sum(n, &max_radix);
+    if (max_radix <= 5)
+        return 0; /* only hand-written butterflies: nothing to win */
+
+    /* two power-of-two ffts plus the pointwise chirp products */
+    nfft = kiss_czt_fft_size(n, n);
+    czt_cost = 2.0 * nfft * czt_radix_sum(nfft, &dummy) + 4.0 * nfft;
+    return czt_cost < mixed_cost;
+}
+
+kiss_czt_cfg kiss_czt_alloc(int n, int m, double a_turns, double w_turns,
+                            void *mem, size_t *lenmem)
+{
+    kiss_czt_cfg st = NULL;
+    size_t subsize, memneeded;
+    int i, nfft;
+
+    if (n < 1 || m < 1)
+        return NULL;
+
+    nfft = kiss_czt_fft_size(n, m);
+    kiss_fft_alloc(nfft, 0, NULL, &subsize);
+    memneeded = CZT_ALIGN(sizeof(struct kiss_czt_state))
+              + CZT_ALIGN(subsize)
+              + sizeof(kiss_fft_cpx) * (n + m + 3 * (size_t) nfft);
+
+    if (lenmem == NULL) {
+        st = (kiss_czt_cfg) KISS_FFT_MALLOC(memneeded);
+    } else {
+        if (mem != NULL && *lenmem >= memneeded)
+            st = (kiss_czt_cfg) mem;
+        *lenmem = memneeded;
+    }
+    if (!st)
+        return NULL;
+
+    st->n = n;
+    st->m = m;
+    st->nfft = nfft;
+    st->fft = (kiss_fft_cfg) ((char *) st + CZT_ALIGN(sizeof(struct kiss_czt_state)));
+    st->pre = (kiss_fft_cpx *) ((char *) st->fft + CZT_ALIGN(subsize));
+    st->post = st->pre + n;
+    st->kernel = st->post + m;
+    st->work = st->kernel + nfft;
+    st->work2 = st->work + nfft;
+    kiss_fft_alloc(nfft, 0, st->fft, &subsize);
+
+    for (i = 0; i < n; ++i)
+        czt_cexp(st->pre + i,
+                 fmod(a_turns * i, 1.0) + fmod(0.5 * w_turns * i * (double) i, 1.0));
+    for (i = 0; i < m; ++i)
+        czt_cexp(st->post + i, fmod(0.5 * w_turns * i * (double) i, 1.0));
+
+    /* chirp filter W^(-i^2/2) for lags -(n-1) .. m-1, wrapped circularly */
+    memset(st->work, 0, sizeof(kiss_fft_cpx) * nfft);
+    for (i = 0; i < m; ++i)
+        czt_cexp(st->work + i, -fmod(0.5 * w_turns * i * (double) i, 1.0));
+    for (i = 1; i < n; ++i)
+        czt_cexp(st->work + nfft - i, -fmod(0.5 * w_turns * i * (double) i, 1.0));
+    kiss_fft(st->fft, st->work, st->kernel);
+
+    /* fold the 1/nfft of the inverse fft into the kernel */
+    for (i = 0; i < nfft; ++i) {
+        st->kernel[i].r /= nfft;
+        st->kernel[i].i /= nfft;
+    }
+    return st;
+}
+
+/* convolve st->work (premultiplied input, zero padded) with the chirp and
+   write the postmultiplied result */
+static void czt_convolve(kiss_czt_cfg st, kiss_fft_cpx *fout)
+{
+    int i;
+    kiss_fft_cpx t;
+
+    kiss_fft(st->fft, st->work, st->work2);
+
+    /* inverse fft done as conj(fft(conj(.))) to share one plan */
+    for (i = 0; i < st->nfft; ++i) {
+        C_MUL(t, st->work2[i], st->kernel[i]);
+        st->work[i].r = t.r;
+        st->work[i].i = -t.i;
+    }
+    kiss_fft(st->fft, st->work, st->work2);
+
+    for (i = 0; i < st->m; ++i) {
+        t.r = st->work2[i].r;
+        t.i = -st->work2[i].i;
+        C_MUL(fout[i], t, st->post[i]);
+    }
+}
+
+void kiss_czt_stride(kiss_czt_cfg st, const kiss_fft_cpx *fin,
+                     kiss_fft_cpx *fout, int fin_stride)
+{
+    int i;
+    for (i = 0; i < st->n; ++i)
+        C_MUL(st->work[i], fin[i * fin_stride], st->pre[i]);
+    memset(st->work + st->n, 0, sizeof(kiss_fft_cpx) * (st->nfft - st->n));
+    czt_convolve(st, fout);
+}
+
+void kiss_czt(kiss_czt_cfg st, const kiss_fft_cpx *fin, kiss_fft_cpx *fout)
+{
+    kiss_czt_stride(st, fin, fout, 1);
+}
+
+void kiss_czt_real(kiss_czt_cfg st, const kiss_fft_scalar *timedata,
+                   kiss_fft_cpx *fout)
+{
+    int i;
+    for (i = 0; i < st->n; ++i) {
+        st->work[i].r = timedata[i] * st->pre[i].r;
+        st->work[i].i = timedata[i] * st->pre[i].i;
+    }
+    memset(st->work + st->n, 0, sizeof(kiss_fft_cpx) * (st->nfft - st->n));
+    czt_convolve(st, fout);
+}
@@ -0,0 +1,67 @@
+/*  =========================================================================
+    kiss_czt - chirp-z transform (Bluestein's algorithm) on top of kiss_fft
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef KISS_CZT_H
+#define KISS_CZT_H
+
+#include "kiss_fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Chirp-z transform of an n-point sequence x evaluated at m points along a
+ spiral (here: an arc of the unit circle):
+
+     X[k] = sum_{i=0}^{n-1} x[i] * exp(-2*pi*j * (a_turns + k*w_turns) * i)
+
+ where a_turns and w_turns are the start and step of the frequency grid in
+ cycles per sample (e.g. a_turns = f_start/fs, w_turns = df/fs).
+
+ With m == n, a_turns == 0 and w_turns == 1.0/n this is exactly the DFT of
+ length n, computed with power-of-two FFTs of length >= n+m-1 whatever the
+ factorization of n (Bluestein's algorithm). kiss_fft_alloc uses it
+ automatically for sizes with large prime factors.
+ */
+
+typedef struct kiss_czt_state *kiss_czt_cfg;
+
+/*
+ Same memory conventions as kiss_fft_alloc: if lenmem is NULL the cfg is
+ malloc'ed as one contiguous block that can be free()d.
+ */
+kiss_czt_cfg kiss_czt_alloc(int n, int m, double a_turns, double w_turns,
+                            void *mem, size_t *lenmem);
+
+/* Complex input (n points) -> m complex output points. The input is fully
+   consumed before any output is written, so fin may alias fout. */
+void kiss_czt_stride(kiss_czt_cfg cfg, const kiss_fft_cpx *fin,
+                     kiss_fft_cpx *fout, int fin_stride);
+
+void kiss_czt(kiss_czt_cfg cfg, const kiss_fft_cpx *fin, kiss_fft_cpx *fout);
+
+/* Real input (n points) -> m complex output points */
+void kiss_czt_real(kiss_czt_cfg cfg, const kiss_fft_scalar *timedata,
+                   kiss_fft_cpx *fout);
+
+/* Length of the internal power-of-two FFT used for the convolution */
+int kiss_czt_fft_size(int n, int m);
+
+/*
+ Returns non-zero if an n-point DFT is estimated to be cheaper through the
+ chirp-z path than through kiss_fft's mixed-radix butterflies.
+ */
+int kiss_czt_preferred(int n);
+
+#define kiss_czt_free free
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,6 +18,10 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  fixed or floating point complex numbers.  It also delares the kf_ internal functions.
  */
 
+#ifdef KISS_FFT_COUNT_ALLOCS
+size_t kiss_fft_alloc_count = 0;
+#endif
+
 static void kf_bfly2(
         kiss_fft_cpx * Fout,
         const size_t fstride,
@@ -208,7 +212,12 @@ static void kf_bfly_generic(
     kiss_fft_cpx t;
     int Norig = st->nfft;
 
+#ifdef _OPENMP
+    /* sub-transforms run concurrently and cannot share the cfg's scratch */
     kiss_fft_cpx * scratch = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC(sizeof(kiss_fft_cpx)*p);
+#else
+    kiss_fft_cpx * scratch = st->scratch;
+#endif
 
     for ( u=0; u<m; ++u ) {
         k=u;
@@ -231,7 +240,9 @@ static void kf_bfly_generic(
             k += m;
         }
     }
+#ifdef _OPENMP
     KISS_FFT_TMP_FREE(scratch);
+#endif
 }
 
 static
@@ -339,8 +350,28 @@ void kf_factor(int n,int * facbuf)
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem )
 {
     kiss_fft_cfg st=NULL;
-    size_t memneeded = sizeof(struct kiss_fft_state)
-        + sizeof(kiss_fft_cpx)*(nfft-1); /* twiddle factors*/
+    int factors[2*MAXFACTORS];
+    int i, maxradix=0;
+    size_t memneeded;
+
+    kf_factor(nfft,factors);
+    for (i=0; factors[2*i+1] > 1; ++i)
+        if (factors[2*i] > maxradix) maxradix = factors[2*i];
+    if (factors[2*i] > maxradix) maxradix = factors[2*i];
+
+    memneeded = sizeof(struct kiss_fft_state)
+        + sizeof(kiss_fft_cpx)*(nfft-1) /* twiddle factors*/
+        + sizeof(kiss_fft_cpx)*nfft /* tmpbuf */
+        + sizeof(kiss_fft_cpx)*(maxradix > 5 ? maxradix : 0); /* scratch */
+#ifdef KISS_FFT_USE_CZT
+    size_t cztsize = 0;
+    int use_czt = kiss_czt_preferred(nfft);
+    if (use_czt) {
+        /* the chirp-z cfg replaces the twiddles and is placed right after the state */
+        kiss_czt_alloc(nfft, nfft, 0, 1.0/nfft, NULL, &cztsize);
+        memneeded = ((sizeof(struct kiss_fft_state) + 15) & ~(size_t)15) + cztsize;
+    }
+#endif
 
     if ( lenmem==NULL ) {
         st = ( kiss_fft_cfg)KISS_FFT_MALLOC( memneeded );
@@ -350,9 +381,21 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
         *lenmem = memneeded;
     }
     if (st) {
-        int i;
         st->nfft=nfft;
         st->inverse = inverse_fft;
+        st->tmpbuf = NULL;
+        st->scratch = NULL;
+
+#ifdef KISS_FFT_USE_CZT
+        st->czt = NULL;
+        if (use_czt) {
+            /* the inverse transform walks the unit circle the other way */
+            st->czt = kiss_czt_alloc(nfft, nfft, 0, (inverse_fft ? -1.0 : 1.0)/nfft,
+                                     (char *)st + ((sizeof(struct kiss_fft_state) + 15) & ~(size_t)15),
+                                     &cztsize);
+            return st;
+        }
+#endif
 
         for (i=0;i<nfft;++i) {
             const double pi=3.141592653589793238462643383279502884197169399375105820974944;
@@ -362,7 +405,9 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
             kf_cexp(st->twiddles+i, phase );
         }
 
-        kf_factor(nfft,st->factors);
+        memcpy(st->factors,factors,sizeof(factors));
+        st->tmpbuf = st->twiddles + nfft;
+        st->scratch = st->tmpbuf + nfft;
     }
     return st;
 }
@@ -370,13 +415,17 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
 
 void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride)
 {
+#ifdef KISS_FFT_USE_CZT
+    if (st->czt) {
+        kiss_czt_stride(st->czt,fin,fout,in_stride);
+        return;
+    }
+#endif
     if (fin == fout) {
         //NOTE: this is not really an in-place FFT algorithm.
         //It just performs an out-of-place FFT into a temp buffer
-        kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC( sizeof(kiss_fft_cpx)*st->nfft);
-        kf_work(tmpbuf,fin,1,in_stride, st->factors,st);
-        memcpy(fout,tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
-        KISS_FFT_TMP_FREE(tmpbuf);
+        kf_work(st->tmpbuf,fin,1,in_stride, st->factors,st);
+        memcpy(fout,st->tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
     }else{
         kf_work( fout, fin, 1,in_stride, st->factors,st );
     }
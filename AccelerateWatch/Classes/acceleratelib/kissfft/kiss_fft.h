@@ -28,6 +28,11 @@ extern "C" {
 # define kiss_fft_scalar __m128
 #define KISS_FFT_MALLOC(nbytes) _mm_malloc(nbytes,16)
 #define KISS_FFT_FREE _mm_free
+#elif defined(KISS_FFT_COUNT_ALLOCS)
+/* test hook: count every heap allocation made by kiss_fft */
+extern size_t kiss_fft_alloc_count;
+#define KISS_FFT_MALLOC(nbytes) (++kiss_fft_alloc_count, malloc(nbytes))
+#define KISS_FFT_FREE free
 #else	
 #define KISS_FFT_MALLOC malloc
 #define KISS_FFT_FREE free
@@ -89,6 +94,10 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem)
  * fout will be   F[0] , F[1] , ... ,F[nfft-1]
  * Note that each element is complex and can be accessed like
     f[k].r and f[k].i
+ *
+ * All scratch memory (for "bad" radices and for fin == fout) is part of the
+ * cfg, so a transform never allocates. The flip side is that one cfg must
+ * not be used by two threads at the same time.
  * */
 void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout);
 
@@ -0,0 +1,36 @@
+/*  =========================================================================
+    kiss_fft_double - double precision build of kiss_fft, kiss_fftr and kiss_czt
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+/* Public prototypes are in kiss_fftr_double.h. That header is not included
+   here since kiss_fft_cpx of this build stands for kiss_fft_d_cpx. */
+
+#define kiss_fft_scalar double
+
+#define kiss_fft_state          kiss_fft_d_state
+#define kiss_fftr_state         kiss_fftr_d_state
+#define kiss_czt_state          kiss_czt_d_state
+#define kiss_fft_alloc          kiss_fft_d_alloc
+#define kiss_fft                kiss_fft_d
+#define kiss_fft_stride         kiss_fft_d_stride
+#define kiss_fft_cleanup        kiss_fft_d_cleanup
+#define kiss_fft_next_fast_size kiss_fft_d_next_fast_size
+#define kiss_fft_alloc_count    kiss_fft_d_alloc_count
+#define kf_work                 kf_d_work
+#define kf_factor               kf_d_factor
+#define kiss_fftr_alloc         kiss_fftr_d_alloc
+#define kiss_fftr               kiss_fftr_d
+#define kiss_fftri              kiss_fftri_d
+#define kiss_czt_alloc          kiss_czt_d_alloc
+#define kiss_czt_stride         kiss_czt_d_stride
+#define kiss_czt                kiss_czt_d
+#define kiss_czt_real           kiss_czt_d_real
+#define kiss_czt_fft_size       kiss_czt_d_fft_size
+#define kiss_czt_preferred      kiss_czt_d_preferred
+
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
+#include "kiss_czt.c"
@@ -0,0 +1,28 @@
+/*  =========================================================================
+    kiss_fft_q15 - Q15 fixed-point build of kiss_fft and kiss_fftr
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+/* Public prototypes are in kiss_fftr_fixed.h. That header is not included
+   here since kiss_fft_cpx of this build stands for kiss_fft_q15_cpx. */
+
+#define FIXED_POINT 16
+
+#define kiss_fft_state          kiss_fft_q15_state
+#define kiss_fftr_state         kiss_fftr_q15_state
+#define kiss_fft_alloc          kiss_fft_q15_alloc
+#define kiss_fft                kiss_fft_q15
+#define kiss_fft_stride         kiss_fft_q15_stride
+#define kiss_fft_cleanup        kiss_fft_q15_cleanup
+#define kiss_fft_next_fast_size kiss_fft_q15_next_fast_size
+#define kiss_fft_alloc_count    kiss_fft_q15_alloc_count
+#define kf_work                 kf_q15_work
+#define kf_factor               kf_q15_factor
+#define kiss_fftr_alloc         kiss_fftr_q15_alloc
+#define kiss_fftr               kiss_fftr_q15
+#define kiss_fftri              kiss_fftri_q15
+
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
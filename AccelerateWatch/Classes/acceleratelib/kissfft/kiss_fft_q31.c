@@ -0,0 +1,28 @@
+/*  =========================================================================
+    kiss_fft_q31 - Q31 fixed-point build of kiss_fft and kiss_fftr
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+/* Public prototypes are in kiss_fftr_fixed.h. That header is not included
+   here since kiss_fft_cpx of this build stands for kiss_fft_q31_cpx. */
+
+#define FIXED_POINT 32
+
+#define kiss_fft_state          kiss_fft_q31_state
+#define kiss_fftr_state         kiss_fftr_q31_state
+#define kiss_fft_alloc          kiss_fft_q31_alloc
+#define kiss_fft                kiss_fft_q31
+#define kiss_fft_stride         kiss_fft_q31_stride
+#define kiss_fft_cleanup        kiss_fft_q31_cleanup
+#define kiss_fft_next_fast_size kiss_fft_q31_next_fast_size
+#define kiss_fft_alloc_count    kiss_fft_q31_alloc_count
+#define kf_work                 kf_q31_work
+#define kf_factor               kf_q31_factor
+#define kiss_fftr_alloc         kiss_fftr_q31_alloc
+#define kiss_fftr               kiss_fftr_q31
+#define kiss_fftri              kiss_fftri_q31
+
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
@@ -0,0 +1,42 @@
+/*  =========================================================================
+    kiss_fftr_double - double precision real FFT built from the bundled kiss_fft
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef KISS_FFTR_DOUBLE_H
+#define KISS_FFTR_DOUBLE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ kiss_fft.c, kiss_fftr.c and kiss_czt.c compiled once more with
+ kiss_fft_scalar set to double, with every external symbol renamed so that
+ they link next to the float build (see kiss_fft_double.c).
+
+ Same usage as kiss_fftr_alloc/kiss_fftr/kiss_fftri.
+ */
+
+typedef struct {
+    double r;
+    double i;
+} kiss_fft_d_cpx;
+
+typedef struct kiss_fftr_d_state *kiss_fftr_d_cfg;
+
+kiss_fftr_d_cfg kiss_fftr_d_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+void kiss_fftr_d(kiss_fftr_d_cfg cfg, const double *timedata, kiss_fft_d_cpx *freqdata);
+void kiss_fftri_d(kiss_fftr_d_cfg cfg, const kiss_fft_d_cpx *freqdata, double *timedata);
+
+#define kiss_fftr_d_free free
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/*  =========================================================================
+    kiss_fftr_fixed - fixed-point real FFT built from the bundled kiss_fft
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef KISS_FFTR_FIXED_H
+#define KISS_FFTR_FIXED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ kiss_fft.c and kiss_fftr.c compiled once more with FIXED_POINT=16 (q15) and
+ FIXED_POINT=32 (q31), with every external symbol renamed so that they link
+ next to the float build (see kiss_fft_q15.c and kiss_fft_q31.c).
+
+ Same usage as kiss_fftr_alloc/kiss_fftr/kiss_fftri. As in any fixed-point
+ kiss_fft, each stage divides by its radix to avoid overflow, so the forward
+ transform returns X[k]/nfft.
+ */
+
+typedef struct {
+    int16_t r;
+    int16_t i;
+} kiss_fft_q15_cpx;
+
+typedef struct {
+    int32_t r;
+    int32_t i;
+} kiss_fft_q31_cpx;
+
+typedef struct kiss_fftr_q15_state *kiss_fftr_q15_cfg;
+typedef struct kiss_fftr_q31_state *kiss_fftr_q31_cfg;
+
+kiss_fftr_q15_cfg kiss_fftr_q15_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+void kiss_fftr_q15(kiss_fftr_q15_cfg cfg, const int16_t *timedata, kiss_fft_q15_cpx *freqdata);
+void kiss_fftri_q15(kiss_fftr_q15_cfg cfg, const kiss_fft_q15_cpx *freqdata, int16_t *timedata);
+
+kiss_fftr_q31_cfg kiss_fftr_q31_alloc(int nfft, int inverse_fft, void *mem, size_t *lenmem);
+void kiss_fftr_q31(kiss_fftr_q31_cfg cfg, const int32_t *timedata, kiss_fft_q31_cpx *freqdata);
+void kiss_fftri_q31(kiss_fftr_q31_cfg cfg, const kiss_fft_q31_cpx *freqdata, int32_t *timedata);
+
+#define kiss_fftr_q15_free free
+#define kiss_fftr_q31_free free
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
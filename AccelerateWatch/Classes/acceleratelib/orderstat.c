@@ -0,0 +1,297 @@
+/*  =========================================================================
+    orderstat - order statistics (median, quantiles) of a sliding window
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "orderstat.h"
+
+#define ORDERSTAT_NIL (-1)
+
+// One node per window slot; slot of the oldest value is reused by each push.
+// Nodes are ordered by (value, slot) so that equal values are distinct keys.
+struct _orderstat_t {
+    size_t size;
+    size_t oldest; // slot of oldest value
+    int32_t root;
+    float *value;
+    uint32_t *priority; // heap order of treap
+    uint32_t *count; // size of subtree
+    int32_t *left;
+    int32_t *right;
+};
+
+
+static bool orderstat_less (orderstat_t *self, int32_t a, int32_t b) {
+    return self->value[a] < self->value[b] ||
+           (self->value[a] == self->value[b] && a < b);
+}
+
+
+static uint32_t orderstat_count (orderstat_t *self, int32_t t) {
+    return (t == ORDERSTAT_NIL) ? 0 : self->count[t];
+}
+
+
+static void orderstat_update (orderstat_t *self, int32_t t) {
+    self->count[t] = 1 + orderstat_count (self, self->left[t]) +
+                         orderstat_count (self, self->right[t]);
+}
+
+
+// Join two trees where every key of a is less than every key of b
+static int32_t orderstat_merge (orderstat_t *self, int32_t a, int32_t b) {
+    if (a == ORDERSTAT_NIL)
+        return b;
+    if (b == ORDERSTAT_NIL)
+        return a;
+    if (self->priority[a] > self->priority[b]) {
+        self->right[a] = orderstat_merge (self, self->right[a], b);
+        orderstat_update (self, a);
+        return a;
+    }
+    else {
+        self->left[b] = orderstat_merge (self, a, self->left[b]);
+        orderstat_update (self, b);
+        return b;
+    }
+}
+
+
+// Split tree t into keys less than node n (*l) and the others (*r)
+static void orderstat_split (orderstat_t *self, int32_t t, int32_t n,
+                             int32_t *l, int32_t *r) {
+    if (t == ORDERSTAT_NIL) {
+        *l = *r = ORDERSTAT_NIL;
+        return;
+    }
+    if (orderstat_less (self, t, n)) {
+        orderstat_split (self, self->right[t], n, &self->right[t], r);
+        *l = t;
+    }
+    else {
+        orderstat_split (self, self->left[t], n, l, &self->left[t]);
+        *r = t;
+    }
+    orderstat_update (self, t);
+}
+
+
+static int32_t orderstat_insert (orderstat_t *self, int32_t t, int32_t n) {
+    if (t == ORDERSTAT_NIL)
+        return n;
+    if (self->priority[n] > self->priority[t]) {
+        orderstat_split (self, t, n, &self->left[n], &self->right[n]);
+        orderstat_update (self, n);
+        return n;
+    }
+    if (orderstat_less (self, n, t))
+        self->left[t] = orderstat_insert (self, self->left[t], n);
+    else
+        self->right[t] = orderstat_insert (self, self->right[t], n);
+    orderstat_update (self, t);
+    return t;
+}
+
+
+static int32_t orderstat_erase (orderstat_t *self, int32_t t, int32_t n) {
+    assert (t != ORDERSTAT_NIL);
+    if (t == n)
+        return orderstat_merge (self, self->left[t], self->right[t]);
+    if (orderstat_less (self, n, t))
+        self->left[t] = orderstat_erase (self, self->left[t], n);
+    else
+        self->right[t] = orderstat_erase (self, self->right[t], n);
+    orderstat_update (self, t);
+    return t;
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+orderstat_t *orderstat_new (size_t window_size) {
+    if (window_size == 0 || window_size > INT32_MAX) {
+        printf("ERROR: invalid window size.\n");
+        return NULL;
+    }
+
+    orderstat_t *self = (orderstat_t *) malloc (sizeof (orderstat_t));
+    assert (self);
+    self->size = window_size;
+    self->value = (float *) malloc (sizeof (float) * window_size);
+    self->priority = (uint32_t *) malloc (sizeof (uint32_t) * window_size);
+    self->count = (uint32_t *) malloc (sizeof (uint32_t) * window_size);
+    self->left = (int32_t *) malloc (sizeof (int32_t) * window_size);
+    self->right = (int32_t *) malloc (sizeof (int32_t) * window_size);
+    assert (self->value && self->priority && self->count && self->left && self->right);
+
+    // fixed pseudo random priorities (xorshift), so that results and timing
+    // are reproducible
+    uint32_t x = 2463534242u;
+    for (size_t i = 0; i < window_size; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        self->priority[i] = x;
+    }
+
+    orderstat_clear (self);
+    return self;
+}
+
+
+void orderstat_push (orderstat_t *self, float new_value) {
+    assert (self);
+    int32_t n = (int32_t) self->oldest;
+    self->root = orderstat_erase (self, self->root, n);
+    self->value[n] = new_value;
+    self->left[n] = self->right[n] = ORDERSTAT_NIL;
+    self->count[n] = 1;
+    self->root = orderstat_insert (self, self->root, n);
+    if (++self->oldest == self->size)
+        self->oldest = 0;
+}
+
+
+void orderstat_clear (orderstat_t *self) {
+    assert (self);
+    self->root = ORDERSTAT_NIL;
+    for (size_t i = 0; i < self->size; i++) {
+        self->value[i] = 0;
+        self->left[i] = self->right[i] = ORDERSTAT_NIL;
+        self->count[i] = 1;
+        self->root = orderstat_insert (self, self->root, (int32_t) i);
+    }
+    self->oldest = 0;
+}
+
+
+size_t orderstat_size (orderstat_t *self) {
+    assert (self);
+    return self->size;
+}
+
+
+float orderstat_kth (orderstat_t *self, size_t k) {
+    assert (self);
+    assert (k < self->size);
+    int32_t t = self->root;
+    while (true) {
+        uint32_t left_count = orderstat_count (self, self->left[t]);
+        if (k < left_count)
+            t = self->left[t];
+        else if (k == left_count)
+            return self->value[t];
+        else {
+            k -= left_count + 1;
+            t = self->right[t];
+        }
+    }
+}
+
+
+float orderstat_quantile (orderstat_t *self, float q) {
+    assert (self);
+    assert (q >= 0 && q <= 1);
+    float pos = q * (self->size - 1);
+    size_t lo = (size_t) pos;
+    if (lo >= self->size - 1)
+        return orderstat_kth (self, self->size - 1);
+    float frac = pos - lo;
+    float a = orderstat_kth (self, lo);
+    if (frac == 0)
+        return a;
+    return a + frac * (orderstat_kth (self, lo + 1) - a);
+}
+
+
+float orderstat_median (orderstat_t *self) {
+    return orderstat_quantile (self, 0.5f);
+}
+
+
+void orderstat_free (orderstat_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        orderstat_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void orderstat_free_unsafe (orderstat_t *self) {
+    assert (self);
+    free (self->value);
+    free (self->priority);
+    free (self->count);
+    free (self->left);
+    free (self->right);
+    free (self);
+}
+
+
+// ---------------------------------------------------------------------------
+static int orderstat_compare_float (const void *a, const void *b) {
+    float x = *(const float *) a, y = *(const float *) b;
+    return (x > y) - (x < y);
+}
+
+
+void orderstat_test (void) {
+    printf ("\n[orderstat] Test...\n");
+
+    // 1. Against sorting the window, with many duplicates
+    size_t sizes[3] = {1, 7, 100};
+    for (int s = 0; s < 3; s++) {
+        size_t size = sizes[s];
+        orderstat_t *os = orderstat_new (size);
+        assert (os);
+        float *window = (float *) calloc (size, sizeof (float));
+        float *sorted = (float *) malloc (sizeof (float) * size);
+        assert (window && sorted);
+        for (size_t t = 0; t < 20 * size + 50; t++) {
+            float v = (float) (rand () % 23) - 11;
+            orderstat_push (os, v);
+            window[t % size] = v;
+            memcpy (sorted, window, sizeof (float) * size);
+            qsort (sorted, size, sizeof (float), orderstat_compare_float);
+            for (size_t k = 0; k < size; k += 1 + size / 10)
+                assert (orderstat_kth (os, k) == sorted[k]);
+            assert (orderstat_kth (os, size - 1) == sorted[size - 1]);
+            float pos = 0.9f * (size - 1);
+            size_t lo = (size_t) pos;
+            float q90 = (lo + 1 < size) ?
+                        sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]) :
+                        sorted[lo];
+            assert (fabsf (orderstat_quantile (os, 0.9f) - q90) < 1e-4);
+        }
+        orderstat_clear (os);
+        assert (orderstat_median (os) == 0 && orderstat_kth (os, size - 1) == 0);
+        free (window);
+        free (sorted);
+        orderstat_free (&os);
+        assert (os == NULL);
+    }
+
+    // 2. Median of even window interpolates the middle pair
+    orderstat_t *os = orderstat_new (4);
+    orderstat_push (os, 5);
+    orderstat_push (os, -1);
+    orderstat_push (os, 3);
+    orderstat_push (os, 10);
+    assert (orderstat_median (os) == 4);
+    assert (orderstat_quantile (os, 0) == -1 && orderstat_quantile (os, 1) == 10);
+    orderstat_free (&os);
+
+    printf ("OK\n");
+}
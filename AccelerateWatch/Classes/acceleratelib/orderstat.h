@@ -0,0 +1,58 @@
+/*  =========================================================================
+    orderstat - order statistics (median, quantiles) of a sliding window
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __ORDERSTAT_H__
+#define __ORDERSTAT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+typedef struct _orderstat_t orderstat_t;
+
+// Create a new orderstat object over the latest window_size pushed values.
+// The window starts filled with zeros, like dsbuffer.
+// Values are kept in an order statistic tree (treap with subtree sizes), so
+// each push and each query is O(log N). NaN values are not supported.
+orderstat_t *orderstat_new (size_t window_size);
+
+// Destroy orderstat object
+void orderstat_free (orderstat_t **self_p);
+
+// Destroy orderstat object
+void orderstat_free_unsafe (orderstat_t *self);
+
+// Add new value, dropping the oldest one
+void orderstat_push (orderstat_t *self, float new_value);
+
+// Reset window to zero values
+void orderstat_clear (orderstat_t *self);
+
+// Window size
+size_t orderstat_size (orderstat_t *self);
+
+// k-th smallest value in window (k = 0 is the minimum)
+float orderstat_kth (orderstat_t *self, size_t k);
+
+// Quantile q in [0, 1] of window, linearly interpolated between order
+// statistics (i.e. position q*(N-1), same as numpy's default)
+float orderstat_quantile (orderstat_t *self, float q);
+
+// Median of window
+float orderstat_median (orderstat_t *self);
+
+// Self test
+void orderstat_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
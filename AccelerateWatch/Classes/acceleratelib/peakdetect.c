@@ -0,0 +1,280 @@
+/*  =========================================================================
+    peakdetect - streaming peak (e.g. step and tap) detector
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "peakdetect.h"
+
+typedef struct {
+    uint64_t index;
+    float height;
+    float prominence;
+} peakdetect_stored_t;
+
+struct _peakdetect_t {
+    float min_height;
+    float min_prominence;
+    size_t min_distance;
+    float threshold_k;
+    size_t threshold_window;
+
+    uint64_t num_samples;
+
+    // running statistics for adaptive threshold
+    double alpha;
+    double mean;
+    double var;
+
+    // hysteresis state: either rising towards a peak, or falling to a valley
+    bool rising;
+    float valley; // minimum before candidate (or since last peak if falling)
+    float candidate; // maximum since valley
+    uint64_t candidate_index;
+    float candidate_threshold; // adaptive threshold when candidate arrived
+
+    // ring of recent peaks
+    peakdetect_stored_t *peaks;
+    size_t max_peaks;
+    size_t count;
+    bool has_last; // last kept peak for refractory period
+    uint64_t last_index;
+};
+
+
+peakdetect_t *peakdetect_new (float min_height,
+                              float min_prominence,
+                              size_t min_distance,
+                              float threshold_k,
+                              size_t threshold_window,
+                              size_t max_peaks) {
+    if (min_prominence < 0 || max_peaks == 0) {
+        printf("ERROR: invalid prominence or number of peaks.\n");
+        return NULL;
+    }
+    if (threshold_k > 0 && threshold_window == 0) {
+        printf("ERROR: invalid threshold window.\n");
+        return NULL;
+    }
+
+    peakdetect_t *self = (peakdetect_t *) malloc (sizeof (peakdetect_t));
+    assert (self);
+    self->min_height = min_height;
+    self->min_prominence = min_prominence;
+    self->min_distance = min_distance;
+    self->threshold_k = threshold_k;
+    self->threshold_window = threshold_window;
+    self->alpha = (threshold_window > 0) ? 1.0 / threshold_window : 1.0;
+    self->max_peaks = max_peaks;
+    self->peaks = (peakdetect_stored_t *) malloc (sizeof (peakdetect_stored_t) * max_peaks);
+    assert (self->peaks);
+
+    peakdetect_clear (self);
+    return self;
+}
+
+
+static float peakdetect_current_threshold (peakdetect_t *self) {
+    if (self->threshold_k <= 0 || self->num_samples < self->threshold_window)
+        return -INFINITY;
+    return (float) (self->mean + self->threshold_k * sqrt (self->var));
+}
+
+
+static bool peakdetect_confirm (peakdetect_t *self, float right_base) {
+    float height = self->candidate;
+    if (height < self->min_height || height < self->candidate_threshold)
+        return false;
+    if (self->has_last && self->candidate_index - self->last_index < self->min_distance)
+        return false;
+
+    peakdetect_stored_t *peak = &self->peaks[self->count % self->max_peaks];
+    peak->index = self->candidate_index;
+    peak->height = height;
+    peak->prominence = height - ((self->valley > right_base) ? self->valley : right_base);
+    self->count++;
+    self->has_last = true;
+    self->last_index = self->candidate_index;
+    return true;
+}
+
+
+bool peakdetect_push (peakdetect_t *self, float new_value) {
+    assert (self);
+    bool found = false;
+
+    if (self->num_samples == 0) {
+        self->valley = new_value;
+        self->rising = false;
+    }
+    else if (self->rising) {
+        if (new_value > self->candidate) {
+            self->candidate = new_value;
+            self->candidate_index = self->num_samples;
+            self->candidate_threshold = peakdetect_current_threshold (self);
+        }
+        else if (new_value < self->candidate - self->min_prominence) {
+            found = peakdetect_confirm (self, new_value);
+            self->rising = false;
+            self->valley = new_value;
+        }
+    }
+    else {
+        if (new_value < self->valley)
+            self->valley = new_value;
+        else if (new_value > self->valley + self->min_prominence) {
+            self->rising = true;
+            self->candidate = new_value;
+            self->candidate_index = self->num_samples;
+            self->candidate_threshold = peakdetect_current_threshold (self);
+        }
+    }
+
+    // exponentially weighted mean and variance
+    if (self->threshold_k > 0) {
+        if (self->num_samples == 0) {
+            self->mean = new_value;
+            self->var = 0;
+        }
+        else {
+            double d = new_value - self->mean;
+            self->mean += self->alpha * d;
+            self->var = (1 - self->alpha) * (self->var + self->alpha * d * d);
+        }
+    }
+
+    self->num_samples++;
+    return found;
+}
+
+
+void peakdetect_clear (peakdetect_t *self) {
+    assert (self);
+    self->num_samples = 0;
+    self->mean = 0;
+    self->var = 0;
+    self->rising = false;
+    self->valley = 0;
+    self->candidate = 0;
+    self->candidate_index = 0;
+    self->candidate_threshold = -INFINITY;
+    self->count = 0;
+    self->has_last = false;
+    self->last_index = 0;
+}
+
+
+size_t peakdetect_count (peakdetect_t *self) {
+    assert (self);
+    return self->count;
+}
+
+
+size_t peakdetect_num_recent (peakdetect_t *self) {
+    assert (self);
+    return (self->count < self->max_peaks) ? self->count : self->max_peaks;
+}
+
+
+void peakdetect_recent (peakdetect_t *self, size_t i, peakdetect_peak_t *peak) {
+    assert (self);
+    assert (peak);
+    assert (i < peakdetect_num_recent (self));
+    const peakdetect_stored_t *stored = &self->peaks[(self->count - 1 - i) % self->max_peaks];
+    peak->age = (size_t) (self->num_samples - 1 - stored->index);
+    peak->height = stored->height;
+    peak->prominence = stored->prominence;
+}
+
+
+float peakdetect_threshold (peakdetect_t *self) {
+    assert (self);
+    return peakdetect_current_threshold (self);
+}
+
+
+void peakdetect_free (peakdetect_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        peakdetect_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void peakdetect_free_unsafe (peakdetect_t *self) {
+    assert (self);
+    free (self->peaks);
+    free (self);
+}
+
+
+// ---------------------------------------------------------------------------
+void peakdetect_test (void) {
+    printf ("\n[peakdetect] Test...\n");
+
+    // 1. Periodic pulses with noise: one peak per pulse, at the pulse top
+    peakdetect_t *pd = peakdetect_new (-INFINITY, 0.5f, 10, 0, 0, 4);
+    assert (pd);
+    size_t period = 25;
+    size_t found = 0;
+    for (size_t t = 0; t < 10 * period; t++) {
+        size_t phase = t % period;
+        float noise = 0.05f * ((float) (rand () % 201) - 100) / 100;
+        float v = (phase < 8) ? sinf ((float) M_PI * phase / 8) : 0;
+        if (peakdetect_push (pd, v + noise)) {
+            found++;
+            peakdetect_peak_t peak;
+            peakdetect_recent (pd, 0, &peak);
+            size_t peak_t = t - peak.age;
+            assert (peak_t % period >= 3 && peak_t % period <= 5);
+            assert (peak.height > 0.9f && peak.prominence >= 0.5f);
+        }
+    }
+    assert (found == 10);
+    assert (peakdetect_count (pd) == 10 && peakdetect_num_recent (pd) == 4);
+    peakdetect_peak_t p0, p1;
+    peakdetect_recent (pd, 0, &p0);
+    peakdetect_recent (pd, 1, &p1);
+    assert (p1.age - p0.age == period);
+    peakdetect_free (&pd);
+    assert (pd == NULL);
+
+    // 2. Height and refractory distance
+    float x[] = {0, 3, 0, 1, 0, 4, 0, 5, 0, 0, 0, 6, 0};
+    pd = peakdetect_new (2, 0.5f, 3, 0, 0, 8);
+    for (size_t t = 0; t < sizeof (x) / sizeof (float); t++)
+        peakdetect_push (pd, x[t]);
+    // 3 (t=1) kept, 1 too low, 4 (t=5) kept, 5 (t=7) within 3 of t=5, 6 kept
+    assert (peakdetect_count (pd) == 3);
+    peakdetect_recent (pd, 0, &p0);
+    assert (p0.height == 6 && p0.age == 1 && p0.prominence == 6);
+    peakdetect_recent (pd, 2, &p0);
+    assert (p0.height == 3);
+    peakdetect_clear (pd);
+    assert (peakdetect_count (pd) == 0);
+    peakdetect_free (&pd);
+
+    // 3. Adaptive threshold ignores ripple, keeps spikes
+    pd = peakdetect_new (-INFINITY, 0, 0, 3, 50, 8);
+    found = 0;
+    for (size_t t = 0; t < 500; t++) {
+        float v = 0.1f * sinf (0.7f * t) + ((t % 100 == 60) ? 2.0f : 0);
+        if (peakdetect_push (pd, v) && t >= 50)
+            found++;
+    }
+    assert (found == 5); // ripple peaks only before threshold is in effect
+    assert (peakdetect_threshold (pd) > 0.1f && peakdetect_threshold (pd) < 1);
+    peakdetect_free (&pd);
+
+    printf ("OK\n");
+}
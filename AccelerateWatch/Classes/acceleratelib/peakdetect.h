@@ -0,0 +1,79 @@
+/*  =========================================================================
+    peakdetect - streaming peak (e.g. step and tap) detector
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __PEAKDETECT_H__
+#define __PEAKDETECT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct _peakdetect_t peakdetect_t;
+
+typedef struct {
+    size_t age; // samples pushed after the peak sample (0 is the latest sample)
+    float height;
+    float prominence; // drop on both sides seen when the peak was confirmed
+} peakdetect_peak_t;
+
+// Create a new peak detector.
+// Each sample is looked at once: the detector tracks the maximum since the
+// last valley, and confirms it as a peak as soon as the signal has fallen
+// min_prominence below it (after rising at least min_prominence above the
+// valley before). So a peak is reported with a delay until that drop.
+// A confirmed peak is kept if
+// - height >= min_height (-INFINITY to disable),
+// - height >= running mean + threshold_k * running std (threshold_k <= 0 to
+//   disable), with exponentially weighted mean and std over about
+//   threshold_window samples, in effect after threshold_window samples,
+// - it is at least min_distance samples after the previous kept peak
+//   (refractory period; earlier peak wins).
+// The latest max_peaks kept peaks are stored.
+peakdetect_t *peakdetect_new (float min_height,
+                              float min_prominence,
+                              size_t min_distance,
+                              float threshold_k,
+                              size_t threshold_window,
+                              size_t max_peaks);
+
+// Destroy peak detector
+void peakdetect_free (peakdetect_t **self_p);
+
+// Destroy peak detector
+void peakdetect_free_unsafe (peakdetect_t *self);
+
+// Feed new sample. Return true if a peak is confirmed by it. O(1).
+bool peakdetect_push (peakdetect_t *self, float new_value);
+
+// Forget all samples and peaks
+void peakdetect_clear (peakdetect_t *self);
+
+// Total number of peaks kept since creation or clear
+size_t peakdetect_count (peakdetect_t *self);
+
+// Number of stored recent peaks, min(count, max_peaks)
+size_t peakdetect_num_recent (peakdetect_t *self);
+
+// Get i-th recent peak (i = 0 is the latest) in param peak
+void peakdetect_recent (peakdetect_t *self, size_t i, peakdetect_peak_t *peak);
+
+// Current adaptive threshold, mean + threshold_k * std (-INFINITY if not in
+// effect)
+float peakdetect_threshold (peakdetect_t *self);
+
+// Self test
+void peakdetect_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,232 @@
+/*  =========================================================================
+    stft - streaming short-time Fourier transform (spectrogram)
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <assert.h>
+
+#include "stft.h"
+#include "dsbuffer.h"
+#include "vectorf.h"
+
+
+struct _stft_t {
+    dsbuffer_t *buffer; // latest fft_size samples
+    size_t fft_size;
+    size_t hop_size;
+    size_t num_bins;
+    stft_scale scale;
+    size_t countdown; // samples to push before next frame
+
+    dsbuffer_complex *spectrum; // FFT output of current frame
+    float *frame; // scaled values of current frame
+
+    // Ring of frames, bin-major: each bin has a row of 2*capacity values in
+    // which every frame is written twice (at slot and slot+capacity), so that
+    // any latest frames of a bin are contiguous.
+    float *frames;
+    size_t capacity;
+    size_t head; // slot for next frame
+    size_t num_frames; // frames available
+};
+
+
+// Compute one frame from buffer and write it into the ring
+static void stft_compute_frame (stft_t *self) {
+    dsbuffer_fftr (self->buffer, self->spectrum);
+
+    for (size_t k = 0; k < self->num_bins; k++) {
+        float re = self->spectrum[k].real, im = self->spectrum[k].imag;
+        self->frame[k] = re * re + im * im;
+    }
+
+    if (self->scale == STFT_MAGNITUDE) {
+        for (size_t k = 0; k < self->num_bins; k++)
+            self->frame[k] = sqrtf (self->frame[k]);
+    }
+    else if (self->scale == STFT_LOG_MAGNITUDE) {
+        // log(abs(X)) = 0.5 * log(abs(X)^2), avoiding sqrt
+        for (size_t k = 0; k < self->num_bins; k++)
+            if (self->frame[k] < FLT_MIN)
+                self->frame[k] = FLT_MIN;
+        vectorf_log_fast (self->frame, self->num_bins, self->frame);
+        vectorf_multiply_inplace (self->frame, self->num_bins, 0.5f);
+    }
+
+    float *row = self->frames + self->head;
+    for (size_t k = 0; k < self->num_bins; k++) {
+        row[0] = self->frame[k];
+        row[self->capacity] = self->frame[k];
+        row += 2 * self->capacity;
+    }
+
+    if (++self->head == self->capacity)
+        self->head = 0;
+    if (self->num_frames < self->capacity)
+        self->num_frames++;
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+stft_t *stft_new (size_t fft_size,
+                  size_t hop_size,
+                  window_type window,
+                  float window_param,
+                  size_t num_frames,
+                  stft_scale scale) {
+    if (fft_size % 2 == 1) {
+        printf ("ERROR: FFT size must be even.\n");
+        return NULL;
+    }
+    assert (hop_size > 0);
+    assert (num_frames > 0);
+
+    stft_t *self = (stft_t *) malloc (sizeof (stft_t));
+    assert (self);
+
+    self->buffer = dsbuffer_new (fft_size, true);
+    assert (self->buffer);
+    dsbuffer_setup_window (self->buffer, window, window_param);
+
+    self->fft_size = fft_size;
+    self->hop_size = hop_size;
+    self->num_bins = fft_size / 2 + 1;
+    self->scale = scale;
+
+    self->spectrum =
+        (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * self->num_bins);
+    assert (self->spectrum);
+    self->frame = (float *) malloc (sizeof (float) * self->num_bins);
+    assert (self->frame);
+
+    self->capacity = num_frames;
+    self->frames =
+        (float *) calloc (2 * num_frames * self->num_bins, sizeof (float));
+    assert (self->frames);
+
+    self->countdown = fft_size;
+    self->head = 0;
+    self->num_frames = 0;
+
+    return self;
+}
+
+
+bool stft_push (stft_t *self, float new_value) {
+    assert (self);
+    dsbuffer_push (self->buffer, new_value);
+    if (--self->countdown > 0)
+        return false;
+    self->countdown = self->hop_size;
+    stft_compute_frame (self);
+    return true;
+}
+
+
+size_t stft_num_bins (stft_t *self) {
+    assert (self);
+    return self->num_bins;
+}
+
+
+size_t stft_num_frames (stft_t *self) {
+    assert (self);
+    return self->num_frames;
+}
+
+
+const float *stft_latest_frames (stft_t *self, size_t num_frames, size_t *stride) {
+    assert (self);
+    assert (num_frames <= self->capacity);
+    if (stride)
+        *stride = 2 * self->capacity;
+    return self->frames + self->head + self->capacity - num_frames;
+}
+
+
+float stft_at (stft_t *self, size_t frame, size_t bin) {
+    assert (self);
+    assert (frame < self->num_frames);
+    assert (bin < self->num_bins);
+    return self->frames[bin * 2 * self->capacity +
+                        self->head + self->capacity - 1 - frame];
+}
+
+
+void stft_clear (stft_t *self) {
+    assert (self);
+    dsbuffer_clear (self->buffer);
+    memset (self->frames, 0,
+            sizeof (float) * 2 * self->capacity * self->num_bins);
+    self->countdown = self->fft_size;
+    self->head = 0;
+    self->num_frames = 0;
+}
+
+
+void stft_free (stft_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        stft_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void stft_free_unsafe (stft_t *self) {
+    assert (self);
+    dsbuffer_free (&self->buffer);
+    free (self->spectrum);
+    free (self->frame);
+    free (self->frames);
+    free (self);
+}
+
+
+void stft_test (void) {
+    size_t fft_size = 64, hop_size = 16, num_frames = 8;
+    stft_t *stft = stft_new (fft_size, hop_size, WINDOW_HANN, 0,
+                             num_frames, STFT_MAGNITUDE);
+    stft_t *stft_log = stft_new (fft_size, hop_size, WINDOW_HANN, 0,
+                                 num_frames, STFT_LOG_MAGNITUDE);
+    assert (stft && stft_log);
+    assert (stft_num_bins (stft) == fft_size / 2 + 1);
+
+    // tone at bin 8
+    size_t produced = 0;
+    for (size_t t = 0; t < 1000; t++) {
+        float x = sinf (2 * 3.14159265f * 8 * t / fft_size);
+        if (stft_push (stft, x))
+            produced++;
+        stft_push (stft_log, x);
+    }
+    assert (produced == (1000 - fft_size) / hop_size + 1);
+    assert (stft_num_frames (stft) == num_frames);
+
+    size_t stride;
+    const float *frames = stft_latest_frames (stft, num_frames, &stride);
+    for (size_t t = 0; t < num_frames; t++) {
+        // Hann window: peak of amplitude 1 tone is N/4
+        assert (fabsf (frames[8 * stride + t] - fft_size / 4.0f) < 1e-2);
+        assert (frames[20 * stride + t] < 1e-2);
+        assert (frames[8 * stride + t] == stft_at (stft, num_frames - 1 - t, 8));
+        assert (fabsf (logf (stft_at (stft, t, 8)) - stft_at (stft_log, t, 8)) < 1e-4);
+    }
+
+    stft_clear (stft);
+    assert (stft_num_frames (stft) == 0);
+
+    stft_free (&stft);
+    stft_free (&stft_log);
+    printf ("OK\n");
+}
@@ -0,0 +1,75 @@
+/*  =========================================================================
+    stft - streaming short-time Fourier transform (spectrogram)
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __STFT_H__
+#define __STFT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "window.h"
+
+typedef struct _stft_t stft_t;
+
+// Value stored for each time-frequency cell
+typedef enum {
+    STFT_MAGNITUDE = 0,  // abs(X)
+    STFT_POWER,          // abs(X)^2
+    STFT_LOG_MAGNITUDE   // natural log of abs(X)
+} stft_scale;
+
+// Create a new stft object.
+// A frame of fft_size/2+1 bins is computed over the latest fft_size samples
+// every hop_size pushed samples, and the latest num_frames frames are kept.
+// fft_size must be even. window_param is beta for Kaiser window.
+stft_t *stft_new (size_t fft_size,
+                  size_t hop_size,
+                  window_type window,
+                  float window_param,
+                  size_t num_frames,
+                  stft_scale scale);
+
+// Destroy stft object
+void stft_free (stft_t **self_p);
+
+// Destroy stft object
+void stft_free_unsafe (stft_t *self);
+
+// Add new value. Return true if a new frame was computed.
+bool stft_push (stft_t *self, float new_value);
+
+// Number of frequency bins of each frame, i.e. fft_size/2+1
+size_t stft_num_bins (stft_t *self);
+
+// Number of frames available, i.e. min(frames computed so far, num_frames)
+size_t stft_num_frames (stft_t *self);
+
+// Get latest num_frames frames without copying.
+// Returns pointer p, where value of bin k at frame t (t = 0 for the oldest,
+// t = num_frames-1 for the latest) is p[k * (*stride) + t], so the time
+// series of each bin is contiguous. Valid until the next stft_push.
+const float *stft_latest_frames (stft_t *self, size_t num_frames, size_t *stride);
+
+// Get value of bin at frame (0 for the latest, 1 for the one before, ...)
+float stft_at (stft_t *self, size_t frame, size_t bin);
+
+// Reset to zero data and no frames
+void stft_clear (stft_t *self);
+
+// Self test
+void stft_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,381 @@
+/*  =========================================================================
+    tmatch - z-normalized template matching against a set of templates
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "tmatch.h"
+#include "kissfft/kiss_fftr.h"
+
+
+typedef struct {
+    size_t length;
+    double mean;
+    double std; // population std
+    kiss_fft_cpx *spectrum; // centered, reversed and zero padded, scaled by 1/nfft
+} tmatch_template_t;
+
+struct _tmatch_t {
+    size_t window_size;
+    size_t nfft; // >= window_size, no wrap around of valid lags
+    kiss_fftr_cfg fft_cfg;
+    kiss_fftr_cfg ifft_cfg;
+
+    tmatch_template_t *templates;
+    size_t num_templates;
+    size_t max_templates;
+
+    // scratch
+    float *data; // nfft points
+    kiss_fft_cpx *x_spectrum; // nfft/2+1 points
+    kiss_fft_cpx *product; // nfft/2+1 points
+    double *prefix_sum; // window_size+1 points, of x and x^2
+    double *prefix_sum_squares;
+    float *profile; // window_size points
+};
+
+
+// Remove mean of window in self->data, then transform it and take its prefix
+// sums. Centering keeps the sliding dot products (in float) free of the large
+// terms of a DC offset; the centered templates are blind to any offset.
+static void tmatch_prepare_window (tmatch_t *self) {
+    size_t n = self->window_size;
+    double sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += self->data[i];
+    float mean = (float) (sum / n);
+    for (size_t i = 0; i < n; i++)
+        self->data[i] -= mean;
+
+    self->prefix_sum[0] = 0;
+    self->prefix_sum_squares[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        double v = self->data[i];
+        self->prefix_sum[i+1] = self->prefix_sum[i] + v;
+        self->prefix_sum_squares[i+1] = self->prefix_sum_squares[i] + v * v;
+    }
+    memset (self->data + n, 0, sizeof (float) * (self->nfft - n));
+    kiss_fftr (self->fft_cfg, self->data, self->x_spectrum);
+}
+
+
+// Distance profile of template j against the prepared window
+static void tmatch_profile (tmatch_t *self, size_t j, float *output) {
+    tmatch_template_t *t = &self->templates[j];
+    size_t m = t->length;
+
+    for (size_t k = 0; k < self->nfft/2+1; k++) {
+        kiss_fft_cpx a = self->x_spectrum[k], b = t->spectrum[k];
+        self->product[k].r = a.r * b.r - a.i * b.i;
+        self->product[k].i = a.r * b.i + a.i * b.r;
+    }
+    // sliding dot product of offset i is at i+m-1
+    kiss_fftri (self->ifft_cfg, self->product, self->data);
+
+    double max_distance = sqrt (2.0 * m);
+    for (size_t i = 0; i + m <= self->window_size; i++) {
+        double sum = self->prefix_sum[i+m] - self->prefix_sum[i];
+        double sum_squares = self->prefix_sum_squares[i+m] - self->prefix_sum_squares[i];
+        double mean = sum / m;
+        double var = sum_squares / m - mean * mean;
+        if (var <= 1e-12 * (sum_squares / m)) {
+            output[i] = (float) max_distance;
+            continue;
+        }
+        // template is centered, so the mean of the segment drops out
+        double corr = self->data[i+m-1] / (m * sqrt (var) * t->std);
+        if (corr > 1)
+            corr = 1;
+        else if (corr < -1)
+            corr = -1;
+        output[i] = (float) sqrt (2.0 * m * (1 - corr));
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+tmatch_t *tmatch_new (size_t window_size, size_t max_templates) {
+    if (window_size < 2 || max_templates == 0) {
+        printf("ERROR: invalid window size or number of templates.\n");
+        return NULL;
+    }
+
+    tmatch_t *self = (tmatch_t *) malloc (sizeof (tmatch_t));
+    assert (self);
+
+    self->window_size = window_size;
+    self->nfft = kiss_fftr_next_fast_size_real ((int) window_size);
+    self->fft_cfg = kiss_fftr_alloc ((int) self->nfft, 0, NULL, NULL);
+    self->ifft_cfg = kiss_fftr_alloc ((int) self->nfft, 1, NULL, NULL);
+    assert (self->fft_cfg && self->ifft_cfg);
+
+    self->templates = (tmatch_template_t *) malloc (sizeof (tmatch_template_t) * max_templates);
+    assert (self->templates);
+    self->num_templates = 0;
+    self->max_templates = max_templates;
+
+    self->data = (float *) malloc (sizeof (float) * self->nfft);
+    self->x_spectrum = (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * (self->nfft/2+1));
+    self->product = (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * (self->nfft/2+1));
+    self->prefix_sum = (double *) malloc (sizeof (double) * (window_size + 1));
+    self->prefix_sum_squares = (double *) malloc (sizeof (double) * (window_size + 1));
+    self->profile = (float *) malloc (sizeof (float) * window_size);
+    assert (self->data && self->x_spectrum && self->product &&
+            self->prefix_sum && self->prefix_sum_squares && self->profile);
+
+    return self;
+}
+
+
+int tmatch_add_template (tmatch_t *self, const float *values, size_t length) {
+    assert (self);
+    assert (values);
+    if (self->num_templates == self->max_templates) {
+        printf("ERROR: too many templates.\n");
+        return -1;
+    }
+    if (length < 2 || length > self->window_size) {
+        printf("ERROR: invalid template length.\n");
+        return -1;
+    }
+
+    double sum = 0, sum_squares = 0;
+    for (size_t i = 0; i < length; i++) {
+        sum += values[i];
+        sum_squares += (double) values[i] * values[i];
+    }
+    double mean = sum / length;
+    double var = sum_squares / length - mean * mean;
+    if (var <= 1e-12 * (sum_squares / length)) {
+        printf("ERROR: template is constant.\n");
+        return -1;
+    }
+
+    tmatch_template_t *t = &self->templates[self->num_templates];
+    t->length = length;
+    t->mean = mean;
+    t->std = sqrt (var);
+    t->spectrum = (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * (self->nfft/2+1));
+    assert (t->spectrum);
+
+    // centered and reversed, so that convolution gives sliding dot products
+    // with the mean of the window segment dropping out
+    float scale = 1.0f / self->nfft;
+    memset (self->data, 0, sizeof (float) * self->nfft);
+    for (size_t i = 0; i < length; i++)
+        self->data[i] = (float) ((values[length - 1 - i] - mean) * scale);
+    kiss_fftr (self->fft_cfg, self->data, t->spectrum);
+
+    return (int) self->num_templates++;
+}
+
+
+size_t tmatch_num_templates (tmatch_t *self) {
+    assert (self);
+    return self->num_templates;
+}
+
+
+size_t tmatch_template_length (tmatch_t *self, size_t index) {
+    assert (self);
+    assert (index < self->num_templates);
+    return self->templates[index].length;
+}
+
+
+static void tmatch_compute_prepared (tmatch_t *self, tmatch_result *results) {
+    for (size_t j = 0; j < self->num_templates; j++) {
+        size_t m = self->templates[j].length;
+        size_t num_offsets = self->window_size - m + 1;
+        tmatch_profile (self, j, self->profile);
+        size_t best = 0;
+        for (size_t i = 1; i < num_offsets; i++)
+            if (self->profile[i] < self->profile[best])
+                best = i;
+        results[j].offset = best;
+        results[j].distance = self->profile[best];
+        results[j].correlation = 1 - self->profile[best] * self->profile[best] / (2.0f * m);
+    }
+}
+
+
+void tmatch_compute (tmatch_t *self, const float *x, tmatch_result *results) {
+    assert (self);
+    assert (x);
+    assert (results);
+    memcpy (self->data, x, sizeof (float) * self->window_size);
+    tmatch_prepare_window (self);
+    tmatch_compute_prepared (self, results);
+}
+
+
+void tmatch_compute_buffer (tmatch_t *self, dsbuffer_t *buf, tmatch_result *results) {
+    assert (self);
+    assert (buf);
+    assert (results);
+    assert (dsbuffer_size (buf) == self->window_size);
+    dsbuffer_dump (buf, self->data);
+    tmatch_prepare_window (self);
+    tmatch_compute_prepared (self, results);
+}
+
+
+void tmatch_distance_profile (tmatch_t *self, const float *x, size_t index, float *output) {
+    assert (self);
+    assert (x);
+    assert (output);
+    assert (index < self->num_templates);
+    memcpy (self->data, x, sizeof (float) * self->window_size);
+    tmatch_prepare_window (self);
+    tmatch_profile (self, index, output);
+}
+
+
+void tmatch_free (tmatch_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        tmatch_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void tmatch_free_unsafe (tmatch_t *self) {
+    assert (self);
+    for (size_t j = 0; j < self->num_templates; j++)
+        free (self->templates[j].spectrum);
+    free (self->templates);
+    kiss_fftr_free (self->fft_cfg);
+    kiss_fftr_free (self->ifft_cfg);
+    free (self->data);
+    free (self->x_spectrum);
+    free (self->product);
+    free (self->prefix_sum);
+    free (self->prefix_sum_squares);
+    free (self->profile);
+    free (self);
+}
+
+
+// ---------------------------------------------------------------------------
+// z-normalized distance by definition
+static float tmatch_naive_distance (const float *x, const float *q, size_t m) {
+    double mx = 0, mq = 0, sx = 0, sq = 0;
+    for (size_t i = 0; i < m; i++) {
+        mx += x[i];
+        mq += q[i];
+    }
+    mx /= m;
+    mq /= m;
+    for (size_t i = 0; i < m; i++) {
+        sx += (x[i] - mx) * (x[i] - mx);
+        sq += (q[i] - mq) * (q[i] - mq);
+    }
+    sx = sqrt (sx / m);
+    sq = sqrt (sq / m);
+    double d = 0;
+    for (size_t i = 0; i < m; i++) {
+        double e = (x[i] - mx) / sx - (q[i] - mq) / sq;
+        d += e * e;
+    }
+    return (float) sqrt (d);
+}
+
+
+void tmatch_test (void) {
+    printf ("\n[tmatch] Test...\n");
+
+    size_t window_size = 300;
+    tmatch_t *tm = tmatch_new (window_size, 3);
+    assert (tm);
+
+    // templates: chirp, square pulse, damped sine
+    float t0[40], t1[25], t2[64];
+    for (size_t i = 0; i < 40; i++)
+        t0[i] = sinf (0.01f * i * i);
+    for (size_t i = 0; i < 25; i++)
+        t1[i] = (i >= 5 && i < 15) ? 1.0f : 0.0f;
+    for (size_t i = 0; i < 64; i++)
+        t2[i] = expf (-0.05f * i) * sinf (0.4f * i);
+    assert (tmatch_add_template (tm, t0, 40) == 0);
+    assert (tmatch_add_template (tm, t1, 25) == 1);
+    assert (tmatch_add_template (tm, t2, 64) == 2);
+    float constant[10] = {0};
+    assert (tmatch_add_template (tm, constant, 10) == -1);
+    assert (tmatch_num_templates (tm) == 3 && tmatch_template_length (tm, 2) == 64);
+
+    // noise with scaled and shifted copies of templates embedded
+    float *x = (float *) malloc (sizeof (float) * window_size);
+    assert (x);
+    for (size_t i = 0; i < window_size; i++)
+        x[i] = 100 + 0.2f * ((float) (rand () % 201) - 100) / 100;
+    for (size_t i = 0; i < 40; i++)
+        x[30 + i] = 100 + 3 * t0[i];
+    for (size_t i = 0; i < 25; i++)
+        x[120 + i] = 98 + 0.5f * t1[i];
+    for (size_t i = 0; i < 64; i++)
+        x[200 + i] = 101 - 2 * t2[i] + 4 * t2[i];
+
+    tmatch_result results[3];
+    tmatch_compute (tm, x, results);
+    assert (results[0].offset == 30 && results[0].distance < 0.05f);
+    assert (results[1].offset == 120 && results[1].distance < 0.05f);
+    assert (results[2].offset == 200 && results[2].distance < 0.05f);
+    assert (results[0].correlation > 0.999f);
+
+    // profile against definition
+    float *profile = (float *) malloc (sizeof (float) * window_size);
+    assert (profile);
+    for (size_t j = 0; j < 3; j++) {
+        const float *q = (j == 0) ? t0 : (j == 1) ? t1 : t2;
+        size_t m = tmatch_template_length (tm, j);
+        tmatch_distance_profile (tm, x, j, profile);
+        for (size_t i = 0; i + m <= window_size; i += 7)
+            assert (fabsf (profile[i] - tmatch_naive_distance (x + i, q, m)) < 2e-3);
+    }
+
+    // accuracy does not depend on DC offset
+    float *shifted = (float *) malloc (sizeof (float) * window_size);
+    float *shifted_profile = (float *) malloc (sizeof (float) * window_size);
+    assert (shifted && shifted_profile);
+    for (size_t i = 0; i < window_size; i++)
+        shifted[i] = x[i] - 100;
+    tmatch_distance_profile (tm, shifted, 0, profile);
+    for (size_t i = 0; i < window_size; i++)
+        shifted[i] += 1000;
+    tmatch_distance_profile (tm, shifted, 0, shifted_profile);
+    for (size_t i = 0; i + 40 <= window_size; i++)
+        assert (fabsf (profile[i] - shifted_profile[i]) < 2e-3);
+    free (shifted);
+    free (shifted_profile);
+
+    // same from a wrapped buffer
+    dsbuffer_t *buf = dsbuffer_new (window_size, false);
+    assert (buf);
+    for (size_t i = 0; i < 50; i++)
+        dsbuffer_push (buf, 0);
+    for (size_t i = 0; i < window_size; i++)
+        dsbuffer_push (buf, x[i]);
+    tmatch_result buffer_results[3];
+    tmatch_compute_buffer (tm, buf, buffer_results);
+    for (size_t j = 0; j < 3; j++)
+        assert (buffer_results[j].offset == results[j].offset);
+    dsbuffer_free (&buf);
+
+    free (profile);
+    free (x);
+    tmatch_free (&tm);
+    assert (tm == NULL);
+
+    printf ("OK\n");
+}
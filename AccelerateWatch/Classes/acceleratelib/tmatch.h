@@ -0,0 +1,73 @@
+/*  =========================================================================
+    tmatch - z-normalized template matching against a set of templates
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __TMATCH_H__
+#define __TMATCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "dsbuffer.h"
+
+typedef struct _tmatch_t tmatch_t;
+
+typedef struct {
+    size_t offset;     // start of best matching segment in window
+    float distance;    // z-normalized Euclidean distance, in [0, 2*sqrt(length)]
+    float correlation; // Pearson correlation, 1 - distance^2 / (2*length)
+} tmatch_result;
+
+// Create a new tmatch object for windows of window_size points and at most
+// max_templates templates.
+// For each template, the distance of every window segment of template length
+// to the template, both z-normalized, is computed at once (MASS): the sliding
+// dot products by FFT and the segment means and stds by prefix sums. The
+// window is transformed once for all templates.
+tmatch_t *tmatch_new (size_t window_size, size_t max_templates);
+
+// Destroy tmatch object
+void tmatch_free (tmatch_t **self_p);
+
+// Destroy tmatch object
+void tmatch_free_unsafe (tmatch_t *self);
+
+// Add template of length points (2 ... window_size, not constant). Its
+// statistics and spectrum are computed here, once.
+// Return template index, or -1 on error.
+int tmatch_add_template (tmatch_t *self, const float *values, size_t length);
+
+// Number of templates
+size_t tmatch_num_templates (tmatch_t *self);
+
+// Length of template
+size_t tmatch_template_length (tmatch_t *self, size_t index);
+
+// Best match of every template in window x (window_size points).
+// Return results in param results (one per template).
+void tmatch_compute (tmatch_t *self, const float *x, tmatch_result *results);
+
+// Same as tmatch_compute on the data of buffer of window_size points
+void tmatch_compute_buffer (tmatch_t *self, dsbuffer_t *buf, tmatch_result *results);
+
+// Distance profile of one template against window x, i.e. the distance at
+// every offset. Return results in param output (window_size-length+1 points).
+// A constant segment has distance sqrt(2*length) (correlation 0).
+void tmatch_distance_profile (tmatch_t *self, const float *x, size_t index, float *output);
+
+// Self test
+void tmatch_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
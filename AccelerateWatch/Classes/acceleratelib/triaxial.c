@@ -0,0 +1,230 @@
+/*  =========================================================================
+    triaxial - streaming magnitude and gravity projected components of
+               3-axis (e.g. accelerometer) samples
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "triaxial.h"
+#include "vectorf.h"
+#include "vectord.h"
+
+
+struct _triaxial_t {
+    dsbuffer_t *magnitude;
+    dsbuffer_t *vertical;
+    dsbuffer_t *horizontal;
+
+    float gravity_alpha;
+    float gravity[3];
+    bool has_gravity; // false until first sample
+};
+
+
+triaxial_t *triaxial_new (size_t size, bool perform_fft, float gravity_alpha) {
+    if (!(gravity_alpha > 0 && gravity_alpha <= 1)) {
+        printf("ERROR: gravity alpha must be in (0, 1].\n");
+        return NULL;
+    }
+
+    triaxial_t *self = (triaxial_t *) malloc (sizeof (triaxial_t));
+    assert (self);
+    self->magnitude = dsbuffer_new (size, perform_fft);
+    self->vertical = dsbuffer_new (size, perform_fft);
+    self->horizontal = dsbuffer_new (size, perform_fft);
+    if (!self->magnitude || !self->vertical || !self->horizontal) {
+        triaxial_free_unsafe (self);
+        return NULL;
+    }
+    self->gravity_alpha = gravity_alpha;
+    self->gravity[0] = self->gravity[1] = self->gravity[2] = 0;
+    self->has_gravity = false;
+    return self;
+}
+
+
+void triaxial_push (triaxial_t *self, float x, float y, float z) {
+    assert (self);
+
+    float *g = self->gravity;
+    if (self->has_gravity) {
+        float a = self->gravity_alpha;
+        g[0] += a * (x - g[0]);
+        g[1] += a * (y - g[1]);
+        g[2] += a * (z - g[2]);
+    }
+    else {
+        g[0] = x;
+        g[1] = y;
+        g[2] = z;
+        self->has_gravity = true;
+    }
+
+    float squared = x * x + y * y + z * z;
+    float g_norm = sqrtf (g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+    float along = 0;
+    if (g_norm > 0)
+        along = (x * g[0] + y * g[1] + z * g[2]) / g_norm;
+    float horizontal_squared = squared - along * along;
+
+    dsbuffer_push (self->magnitude, sqrtf (squared));
+    dsbuffer_push (self->vertical, along - g_norm);
+    dsbuffer_push (self->horizontal, (horizontal_squared > 0) ? sqrtf (horizontal_squared) : 0);
+}
+
+
+void triaxial_push_interleaved (triaxial_t *self, const float *xyz, size_t count) {
+    assert (self);
+    assert (xyz);
+    for (size_t i = 0; i < count; i++)
+        triaxial_push (self, xyz[3*i], xyz[3*i+1], xyz[3*i+2]);
+}
+
+
+void triaxial_clear (triaxial_t *self) {
+    assert (self);
+    dsbuffer_clear (self->magnitude);
+    dsbuffer_clear (self->vertical);
+    dsbuffer_clear (self->horizontal);
+    self->gravity[0] = self->gravity[1] = self->gravity[2] = 0;
+    self->has_gravity = false;
+}
+
+
+dsbuffer_t *triaxial_magnitude (triaxial_t *self) {
+    assert (self);
+    return self->magnitude;
+}
+
+
+dsbuffer_t *triaxial_vertical (triaxial_t *self) {
+    assert (self);
+    return self->vertical;
+}
+
+
+dsbuffer_t *triaxial_horizontal (triaxial_t *self) {
+    assert (self);
+    return self->horizontal;
+}
+
+
+void triaxial_gravity (triaxial_t *self, float *output) {
+    assert (self);
+    assert (output);
+    memcpy (output, self->gravity, sizeof (self->gravity));
+}
+
+
+void triaxial_free (triaxial_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        triaxial_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void triaxial_free_unsafe (triaxial_t *self) {
+    assert (self);
+    dsbuffer_free (&self->magnitude);
+    dsbuffer_free (&self->vertical);
+    dsbuffer_free (&self->horizontal);
+    free (self);
+}
+
+
+// ---------------------------------------------------------------------------
+void triaxial_test (void) {
+    printf ("\n[triaxial] Test...\n");
+
+    // 1. Magnitude kernels: SoA and AoS, exact and fast
+    size_t n = 103;
+    float *xyz = (float *) malloc (sizeof (float) * 3 * n);
+    float *x = (float *) malloc (sizeof (float) * n);
+    float *y = (float *) malloc (sizeof (float) * n);
+    float *z = (float *) malloc (sizeof (float) * n);
+    float *exact = (float *) malloc (sizeof (float) * n);
+    float *output = (float *) malloc (sizeof (float) * n);
+    assert (xyz && x && y && z && exact && output);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = xyz[3*i] = sinf (0.3f * i) * 3;
+        y[i] = xyz[3*i+1] = cosf (0.17f * i) - 0.5f;
+        z[i] = xyz[3*i+2] = (i == 0) ? 0 : 9.81f + 0.01f * i;
+        if (i == 1)
+            x[i] = y[i] = z[i] = xyz[3*i] = xyz[3*i+1] = xyz[3*i+2] = 0;
+        exact[i] = (float) sqrt ((double) x[i] * x[i] + (double) y[i] * y[i] + (double) z[i] * z[i]);
+    }
+    vectorf_magnitude3 (x, y, z, n, output);
+    for (size_t i = 0; i < n; i++)
+        assert (fabsf (output[i] - exact[i]) <= 1e-6f * exact[i]);
+    vectorf_magnitude3_interleaved (xyz, n, output);
+    for (size_t i = 0; i < n; i++)
+        assert (fabsf (output[i] - exact[i]) <= 1e-6f * exact[i]);
+    vectorf_magnitude3_fast (x, y, z, n, output);
+    assert (output[1] == 0);
+    for (size_t i = 0; i < n; i++)
+        assert (fabsf (output[i] - exact[i]) <= 2e-3f * exact[i]);
+    vectorf_magnitude3_interleaved_fast (xyz, n, output);
+    for (size_t i = 0; i < n; i++)
+        assert (fabsf (output[i] - exact[i]) <= 2e-3f * exact[i]);
+
+    double xd[3] = {3, 4, 12}, yd[3] = {0, 0, 0}, md[3];
+    vectord_magnitude3 (xd, yd, yd, 3, md);
+    assert (md[2] == 12);
+    vectord_magnitude3_interleaved (xd, 1, md);
+    assert (md[0] == 13);
+    vectord_magnitude3_interleaved_fast (xd, 1, md);
+    assert (fabs (md[0] - 13) < 13 * 2e-3);
+
+    // 2. Device tilted at rest, then shaken horizontally and vertically
+    float gx = 0, gy = 9.81f * sinf (0.5f), gz = 9.81f * cosf (0.5f);
+    float horizontal_dir[3] = {1, 0, 0};
+    triaxial_t *tri = triaxial_new (64, true, 0.05f);
+    assert (tri);
+    for (size_t t = 0; t < 400; t++)
+        triaxial_push (tri, gx, gy, gz);
+    float g[3];
+    triaxial_gravity (tri, g);
+    assert (fabsf (g[1] - gy) < 1e-4f && fabsf (g[2] - gz) < 1e-4f);
+    assert (fabsf (dsbuffer_mean (triaxial_magnitude (tri)) - 9.81f) < 1e-4f);
+    assert (fabsf (dsbuffer_max (triaxial_vertical (tri))) < 1e-4f);
+    assert (dsbuffer_max (triaxial_horizontal (tri)) < 1e-2f);
+
+    // horizontal shake: vertical stays about 0, horizontal follows amplitude
+    for (size_t t = 0; t < 64; t++) {
+        float a = 2 * sinf (0.8f * t);
+        float s[3] = {gx + a * horizontal_dir[0], gy, gz};
+        triaxial_push_interleaved (tri, s, 1);
+    }
+    assert (fabsf (dsbuffer_max (triaxial_horizontal (tri)) - 2) < 0.05f);
+    assert (dsbuffer_max (triaxial_vertical (tri)) < 0.25f);
+
+    // vertical shake along gravity
+    triaxial_clear (tri);
+    for (size_t t = 0; t < 400; t++) {
+        float a = (t < 336) ? 0 : 1.5f * sinf (0.8f * t);
+        triaxial_push (tri, gx, gy * (1 + a / 9.81f), gz * (1 + a / 9.81f));
+    }
+    assert (fabsf (dsbuffer_max (triaxial_vertical (tri)) - 1.5f) < 0.1f);
+    assert (dsbuffer_max (triaxial_horizontal (tri)) < 0.05f);
+    triaxial_free (&tri);
+    assert (tri == NULL);
+
+    free (xyz);
+    free (x);
+    free (y);
+    free (z);
+    free (exact);
+    free (output);
+
+    printf ("OK\n");
+}
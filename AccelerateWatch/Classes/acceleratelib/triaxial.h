@@ -0,0 +1,70 @@
+/*  =========================================================================
+    triaxial - streaming magnitude and gravity projected components of
+               3-axis (e.g. accelerometer) samples
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __TRIAXIAL_H__
+#define __TRIAXIAL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "dsbuffer.h"
+
+typedef struct _triaxial_t triaxial_t;
+
+// Create a new triaxial object with three buffers of size points, filled by
+// each 3-axis sample in one pass:
+// - magnitude: sqrt(x^2+y^2+z^2), orientation invariant
+// - vertical: component along gravity minus gravity magnitude, i.e. 0 at
+//   rest, positive when accelerating along gravity
+// - horizontal: magnitude of the component orthogonal to gravity
+// Gravity is estimated by an exponential moving average of samples with
+// weight gravity_alpha in (0, 1] for each new sample (e.g. 0.02 for about a
+// second at 50 Hz). perform_fft applies to all three buffers.
+triaxial_t *triaxial_new (size_t size, bool perform_fft, float gravity_alpha);
+
+// Destroy triaxial object
+void triaxial_free (triaxial_t **self_p);
+
+// Destroy triaxial object
+void triaxial_free_unsafe (triaxial_t *self);
+
+// Add new 3-axis sample
+void triaxial_push (triaxial_t *self, float x, float y, float z);
+
+// Add count 3-axis samples interleaved as x0 y0 z0 x1 y1 z1 ...
+void triaxial_push_interleaved (triaxial_t *self, const float *xyz, size_t count);
+
+// Reset buffers to zeros and forget gravity estimate
+void triaxial_clear (triaxial_t *self);
+
+// Buffer of magnitudes, owned by triaxial object. Use the dsbuffer
+// functions for features, but do not push to it or free it.
+dsbuffer_t *triaxial_magnitude (triaxial_t *self);
+
+// Buffer of vertical components, owned by triaxial object
+dsbuffer_t *triaxial_vertical (triaxial_t *self);
+
+// Buffer of horizontal components, owned by triaxial object
+dsbuffer_t *triaxial_horizontal (triaxial_t *self);
+
+// Current gravity estimate (3 points) in param output
+void triaxial_gravity (triaxial_t *self, float *output);
+
+// Self test
+void triaxial_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,372 @@
+/*  =========================================================================
+    vector_expr - C++ expression templates over vectorf and vectord
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __VECTOR_EXPR_H__
+#define __VECTOR_EXPR_H__
+
+// Header only, and empty unless compiled as C++ (C++11 or later).
+//
+// Element-wise expressions of views are lazy: no operation runs and nothing
+// is allocated until the expression is reduced (sum, mean, dot, ...) or
+// assigned to an output array, and then the whole chain is evaluated in one
+// loop. A reduction inside an expression, e.g. mean(a) in a - mean(a), is
+// evaluated first to a scalar, so
+//
+//     acceleratelib::view<float> a (x, n), w (weights, n);
+//     float norm = acceleratelib::norm (a - acceleratelib::mean (a));
+//     float r = acceleratelib::dot ((a - acceleratelib::mean (a)) / norm, w);
+//
+// takes one pass per reduction and no temporary arrays. Reductions of plain
+// views go to the SIMD kernels of vectorf and vectord.
+//
+// Views hold pointers only; they must not outlive the data they look at.
+
+#ifdef __cplusplus
+
+#include <stdio.h>
+#include <stddef.h>
+#include <math.h>
+#include <assert.h>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+# if __has_include(<span>)
+#  include <span>
+#  define VECTOR_EXPR_HAVE_SPAN
+# endif
+#endif
+
+#include "vectorf.h"
+#include "vectord.h"
+#include "dsbuffer.h"
+#include "dsbufferd.h"
+
+namespace acceleratelib {
+
+// Base of all expressions (CRTP)
+template <typename E>
+struct expr {
+    const E &self () const { return static_cast<const E &> (*this); }
+};
+
+
+// ---------------------------------------------------------------------------
+// Leaves
+
+// Contiguous array
+template <typename T>
+class view : public expr<view<T> > {
+public:
+    typedef T value_type;
+
+    view (const T *data, size_t size) : data_ (data), size_ (size) { assert (data || size == 0); }
+#ifdef VECTOR_EXPR_HAVE_SPAN
+    view (std::span<const T> s) : data_ (s.data ()), size_ (s.size ()) {}
+    view (std::span<T> s) : data_ (s.data ()), size_ (s.size ()) {}
+#endif
+
+    T operator[] (size_t i) const { return data_[i]; }
+    size_t size () const { return size_; }
+    const T *data () const { return data_; }
+
+private:
+    const T *data_;
+    size_t size_;
+};
+
+
+// Buffer data in time order, in at most two contiguous parts
+template <typename T>
+class ring_view : public expr<ring_view<T> > {
+public:
+    typedef T value_type;
+
+    ring_view (const T *first, size_t first_size, const T *second, size_t size)
+        : first_ (first), first_size_ (first_size), second_ (second), size_ (size) {}
+
+    T operator[] (size_t i) const { return (i < first_size_) ? first_[i] : second_[i - first_size_]; }
+    size_t size () const { return size_; }
+
+private:
+    const T *first_;
+    size_t first_size_;
+    const T *second_;
+    size_t size_;
+};
+
+
+// View of data of buffer, valid until next push
+inline ring_view<float> buffer_view (dsbuffer_t *buf) {
+    const float *first, *second;
+    size_t first_size = dsbuffer_view (buf, &first, &second);
+    return ring_view<float> (first, first_size, second, dsbuffer_size (buf));
+}
+
+
+inline ring_view<double> buffer_view (dsbufferd_t *buf) {
+    const double *first, *second;
+    size_t first_size = dsbufferd_view (buf, &first, &second);
+    return ring_view<double> (first, first_size, second, dsbufferd_size (buf));
+}
+
+
+// Scalar broadcast to any size (size 0 means any)
+template <typename T>
+class scalar : public expr<scalar<T> > {
+public:
+    typedef T value_type;
+
+    explicit scalar (T value) : value_ (value) {}
+
+    T operator[] (size_t) const { return value_; }
+    size_t size () const { return 0; }
+
+private:
+    T value_;
+};
+
+
+// ---------------------------------------------------------------------------
+// Nodes. Operands are held by value: they are only pointers and scalars.
+
+template <typename Op, typename L, typename R>
+class binary : public expr<binary<Op, L, R> > {
+public:
+    typedef typename L::value_type value_type;
+
+    binary (const L &l, const R &r) : l_ (l), r_ (r) {
+        assert (l.size () == 0 || r.size () == 0 || l.size () == r.size ());
+    }
+
+    value_type operator[] (size_t i) const { return Op::apply (l_[i], r_[i]); }
+    size_t size () const { return l_.size () ? l_.size () : r_.size (); }
+
+private:
+    L l_;
+    R r_;
+};
+
+
+template <typename Op, typename E>
+class unary : public expr<unary<Op, E> > {
+public:
+    typedef typename E::value_type value_type;
+
+    explicit unary (const E &e) : e_ (e) {}
+
+    value_type operator[] (size_t i) const { return Op::apply (e_[i]); }
+    size_t size () const { return e_.size (); }
+
+private:
+    E e_;
+};
+
+
+struct op_add { template <typename T> static T apply (T a, T b) { return a + b; } };
+struct op_sub { template <typename T> static T apply (T a, T b) { return a - b; } };
+struct op_mul { template <typename T> static T apply (T a, T b) { return a * b; } };
+struct op_div { template <typename T> static T apply (T a, T b) { return a / b; } };
+struct op_neg { template <typename T> static T apply (T a) { return -a; } };
+struct op_abs { template <typename T> static T apply (T a) { return (a < 0) ? -a : a; } };
+struct op_square { template <typename T> static T apply (T a) { return a * a; } };
+struct op_sqrt {
+    static float apply (float a) { return sqrtf (a); }
+    static double apply (double a) { return ::sqrt (a); }
+};
+
+
+#define VECTOR_EXPR_BINARY_OPERATOR(sym, op) \
+    template <typename L, typename R> \
+    inline binary<op, L, R> operator sym (const expr<L> &l, const expr<R> &r) { \
+        return binary<op, L, R> (l.self (), r.self ()); \
+    } \
+    template <typename L> \
+    inline binary<op, L, scalar<typename L::value_type> > \
+    operator sym (const expr<L> &l, typename L::value_type r) { \
+        return binary<op, L, scalar<typename L::value_type> > ( \
+            l.self (), scalar<typename L::value_type> (r)); \
+    } \
+    template <typename R> \
+    inline binary<op, scalar<typename R::value_type>, R> \
+    operator sym (typename R::value_type l, const expr<R> &r) { \
+        return binary<op, scalar<typename R::value_type>, R> ( \
+            scalar<typename R::value_type> (l), r.self ()); \
+    }
+
+VECTOR_EXPR_BINARY_OPERATOR (+, op_add)
+VECTOR_EXPR_BINARY_OPERATOR (-, op_sub)
+VECTOR_EXPR_BINARY_OPERATOR (*, op_mul)
+VECTOR_EXPR_BINARY_OPERATOR (/, op_div)
+
+#undef VECTOR_EXPR_BINARY_OPERATOR
+
+
+template <typename E>
+inline unary<op_neg, E> operator- (const expr<E> &e) { return unary<op_neg, E> (e.self ()); }
+
+template <typename E>
+inline unary<op_abs, E> abs (const expr<E> &e) { return unary<op_abs, E> (e.self ()); }
+
+template <typename E>
+inline unary<op_square, E> square (const expr<E> &e) { return unary<op_square, E> (e.self ()); }
+
+template <typename E>
+inline unary<op_sqrt, E> sqrt (const expr<E> &e) { return unary<op_sqrt, E> (e.self ()); }
+
+
+// ---------------------------------------------------------------------------
+// Reductions: one loop over the whole expression, with four accumulators
+// like the SIMD kernels
+
+template <typename E>
+inline typename E::value_type sum (const expr<E> &e) {
+    typedef typename E::value_type T;
+    const E &x = e.self ();
+    size_t n = x.size ();
+    T a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        a0 += x[i];
+        a1 += x[i+1];
+        a2 += x[i+2];
+        a3 += x[i+3];
+    }
+    for (; i < n; i++)
+        a0 += x[i];
+    return (a0 + a1) + (a2 + a3);
+}
+
+inline float sum (const view<float> &v) { return vectorf_sum (v.data (), v.size ()); }
+inline double sum (const view<double> &v) { return vectord_sum (v.data (), v.size ()); }
+
+
+template <typename E>
+inline typename E::value_type mean (const expr<E> &e) {
+    assert (e.self ().size () > 0);
+    return sum (e.self ()) / (typename E::value_type) e.self ().size ();
+}
+
+
+// Sum of squares
+template <typename E>
+inline typename E::value_type power (const expr<E> &e) {
+    return sum (square (e));
+}
+
+inline float power (const view<float> &v) { return vectorf_power (v.data (), v.size ()); }
+inline double power (const view<double> &v) { return vectord_power (v.data (), v.size ()); }
+
+
+// Euclidean length
+template <typename E>
+inline typename E::value_type norm (const expr<E> &e) {
+    return op_sqrt::apply (power (e.self ()));
+}
+
+
+template <typename L, typename R>
+inline typename L::value_type dot (const expr<L> &l, const expr<R> &r) {
+    return sum (l * r);
+}
+
+inline float dot (const view<float> &a, const view<float> &b) {
+    assert (a.size () == b.size ());
+    return vectorf_dot_product (a.data (), b.data (), a.size ());
+}
+
+inline double dot (const view<double> &a, const view<double> &b) {
+    assert (a.size () == b.size ());
+    return vectord_dot_product (a.data (), b.data (), a.size ());
+}
+
+
+template <typename E>
+inline typename E::value_type max (const expr<E> &e) {
+    const E &x = e.self ();
+    assert (x.size () > 0);
+    typename E::value_type m = x[0];
+    for (size_t i = 1; i < x.size (); i++)
+        m = (x[i] > m) ? x[i] : m;
+    return m;
+}
+
+
+template <typename E>
+inline typename E::value_type min (const expr<E> &e) {
+    const E &x = e.self ();
+    assert (x.size () > 0);
+    typename E::value_type m = x[0];
+    for (size_t i = 1; i < x.size (); i++)
+        m = (x[i] < m) ? x[i] : m;
+    return m;
+}
+
+
+// Evaluate expression into output (size of expression points). Output may
+// be an array the expression reads, as each point is read before written.
+template <typename E>
+inline void assign (typename E::value_type *output, const expr<E> &e) {
+    const E &x = e.self ();
+    size_t n = x.size ();
+    for (size_t i = 0; i < n; i++)
+        output[i] = x[i];
+}
+
+
+// ---------------------------------------------------------------------------
+// Self test
+inline void vector_expr_test () {
+    printf ("\n[vector_expr] Test...\n");
+
+    const size_t n = 37;
+    float x[n], w[n], out[n], ref[n];
+    for (size_t i = 0; i < n; i++) {
+        x[i] = 2 + sinf (0.3f * i);
+        w[i] = cosf (0.2f * i);
+    }
+    view<float> a (x, n), b (w, n);
+
+    // fused normalization and weighted sum against the C functions
+    float m = mean (a);
+    float length = norm (a - m);
+    vectorf_normalize_to_unit_length (x, n, true, ref);
+    float r = dot ((a - m) / length, b);
+    assert (fabsf (r - vectorf_dot_product (ref, w, n)) < 1e-5f);
+    assert (fabsf (m - vectorf_mean (x, n)) < 1e-6f);
+    assert (fabsf (norm (a) - vectorf_length (x, n)) < 1e-5f);
+
+    assign (out, 2.0f * abs (-a) + 1.0f);
+    for (size_t i = 0; i < n; i++)
+        assert (out[i] == 2 * x[i] + 1);
+    assign (out, sqrt (square (a - 2.0f)));
+    for (size_t i = 0; i < n; i++)
+        assert (fabsf (out[i] - fabsf (x[i] - 2)) < 1e-6f);
+    assert (max (a) == x[26] && min (-a) == -x[26]);  // sin(7.8) is closest to 1
+    assert (min (a - a) == 0 && max (a * 0.0f) == 0);
+
+    // wrapped buffer
+    dsbuffer_t *buf = dsbuffer_new (16, false);
+    assert (buf);
+    for (size_t i = 0; i < 16 + 5; i++)
+        dsbuffer_push (buf, (float) i);
+    ring_view<float> v = buffer_view (buf);
+    assert (v.size () == 16 && v[0] == 5 && v[15] == 20);
+    assert (sum (v) == dsbuffer_sum (buf) && max (v) == dsbuffer_max (buf));
+    assert (fabsf (dot (v - mean (v), v - mean (v)) / 15 - dsbuffer_variance (buf)) < 1e-4f);
+    dsbuffer_free (&buf);
+
+    double xd[5] = {1, 2, 3, 4, 5};
+    view<double> d (xd, 5);
+    assert (sum (d) == 15 && mean (d * 2.0) == 6 && dot (d, d) == 55);
+
+    printf ("OK\n");
+}
+
+} // namespace acceleratelib
+
+#endif // __cplusplus
+
+#endif
@@ -0,0 +1,390 @@
+/*  =========================================================================
+    vector_parallel - vectorf and vectord functions for large arrays, run on
+                      a small pool of threads
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "vector_parallel.h"
+#include "vector_simd.h"
+#include "vectorf.h"
+#include "vectord.h"
+
+
+// ---------------------------------------------------------------------------
+// Thread pool. One job at a time: the caller posts it, then takes chunks
+// like the workers, and returns when no worker is inside the job any more.
+
+typedef struct {
+    void (*run) (void *args, size_t chunk);
+    void *args;
+    size_t num_chunks;
+    size_t next_chunk;              // claimed by atomic add
+} vector_parallel_job;
+
+static struct {
+    pthread_mutex_t submit_lock;    // one caller at a time (jobs, setup)
+    pthread_mutex_t lock;           // guards fields below
+    pthread_cond_t wake;            // new job or stopping
+    pthread_cond_t idle;            // busy dropped to 0
+
+    size_t num_threads;             // including caller, 0 if not set up yet
+    size_t num_workers;
+    pthread_t workers[VECTOR_PARALLEL_MAX_THREADS];
+
+    vector_parallel_job *job;       // NULL when no job to join
+    unsigned long generation;       // incremented for each posted job
+    size_t busy;                    // workers inside job
+    bool stopping;
+} vector_parallel_pool = {
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    0, 0, {0}, NULL, 0, 0, false
+};
+
+#define POOL vector_parallel_pool
+
+
+static void vector_parallel_work (vector_parallel_job *job) {
+    size_t c;
+    while ((c = __atomic_fetch_add (&job->next_chunk, 1, __ATOMIC_RELAXED)) < job->num_chunks)
+        job->run (job->args, c);
+}
+
+
+static void *vector_parallel_worker (void *arg) {
+    unsigned long seen = (unsigned long) (uintptr_t) arg;
+
+    pthread_mutex_lock (&POOL.lock);
+    while (true) {
+        while (!POOL.stopping && POOL.generation == seen)
+            pthread_cond_wait (&POOL.wake, &POOL.lock);
+        if (POOL.stopping)
+            break;
+        seen = POOL.generation;
+        vector_parallel_job *job = POOL.job;
+        if (!job)
+            continue;  // already finished by others
+
+        POOL.busy++;
+        pthread_mutex_unlock (&POOL.lock);
+        vector_parallel_work (job);
+        pthread_mutex_lock (&POOL.lock);
+        if (--POOL.busy == 0)
+            pthread_cond_signal (&POOL.idle);
+    }
+    pthread_mutex_unlock (&POOL.lock);
+    return NULL;
+}
+
+
+// With submit_lock held
+static void vector_parallel_stop_workers (void) {
+    pthread_mutex_lock (&POOL.lock);
+    POOL.stopping = true;
+    pthread_cond_broadcast (&POOL.wake);
+    pthread_mutex_unlock (&POOL.lock);
+
+    for (size_t i = 0; i < POOL.num_workers; i++)
+        pthread_join (POOL.workers[i], NULL);
+    POOL.num_workers = 0;
+    POOL.stopping = false;
+}
+
+
+// With submit_lock held
+static void vector_parallel_setup (size_t num_threads) {
+    vector_parallel_stop_workers ();
+
+    if (num_threads == 0) {
+        long cpus = sysconf (_SC_NPROCESSORS_ONLN);
+        num_threads = (cpus > 0) ? (size_t) cpus : 1;
+    }
+    if (num_threads > VECTOR_PARALLEL_MAX_THREADS)
+        num_threads = VECTOR_PARALLEL_MAX_THREADS;
+
+    for (size_t i = 0; i + 1 < num_threads; i++) {
+        void *seen = (void *) (uintptr_t) POOL.generation;
+        if (pthread_create (&POOL.workers[i], NULL, vector_parallel_worker, seen) != 0) {
+            printf ("ERROR: failed to start thread %zu of %zu\n", i + 1, num_threads);
+            break;
+        }
+        POOL.num_workers++;
+    }
+    POOL.num_threads = num_threads;
+}
+
+
+size_t vector_parallel_threads (void) {
+    pthread_mutex_lock (&POOL.submit_lock);
+    if (POOL.num_threads == 0)
+        vector_parallel_setup (0);
+    size_t num_threads = POOL.num_threads;
+    pthread_mutex_unlock (&POOL.submit_lock);
+    return num_threads;
+}
+
+
+void vector_parallel_set_threads (size_t num_threads) {
+    pthread_mutex_lock (&POOL.submit_lock);
+    vector_parallel_setup (num_threads);
+    pthread_mutex_unlock (&POOL.submit_lock);
+}
+
+
+// Call run (args, c) for every chunk c in [0, num_chunks), on caller and
+// workers
+static void vector_parallel_run (void (*run) (void *, size_t), void *args, size_t num_chunks) {
+    vector_parallel_job job = {run, args, num_chunks, 0};
+
+    pthread_mutex_lock (&POOL.submit_lock);
+    if (POOL.num_threads == 0)
+        vector_parallel_setup (0);
+
+    bool posted = (POOL.num_workers > 0 && num_chunks > 1);
+    if (posted) {
+        pthread_mutex_lock (&POOL.lock);
+        POOL.job = &job;
+        POOL.generation++;
+        pthread_cond_broadcast (&POOL.wake);
+        pthread_mutex_unlock (&POOL.lock);
+    }
+
+    vector_parallel_work (&job);
+
+    if (posted) {
+        // all chunks are taken; wait for those still running
+        pthread_mutex_lock (&POOL.lock);
+        POOL.job = NULL;
+        while (POOL.busy > 0)
+            pthread_cond_wait (&POOL.idle, &POOL.lock);
+        pthread_mutex_unlock (&POOL.lock);
+    }
+    pthread_mutex_unlock (&POOL.submit_lock);
+}
+
+
+// Points per chunk, depending on size only
+static size_t vector_parallel_chunk_size (size_t size, size_t sample_size) {
+    size_t chunk = VECTOR_PARALLEL_CHUNK_BYTES / sample_size;
+    size_t min_chunk = (size + VECTOR_PARALLEL_MAX_CHUNKS - 1) / VECTOR_PARALLEL_MAX_CHUNKS;
+    return (chunk > min_chunk) ? chunk : min_chunk;
+}
+
+
+// Sum of neighbours, then of neighbouring pairs, and so on (in place)
+static double vector_parallel_pairwise_sum (double *partials, size_t count) {
+    if (count == 0)
+        return 0;
+    for (size_t step = 1; step < count; step *= 2)
+        for (size_t i = 0; i + step < count; i += 2 * step)
+            partials[i] += partials[i + step];
+    return partials[0];
+}
+
+
+// ---------------------------------------------------------------------------
+#define VP(name)                vectorf_parallel_##name
+#define VP_T                    float
+#define VP_KERNELS              vectorf_kernels
+#define VP_KERNELS_ACTIVE()     vectorf_kernels_active ()
+#include "vector_parallel.inc"
+
+#define VP(name)                vectord_parallel_##name
+#define VP_T                    double
+#define VP_KERNELS              vectord_kernels
+#define VP_KERNELS_ACTIVE()     vectord_kernels_active ()
+#include "vector_parallel.inc"
+
+
+// ---------------------------------------------------------------------------
+static double vector_parallel_seconds (void) {
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+void vector_parallel_test (void) {
+    printf ("\n[vector_parallel] Test...\n");
+
+    size_t default_threads = vector_parallel_threads ();
+    assert (default_threads >= 1);
+
+    // 1. Chunks cover any size within the chunk limit
+    assert (vector_parallel_chunk_size (1000, sizeof (float)) == VECTOR_PARALLEL_CHUNK_BYTES / sizeof (float));
+    size_t huge = (size_t) 3 << 28;
+    assert (vector_parallel_chunk_size (huge, sizeof (float)) * VECTOR_PARALLEL_MAX_CHUNKS >= huge);
+
+    // 2. Same results bit for bit for any number of threads, close to the
+    // serial functions; sizes below one chunk, around chunk boundaries
+    size_t sizes[5] = {0, 1000, 16384 * 3 + 7, 100003, 1000003};
+    size_t max_size = sizes[4];
+    float *x = (float *) malloc (sizeof (float) * max_size);
+    float *y = (float *) malloc (sizeof (float) * max_size);
+    float *out = (float *) malloc (sizeof (float) * max_size);
+    float *ref = (float *) malloc (sizeof (float) * max_size);
+    assert (x && y && out && ref);
+    for (size_t i = 0; i < max_size; i++) {
+        x[i] = 1 + sinf (0.001f * i);
+        y[i] = cosf (0.0007f * i);
+    }
+    x[77777] = 5;
+    y[99999] = -3;
+
+    size_t thread_counts[4] = {1, 2, 3, 7};
+    for (size_t s = 0; s < 5; s++) {
+        size_t n = sizes[s];
+        float results[4][4];
+        for (size_t t = 0; t < 4; t++) {
+            vector_parallel_set_threads (thread_counts[t]);
+            assert (vector_parallel_threads () == thread_counts[t]);
+            results[t][0] = vectorf_parallel_sum (x, n);
+            results[t][1] = vectorf_parallel_power (x, n);
+            results[t][2] = vectorf_parallel_dot_product (x, y, n);
+            results[t][3] = n ? vectorf_parallel_max (x, n) - vectorf_parallel_min (y, n) : 0;
+            if (t > 0)
+                assert (memcmp (results[t], results[0], sizeof (results[0])) == 0);
+        }
+        // serial sums in float drift on large sizes; compare in double
+        double sum = 0, power = 0, dot = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += x[i];
+            power += (double) x[i] * x[i];
+            dot += (double) x[i] * y[i];
+        }
+        assert (fabs (results[0][0] - sum) <= 1e-6 * (fabs (sum) + n));
+        assert (fabs (results[0][1] - power) <= 1e-6 * (power + n));
+        assert (fabs (results[0][2] - dot) <= 1e-6 * (fabs (dot) + n));
+        if (n > 100000)
+            assert (results[0][3] == 5 - (-3));
+        if (n > 0)
+            assert (fabsf (vectorf_parallel_mean (x, n) - (float) (sum / n)) < 1e-5f);
+
+        vectorf_parallel_multiply_add (x, y, x, n, out);
+        vectorf_multiply_add (x, y, x, n, ref);
+        assert (memcmp (out, ref, sizeof (float) * n) == 0);
+        vectorf_parallel_add_vector (x, y, n, out);
+        vectorf_add_vector (x, y, n, ref);
+        assert (memcmp (out, ref, sizeof (float) * n) == 0);
+        vectorf_parallel_multiply_vector (x, y, n, out);
+        vectorf_multiply_vector (x, y, n, ref);
+        assert (memcmp (out, ref, sizeof (float) * n) == 0);
+        vectorf_parallel_multiply (x, n, 0.5f, out);
+        vectorf_parallel_add (out, n, 1, out);
+        vectorf_parallel_sqrt (out, n, out);
+        vectorf_multiply (x, n, 0.5f, ref);
+        vectorf_add_inplace (ref, n, 1);
+        vectorf_sqrt (ref, n, ref);
+        assert (memcmp (out, ref, sizeof (float) * n) == 0);
+    }
+
+    // double versions, same thread independence
+    size_t nd = 300001;
+    double *u = (double *) malloc (sizeof (double) * nd);
+    double *v = (double *) malloc (sizeof (double) * nd);
+    double *outd = (double *) malloc (sizeof (double) * nd);
+    assert (u && v && outd);
+    for (size_t i = 0; i < nd; i++) {
+        u[i] = sin (0.001 * i);
+        v[i] = 2 + cos (0.0003 * i);
+    }
+    double resultsd[2][4];
+    for (size_t t = 0; t < 2; t++) {
+        vector_parallel_set_threads (t ? 5 : 1);
+        resultsd[t][0] = vectord_parallel_sum (u, nd);
+        resultsd[t][1] = vectord_parallel_power (u, nd);
+        resultsd[t][2] = vectord_parallel_dot_product (u, v, nd);
+        resultsd[t][3] = vectord_parallel_max (v, nd) + vectord_parallel_min (u, nd) + vectord_parallel_mean (v, nd);
+    }
+    assert (memcmp (resultsd[0], resultsd[1], sizeof (resultsd[0])) == 0);
+    assert (fabs (resultsd[0][1] - vectord_power (u, nd)) < 1e-9 * nd);
+    vectord_parallel_multiply_add (u, v, u, nd, outd);
+    vectord_parallel_add_vector (outd, u, nd, outd);
+    vectord_parallel_multiply_vector (outd, v, nd, outd);
+    vectord_parallel_multiply (outd, nd, 2, outd);
+    assert (fabs (outd[12345] - 2 * (u[12345] * v[12345] + 2 * u[12345]) * v[12345]) < 1e-12);
+
+    // 3. Scaling over threads (informative): the time of a pass over 10^7
+    // and 10^8 points (skipped if memory is short) for 1 to max(CPUs, 4)
+    // threads. Results go to a separate array, so every pass reads the same
+    // data.
+    size_t max_threads = (default_threads > 4) ? default_threads : 4;
+    size_t scaling_sizes[2] = {10000000, 100000000};
+    for (int s = 0; s < 2; s++) {
+        size_t n = scaling_sizes[s];
+        int reps = (s == 0) ? 5 : 2;
+        float *big = (float *) malloc (sizeof (float) * n);
+        float *big2 = (float *) malloc (sizeof (float) * n);
+        float *big_out = (float *) malloc (sizeof (float) * n);
+        if (!big || !big2 || !big_out) {
+            printf ("%zu points: skipped, out of memory\n", n);
+            free (big);
+            free (big2);
+            free (big_out);
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            big[i] = (float) (i % 1000) * 0.001f;
+            big2[i] = 1 - big[i];
+            big_out[i] = big[i]; // no page faults in the first timed pass
+        }
+        printf ("%zu points:\n", n);
+        double base[3] = {0, 0, 0};
+        for (size_t t = 1; ; t = (t < 4) ? t + 1 : (t * 2 < max_threads) ? t * 2 : max_threads) {
+            vector_parallel_set_threads (t);
+            double elapsed[3];
+            volatile float sink = 0;
+            for (int f = 0; f < 3; f++) {
+                double start = vector_parallel_seconds ();
+                for (int r = 0; r < reps; r++) {
+                    switch (f) {
+                    case 0: sink += vectorf_parallel_sum (big, n); break;
+                    case 1: sink += vectorf_parallel_dot_product (big, big2, n); break;
+                    default: vectorf_parallel_multiply_vector (big, big2, n, big_out); break;
+                    }
+                }
+                elapsed[f] = (vector_parallel_seconds () - start) / reps;
+                if (t == 1)
+                    base[f] = elapsed[f];
+            }
+            (void) sink;
+            printf ("%zu threads: sum %.2f ms (%.1fx), dot %.2f ms (%.1fx), multiply %.2f ms (%.1fx)\n", t,
+                    1e3 * elapsed[0], base[0] / (elapsed[0] + 1e-12),
+                    1e3 * elapsed[1], base[1] / (elapsed[1] + 1e-12),
+                    1e3 * elapsed[2], base[2] / (elapsed[2] + 1e-12));
+            if (t == max_threads)
+                break;
+        }
+        free (big);
+        free (big2);
+        free (big_out);
+    }
+
+    vector_parallel_set_threads (0);
+    assert (vector_parallel_threads () == default_threads);
+
+    free (x);
+    free (y);
+    free (out);
+    free (ref);
+    free (u);
+    free (v);
+    free (outd);
+
+    printf ("OK\n");
+}
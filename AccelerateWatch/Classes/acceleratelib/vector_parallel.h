@@ -0,0 +1,121 @@
+/*  =========================================================================
+    vector_parallel - vectorf and vectord functions for large arrays, run on
+                      a small pool of threads
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __VECTOR_PARALLEL_H__
+#define __VECTOR_PARALLEL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Arrays are cut into chunks of VECTOR_PARALLEL_CHUNK_BYTES per input (so
+// that the inputs of a chunk stay in L2 cache), or into
+// VECTOR_PARALLEL_MAX_CHUNKS chunks for larger arrays. Chunks are taken by
+// the calling thread and the workers in any order; partial results of
+// reductions are kept per chunk and summed pairwise in a fixed order. The
+// chunks only depend on the size, so results are the same bit for bit for
+// any number of threads (for the same instruction set, see vector_simd.h).
+//
+// Calls from several threads at the same time are run one after another.
+#define VECTOR_PARALLEL_CHUNK_BYTES 65536
+#define VECTOR_PARALLEL_MAX_CHUNKS  1024
+#define VECTOR_PARALLEL_MAX_THREADS 64
+
+// Number of threads used, including the calling one. Default is the number
+// of online CPUs.
+size_t vector_parallel_threads (void);
+
+// Set number of threads used, including the calling one (0 for the number
+// of online CPUs, 1 to stop the workers). Workers are started on first use.
+void vector_parallel_set_threads (size_t num_threads);
+
+// Same as vectorf_sum
+float vectorf_parallel_sum (const float *self, size_t size);
+
+// Same as vectorf_mean
+float vectorf_parallel_mean (const float *self, size_t size);
+
+// Same as vectorf_power
+float vectorf_parallel_power (const float *self, size_t size);
+
+// Same as vectorf_dot_product
+float vectorf_parallel_dot_product (const float *self, const float *vector2, size_t size);
+
+// Maximum value (size > 0)
+float vectorf_parallel_max (const float *self, size_t size);
+
+// Minimum value (size > 0)
+float vectorf_parallel_min (const float *self, size_t size);
+
+// Same as vectorf_add. Return results in param output (may be self).
+void vectorf_parallel_add (const float *self, size_t size, float value, float *output);
+
+// Same as vectorf_multiply. Return results in param output (may be self).
+void vectorf_parallel_multiply (const float *self, size_t size, float value, float *output);
+
+// Same as vectorf_sqrt. Return results in param output (may be self).
+void vectorf_parallel_sqrt (const float *self, size_t size, float *output);
+
+// Same as vectorf_add_vector. Return results in param output.
+void vectorf_parallel_add_vector (const float *self, const float *vector2, size_t size, float *output);
+
+// Same as vectorf_multiply_vector. Return results in param output.
+void vectorf_parallel_multiply_vector (const float *self, const float *vector2, size_t size, float *output);
+
+// Same as vectorf_multiply_add. Return results in param output.
+void vectorf_parallel_multiply_add (const float *self, const float *vector2, const float *vector3, size_t size, float *output);
+
+// Same as vectord_sum
+double vectord_parallel_sum (const double *self, size_t size);
+
+// Same as vectord_mean
+double vectord_parallel_mean (const double *self, size_t size);
+
+// Same as vectord_power
+double vectord_parallel_power (const double *self, size_t size);
+
+// Same as vectord_dot_product
+double vectord_parallel_dot_product (const double *self, const double *vector2, size_t size);
+
+// Maximum value (size > 0)
+double vectord_parallel_max (const double *self, size_t size);
+
+// Minimum value (size > 0)
+double vectord_parallel_min (const double *self, size_t size);
+
+// Same as vectord_add. Return results in param output (may be self).
+void vectord_parallel_add (const double *self, size_t size, double value, double *output);
+
+// Same as vectord_multiply. Return results in param output (may be self).
+void vectord_parallel_multiply (const double *self, size_t size, double value, double *output);
+
+// Same as vectord_sqrt. Return results in param output (may be self).
+void vectord_parallel_sqrt (const double *self, size_t size, double *output);
+
+// Same as vectord_add_vector. Return results in param output.
+void vectord_parallel_add_vector (const double *self, const double *vector2, size_t size, double *output);
+
+// Same as vectord_multiply_vector. Return results in param output.
+void vectord_parallel_multiply_vector (const double *self, const double *vector2, size_t size, double *output);
+
+// Same as vectord_multiply_add. Return results in param output.
+void vectord_parallel_multiply_add (const double *self, const double *vector2, const double *vector3, size_t size, double *output);
+
+// Self test: same results for any number of threads, and speed from 1 to
+// the number of CPUs (at least 4) threads
+void vector_parallel_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,896 @@
+/*  =========================================================================
+    vector_simd - vectorized kernels of vectorf and vectord, selected at
+                  runtime for the instruction sets of the CPU
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <assert.h>
+
+#include "vector_simd.h"
+#include "vectorf.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+# define VECTOR_HAVE_X86
+# include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define VECTOR_HAVE_NEON
+# include <arm_neon.h>
+#endif
+
+
+// ---------------------------------------------------------------------------
+// Reference kernels: the serial loops
+
+static float vectorf_reference_sum (const float *x, size_t size) {
+    float sum = 0.0;
+    for (size_t i = 0; i < size; i++)
+        sum += x[i];
+    return sum;
+}
+
+
+static float vectorf_reference_sum_squares (const float *x, size_t size) {
+    float ss = 0.0;
+    for (size_t i = 0; i < size; i++)
+        ss += x[i] * x[i];
+    return ss;
+}
+
+
+static float vectorf_reference_dot_product (const float *x, const float *y, size_t size) {
+    float result = 0.0;
+    for (size_t i = 0; i < size; i++)
+        result += x[i] * y[i];
+    return result;
+}
+
+
+static void vectorf_reference_add (const float *x, size_t size, float value, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] + value;
+}
+
+
+static void vectorf_reference_multiply (const float *x, size_t size, float value, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] * value;
+}
+
+
+static void vectorf_reference_sqrt (const float *x, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = sqrtf (x[i]);
+}
+
+
+static void vectorf_reference_add_vector (const float *x, const float *y, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] + y[i];
+}
+
+
+static void vectorf_reference_subtract_vector (const float *x, const float *y, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] - y[i];
+}
+
+
+static void vectorf_reference_multiply_vector (const float *x, const float *y, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] * y[i];
+}
+
+
+static void vectorf_reference_divide_vector (const float *x, const float *y, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] / y[i];
+}
+
+
+static void vectorf_reference_multiply_add (const float *x, const float *y, const float *z, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] * y[i] + z[i];
+}
+
+
+static void vectorf_reference_axpy (const float *x, float value, const float *y, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = value * y[i] + x[i];
+}
+
+
+static void vectorf_reference_clamp (const float *x, size_t size, float low, float high, float *output) {
+    for (size_t i = 0; i < size; i++) {
+        float v = (x[i] > low) ? x[i] : low;
+        output[i] = (v < high) ? v : high;
+    }
+}
+
+
+static void vectorf_reference_abs (const float *x, size_t size, float *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = fabsf (x[i]);
+}
+
+
+static double vectord_reference_sum (const double *x, size_t size) {
+    double sum = 0.0;
+    for (size_t i = 0; i < size; i++)
+        sum += x[i];
+    return sum;
+}
+
+
+static double vectord_reference_sum_squares (const double *x, size_t size) {
+    double ss = 0.0;
+    for (size_t i = 0; i < size; i++)
+        ss += x[i] * x[i];
+    return ss;
+}
+
+
+static double vectord_reference_dot_product (const double *x, const double *y, size_t size) {
+    double result = 0.0;
+    for (size_t i = 0; i < size; i++)
+        result += x[i] * y[i];
+    return result;
+}
+
+
+static void vectord_reference_add (const double *x, size_t size, double value, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] + value;
+}
+
+
+static void vectord_reference_multiply (const double *x, size_t size, double value, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] * value;
+}
+
+
+static void vectord_reference_sqrt (const double *x, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = sqrt (x[i]);
+}
+
+
+static void vectord_reference_add_vector (const double *x, const double *y, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] + y[i];
+}
+
+
+static void vectord_reference_subtract_vector (const double *x, const double *y, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] - y[i];
+}
+
+
+static void vectord_reference_multiply_vector (const double *x, const double *y, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] * y[i];
+}
+
+
+static void vectord_reference_divide_vector (const double *x, const double *y, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] / y[i];
+}
+
+
+static void vectord_reference_multiply_add (const double *x, const double *y, const double *z, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = x[i] * y[i] + z[i];
+}
+
+
+static void vectord_reference_axpy (const double *x, double value, const double *y, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = value * y[i] + x[i];
+}
+
+
+static void vectord_reference_clamp (const double *x, size_t size, double low, double high, double *output) {
+    for (size_t i = 0; i < size; i++) {
+        double v = (x[i] > low) ? x[i] : low;
+        output[i] = (v < high) ? v : high;
+    }
+}
+
+
+static void vectord_reference_abs (const double *x, size_t size, double *output) {
+    for (size_t i = 0; i < size; i++)
+        output[i] = fabs (x[i]);
+}
+
+
+static const vectorf_kernels vectorf_reference_kernels = {
+    vectorf_reference_sum,
+    vectorf_reference_sum_squares,
+    vectorf_reference_dot_product,
+    vectorf_reference_add,
+    vectorf_reference_multiply,
+    vectorf_reference_sqrt,
+    vectorf_reference_add_vector,
+    vectorf_reference_subtract_vector,
+    vectorf_reference_multiply_vector,
+    vectorf_reference_divide_vector,
+    vectorf_reference_multiply_add,
+    vectorf_reference_axpy,
+    vectorf_reference_clamp,
+    vectorf_reference_abs
+};
+
+static const vectord_kernels vectord_reference_kernels = {
+    vectord_reference_sum,
+    vectord_reference_sum_squares,
+    vectord_reference_dot_product,
+    vectord_reference_add,
+    vectord_reference_multiply,
+    vectord_reference_sqrt,
+    vectord_reference_add_vector,
+    vectord_reference_subtract_vector,
+    vectord_reference_multiply_vector,
+    vectord_reference_divide_vector,
+    vectord_reference_multiply_add,
+    vectord_reference_axpy,
+    vectord_reference_clamp,
+    vectord_reference_abs
+};
+
+
+#define VECTOR_KERNEL_TABLE(type, prefix) \
+    static const type prefix##_kernels = { \
+        prefix##_sum, \
+        prefix##_sum_squares, \
+        prefix##_dot_product, \
+        prefix##_add, \
+        prefix##_multiply, \
+        prefix##_sqrt, \
+        prefix##_add_vector, \
+        prefix##_subtract_vector, \
+        prefix##_multiply_vector, \
+        prefix##_divide_vector, \
+        prefix##_multiply_add, \
+        prefix##_axpy, \
+        prefix##_clamp, \
+        prefix##_abs \
+    };
+
+
+// ---------------------------------------------------------------------------
+// x86: SSE2 is part of x86-64; AVX2 and AVX-512 are compiled with target
+// attributes and only called if CPUID reports them
+
+#ifdef VECTOR_HAVE_X86
+
+static inline float vector_hsum_sse_ps (__m128 v) {
+    __m128 s = _mm_add_ps (v, _mm_movehl_ps (v, v));
+    s = _mm_add_ss (s, _mm_shuffle_ps (s, s, 1));
+    return _mm_cvtss_f32 (s);
+}
+
+
+static inline double vector_hsum_sse_pd (__m128d v) {
+    return _mm_cvtsd_f64 (_mm_add_sd (v, _mm_unpackhi_pd (v, v)));
+}
+
+
+__attribute__ ((target ("avx2,fma")))
+static inline float vector_hsum_avx_ps (__m256 v) {
+    return vector_hsum_sse_ps (_mm_add_ps (_mm256_castps256_ps128 (v),
+                                           _mm256_extractf128_ps (v, 1)));
+}
+
+
+__attribute__ ((target ("avx2,fma")))
+static inline double vector_hsum_avx_pd (__m256d v) {
+    return vector_hsum_sse_pd (_mm_add_pd (_mm256_castpd256_pd128 (v),
+                                           _mm256_extractf128_pd (v, 1)));
+}
+
+
+#define VS(name)            vectorf_sse2_##name
+#define VS_T                float
+#define VS_V                __m128
+#define VS_W                4
+#define VS_TARGET
+#define VS_LOAD(p)          _mm_loadu_ps (p)
+#define VS_STORE(p, v)      _mm_storeu_ps (p, v)
+#define VS_SET1(x)          _mm_set1_ps (x)
+#define VS_ZERO()           _mm_setzero_ps ()
+#define VS_ADD(a, b)        _mm_add_ps (a, b)
+#define VS_SUB(a, b)        _mm_sub_ps (a, b)
+#define VS_MUL(a, b)        _mm_mul_ps (a, b)
+#define VS_DIV(a, b)        _mm_div_ps (a, b)
+#define VS_MIN(a, b)        _mm_min_ps (a, b)
+#define VS_MAX(a, b)        _mm_max_ps (a, b)
+#define VS_ABS(v)           _mm_andnot_ps (_mm_set1_ps (-0.0f), v)
+#define VS_MADD(a, b, c)    _mm_add_ps (_mm_mul_ps (a, b), c)
+#define VS_HSUM(v)          vector_hsum_sse_ps (v)
+#define VS_SQRT(v)          _mm_sqrt_ps (v)
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectorf_kernels, vectorf_sse2)
+
+#define VS(name)            vectord_sse2_##name
+#define VS_T                double
+#define VS_V                __m128d
+#define VS_W                2
+#define VS_TARGET
+#define VS_LOAD(p)          _mm_loadu_pd (p)
+#define VS_STORE(p, v)      _mm_storeu_pd (p, v)
+#define VS_SET1(x)          _mm_set1_pd (x)
+#define VS_ZERO()           _mm_setzero_pd ()
+#define VS_ADD(a, b)        _mm_add_pd (a, b)
+#define VS_SUB(a, b)        _mm_sub_pd (a, b)
+#define VS_MUL(a, b)        _mm_mul_pd (a, b)
+#define VS_DIV(a, b)        _mm_div_pd (a, b)
+#define VS_MIN(a, b)        _mm_min_pd (a, b)
+#define VS_MAX(a, b)        _mm_max_pd (a, b)
+#define VS_ABS(v)           _mm_andnot_pd (_mm_set1_pd (-0.0), v)
+#define VS_MADD(a, b, c)    _mm_add_pd (_mm_mul_pd (a, b), c)
+#define VS_HSUM(v)          vector_hsum_sse_pd (v)
+#define VS_SQRT(v)          _mm_sqrt_pd (v)
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectord_kernels, vectord_sse2)
+
+#define VS(name)            vectorf_avx2_##name
+#define VS_T                float
+#define VS_V                __m256
+#define VS_W                8
+#define VS_TARGET           __attribute__ ((target ("avx2,fma")))
+#define VS_LOAD(p)          _mm256_loadu_ps (p)
+#define VS_STORE(p, v)      _mm256_storeu_ps (p, v)
+#define VS_SET1(x)          _mm256_set1_ps (x)
+#define VS_ZERO()           _mm256_setzero_ps ()
+#define VS_ADD(a, b)        _mm256_add_ps (a, b)
+#define VS_SUB(a, b)        _mm256_sub_ps (a, b)
+#define VS_MUL(a, b)        _mm256_mul_ps (a, b)
+#define VS_DIV(a, b)        _mm256_div_ps (a, b)
+#define VS_MIN(a, b)        _mm256_min_ps (a, b)
+#define VS_MAX(a, b)        _mm256_max_ps (a, b)
+#define VS_ABS(v)           _mm256_andnot_ps (_mm256_set1_ps (-0.0f), v)
+#define VS_MADD(a, b, c)    _mm256_fmadd_ps (a, b, c)
+#define VS_HSUM(v)          vector_hsum_avx_ps (v)
+#define VS_SQRT(v)          _mm256_sqrt_ps (v)
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectorf_kernels, vectorf_avx2)
+
+#define VS(name)            vectord_avx2_##name
+#define VS_T                double
+#define VS_V                __m256d
+#define VS_W                4
+#define VS_TARGET           __attribute__ ((target ("avx2,fma")))
+#define VS_LOAD(p)          _mm256_loadu_pd (p)
+#define VS_STORE(p, v)      _mm256_storeu_pd (p, v)
+#define VS_SET1(x)          _mm256_set1_pd (x)
+#define VS_ZERO()           _mm256_setzero_pd ()
+#define VS_ADD(a, b)        _mm256_add_pd (a, b)
+#define VS_SUB(a, b)        _mm256_sub_pd (a, b)
+#define VS_MUL(a, b)        _mm256_mul_pd (a, b)
+#define VS_DIV(a, b)        _mm256_div_pd (a, b)
+#define VS_MIN(a, b)        _mm256_min_pd (a, b)
+#define VS_MAX(a, b)        _mm256_max_pd (a, b)
+#define VS_ABS(v)           _mm256_andnot_pd (_mm256_set1_pd (-0.0), v)
+#define VS_MADD(a, b, c)    _mm256_fmadd_pd (a, b, c)
+#define VS_HSUM(v)          vector_hsum_avx_pd (v)
+#define VS_SQRT(v)          _mm256_sqrt_pd (v)
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectord_kernels, vectord_avx2)
+
+#define VS(name)            vectorf_avx512_##name
+#define VS_T                float
+#define VS_V                __m512
+#define VS_W                16
+#define VS_TARGET           __attribute__ ((target ("avx512f")))
+#define VS_LOAD(p)          _mm512_loadu_ps (p)
+#define VS_STORE(p, v)      _mm512_storeu_ps (p, v)
+#define VS_SET1(x)          _mm512_set1_ps (x)
+#define VS_ZERO()           _mm512_setzero_ps ()
+#define VS_ADD(a, b)        _mm512_add_ps (a, b)
+#define VS_SUB(a, b)        _mm512_sub_ps (a, b)
+#define VS_MUL(a, b)        _mm512_mul_ps (a, b)
+#define VS_DIV(a, b)        _mm512_div_ps (a, b)
+#define VS_MIN(a, b)        _mm512_min_ps (a, b)
+#define VS_MAX(a, b)        _mm512_max_ps (a, b)
+#define VS_ABS(v)           _mm512_abs_ps (v)
+#define VS_MADD(a, b, c)    _mm512_fmadd_ps (a, b, c)
+#define VS_HSUM(v)          _mm512_reduce_add_ps (v)
+#define VS_SQRT(v)          _mm512_sqrt_ps (v)
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectorf_kernels, vectorf_avx512)
+
+#define VS(name)            vectord_avx512_##name
+#define VS_T                double
+#define VS_V                __m512d
+#define VS_W                8
+#define VS_TARGET           __attribute__ ((target ("avx512f")))
+#define VS_LOAD(p)          _mm512_loadu_pd (p)
+#define VS_STORE(p, v)      _mm512_storeu_pd (p, v)
+#define VS_SET1(x)          _mm512_set1_pd (x)
+#define VS_ZERO()           _mm512_setzero_pd ()
+#define VS_ADD(a, b)        _mm512_add_pd (a, b)
+#define VS_SUB(a, b)        _mm512_sub_pd (a, b)
+#define VS_MUL(a, b)        _mm512_mul_pd (a, b)
+#define VS_DIV(a, b)        _mm512_div_pd (a, b)
+#define VS_MIN(a, b)        _mm512_min_pd (a, b)
+#define VS_MAX(a, b)        _mm512_max_pd (a, b)
+#define VS_ABS(v)           _mm512_abs_pd (v)
+#define VS_MADD(a, b, c)    _mm512_fmadd_pd (a, b, c)
+#define VS_HSUM(v)          _mm512_reduce_add_pd (v)
+#define VS_SQRT(v)          _mm512_sqrt_pd (v)
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectord_kernels, vectord_avx512)
+
+#endif // VECTOR_HAVE_X86
+
+
+// ---------------------------------------------------------------------------
+// ARM: NEON is always there when the build targets it (arm64, armv7k of
+// watchOS); double lanes and vector sqrt need AArch64
+
+#ifdef VECTOR_HAVE_NEON
+
+static inline float vector_hsum_neon_f32 (float32x4_t v) {
+#ifdef __aarch64__
+    return vaddvq_f32 (v);
+#else
+    float32x2_t s = vadd_f32 (vget_low_f32 (v), vget_high_f32 (v));
+    return vget_lane_f32 (vpadd_f32 (s, s), 0);
+#endif
+}
+
+
+#define VS(name)            vectorf_neon_##name
+#define VS_T                float
+#define VS_V                float32x4_t
+#define VS_W                4
+#define VS_TARGET
+#define VS_LOAD(p)          vld1q_f32 (p)
+#define VS_STORE(p, v)      vst1q_f32 (p, v)
+#define VS_SET1(x)          vdupq_n_f32 (x)
+#define VS_ZERO()           vdupq_n_f32 (0)
+#define VS_ADD(a, b)        vaddq_f32 (a, b)
+#define VS_SUB(a, b)        vsubq_f32 (a, b)
+#define VS_MUL(a, b)        vmulq_f32 (a, b)
+// not vminq/vmaxq, which return NaN for a NaN operand: clamp must give the
+// bound like the reference and x86 minps/maxps
+#define VS_MIN(a, b)        vbslq_f32 (vcltq_f32 (a, b), a, b)
+#define VS_MAX(a, b)        vbslq_f32 (vcgtq_f32 (a, b), a, b)
+#define VS_ABS(v)           vabsq_f32 (v)
+#define VS_MADD(a, b, c)    vmlaq_f32 (c, a, b)
+#define VS_HSUM(v)          vector_hsum_neon_f32 (v)
+#ifdef __aarch64__
+# define VS_DIV(a, b)       vdivq_f32 (a, b)
+# define VS_SQRT(v)         vsqrtq_f32 (v)
+#endif
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectorf_kernels, vectorf_neon)
+
+#ifdef __aarch64__
+#define VS(name)            vectord_neon_##name
+#define VS_T                double
+#define VS_V                float64x2_t
+#define VS_W                2
+#define VS_TARGET
+#define VS_LOAD(p)          vld1q_f64 (p)
+#define VS_STORE(p, v)      vst1q_f64 (p, v)
+#define VS_SET1(x)          vdupq_n_f64 (x)
+#define VS_ZERO()           vdupq_n_f64 (0)
+#define VS_ADD(a, b)        vaddq_f64 (a, b)
+#define VS_SUB(a, b)        vsubq_f64 (a, b)
+#define VS_MUL(a, b)        vmulq_f64 (a, b)
+#define VS_DIV(a, b)        vdivq_f64 (a, b)
+#define VS_MIN(a, b)        vbslq_f64 (vcltq_f64 (a, b), a, b)
+#define VS_MAX(a, b)        vbslq_f64 (vcgtq_f64 (a, b), a, b)
+#define VS_ABS(v)           vabsq_f64 (v)
+#define VS_MADD(a, b, c)    vfmaq_f64 (c, a, b)
+#define VS_HSUM(v)          vaddvq_f64 (v)
+#define VS_SQRT(v)          vsqrtq_f64 (v)
+#include "vector_simd.inc"
+VECTOR_KERNEL_TABLE (vectord_kernels, vectord_neon)
+#endif
+
+#endif // VECTOR_HAVE_NEON
+
+
+// ---------------------------------------------------------------------------
+// Dispatch
+
+static int vector_isa_current = -1; // not yet detected
+
+// Kernel tables of vector_isa_current, read by every vectorf and vectord
+// call (NULL until detected)
+static const vectorf_kernels *vectorf_kernels_current = NULL;
+static const vectord_kernels *vectord_kernels_current = NULL;
+
+
+static bool vector_isa_supported (vector_isa isa) {
+    switch (isa) {
+    case VECTOR_ISA_REFERENCE:
+        return true;
+#ifdef VECTOR_HAVE_X86
+    case VECTOR_ISA_SSE2:
+        return true;
+    case VECTOR_ISA_AVX2:
+        return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+    case VECTOR_ISA_AVX512:
+        return __builtin_cpu_supports ("avx512f");
+#endif
+#ifdef VECTOR_HAVE_NEON
+    case VECTOR_ISA_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+
+vector_isa vector_isa_best (void) {
+    for (int isa = VECTOR_ISA_COUNT - 1; isa > VECTOR_ISA_REFERENCE; isa--)
+        if (vector_isa_supported ((vector_isa) isa))
+            return (vector_isa) isa;
+    return VECTOR_ISA_REFERENCE;
+}
+
+
+// Set instruction set in use and its kernel tables. Tables are static, so a
+// call racing with this one uses either the old or the new set.
+static void vector_isa_install (vector_isa isa) {
+    __atomic_store_n (&vectorf_kernels_current, vectorf_kernels_for (isa), __ATOMIC_RELAXED);
+    __atomic_store_n (&vectord_kernels_current, vectord_kernels_for (isa), __ATOMIC_RELAXED);
+    __atomic_store_n (&vector_isa_current, (int) isa, __ATOMIC_RELAXED);
+}
+
+
+vector_isa vector_isa_active (void) {
+    int isa = __atomic_load_n (&vector_isa_current, __ATOMIC_RELAXED);
+    if (isa < 0) {
+        // detection gives the same answer in every thread
+        isa = (int) vector_isa_best ();
+        vector_isa_install ((vector_isa) isa);
+    }
+    return (vector_isa) isa;
+}
+
+
+bool vector_isa_select (vector_isa isa) {
+    if (isa >= VECTOR_ISA_COUNT || !vector_isa_supported (isa))
+        return false;
+    vector_isa_install (isa);
+    return true;
+}
+
+
+const char *vector_isa_name (vector_isa isa) {
+    static const char *names[VECTOR_ISA_COUNT] = {
+        "reference", "SSE2", "AVX2", "AVX-512", "NEON"
+    };
+    return (isa < VECTOR_ISA_COUNT) ? names[isa] : "unknown";
+}
+
+
+const vectorf_kernels *vectorf_kernels_for (vector_isa isa) {
+    if (!vector_isa_supported (isa))
+        return NULL;
+    switch (isa) {
+#ifdef VECTOR_HAVE_X86
+    case VECTOR_ISA_SSE2:
+        return &vectorf_sse2_kernels;
+    case VECTOR_ISA_AVX2:
+        return &vectorf_avx2_kernels;
+    case VECTOR_ISA_AVX512:
+        return &vectorf_avx512_kernels;
+#endif
+#ifdef VECTOR_HAVE_NEON
+    case VECTOR_ISA_NEON:
+        return &vectorf_neon_kernels;
+#endif
+    default:
+        return &vectorf_reference_kernels;
+    }
+}
+
+
+const vectord_kernels *vectord_kernels_for (vector_isa isa) {
+    if (!vector_isa_supported (isa))
+        return NULL;
+    switch (isa) {
+#ifdef VECTOR_HAVE_X86
+    case VECTOR_ISA_SSE2:
+        return &vectord_sse2_kernels;
+    case VECTOR_ISA_AVX2:
+        return &vectord_avx2_kernels;
+    case VECTOR_ISA_AVX512:
+        return &vectord_avx512_kernels;
+#endif
+#if defined(VECTOR_HAVE_NEON) && defined(__aarch64__)
+    case VECTOR_ISA_NEON:
+        return &vectord_neon_kernels;
+#endif
+    default:
+        return &vectord_reference_kernels;
+    }
+}
+
+
+const vectorf_kernels *vectorf_kernels_active (void) {
+    const vectorf_kernels *kernels = __atomic_load_n (&vectorf_kernels_current, __ATOMIC_RELAXED);
+    if (kernels == NULL) {
+        vector_isa_active ();
+        kernels = __atomic_load_n (&vectorf_kernels_current, __ATOMIC_RELAXED);
+    }
+    return kernels;
+}
+
+
+const vectord_kernels *vectord_kernels_active (void) {
+    const vectord_kernels *kernels = __atomic_load_n (&vectord_kernels_current, __ATOMIC_RELAXED);
+    if (kernels == NULL) {
+        vector_isa_active ();
+        kernels = __atomic_load_n (&vectord_kernels_current, __ATOMIC_RELAXED);
+    }
+    return kernels;
+}
+
+
+// ---------------------------------------------------------------------------
+static double vector_simd_seconds (void) {
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+
+void vector_simd_test (void) {
+    printf ("\n[vector_simd] Test...\n");
+
+    // 1. Parity of every supported instruction set with the reference, for
+    // sizes around the unrolled block and unaligned starts
+    size_t max_size = 300;
+    float *xf = (float *) malloc (sizeof (float) * (max_size + 1));
+    float *yf = (float *) malloc (sizeof (float) * (max_size + 1));
+    float *of = (float *) malloc (sizeof (float) * max_size);
+    float *rf = (float *) malloc (sizeof (float) * max_size);
+    double *xd = (double *) malloc (sizeof (double) * (max_size + 1));
+    double *yd = (double *) malloc (sizeof (double) * (max_size + 1));
+    double *od = (double *) malloc (sizeof (double) * max_size);
+    double *rd = (double *) malloc (sizeof (double) * max_size);
+    assert (xf && yf && of && rf && xd && yd && od && rd);
+    for (size_t i = 0; i <= max_size; i++) {
+        xf[i] = xd[i] = 1 + sinf (0.37f * i);
+        yf[i] = yd[i] = cosf (0.11f * i) - 0.3f;
+    }
+
+    const vectorf_kernels *reff = vectorf_kernels_for (VECTOR_ISA_REFERENCE);
+    const vectord_kernels *refd = vectord_kernels_for (VECTOR_ISA_REFERENCE);
+    for (int isa = 0; isa < VECTOR_ISA_COUNT; isa++) {
+        const vectorf_kernels *kf = vectorf_kernels_for ((vector_isa) isa);
+        const vectord_kernels *kd = vectord_kernels_for ((vector_isa) isa);
+        if (!kf)
+            continue;
+        assert (kd);
+        for (size_t offset = 0; offset < 2; offset++) {
+            for (size_t size = 0; size < max_size; size += (size < 70) ? 1 : 23) {
+                const float *x = xf + offset, *y = yf + offset;
+                // sums of |values| scale the rounding errors
+                float tol = 1e-6f * (reff->sum_squares (x, size) + 2 * size + 1);
+                assert (fabsf (kf->sum (x, size) - reff->sum (x, size)) <= tol);
+                assert (fabsf (kf->sum_squares (x, size) - reff->sum_squares (x, size)) <= tol);
+                assert (fabsf (kf->dot_product (x, y, size) - reff->dot_product (x, y, size)) <= tol);
+                kf->add (x, size, 0.25f, of);
+                reff->add (x, size, 0.25f, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->multiply (x, size, -1.5f, of);
+                reff->multiply (x, size, -1.5f, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->sqrt (x, size, of);
+                reff->sqrt (x, size, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->add_vector (x, y, size, of);
+                reff->add_vector (x, y, size, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->subtract_vector (x, y, size, of);
+                reff->subtract_vector (x, y, size, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->multiply_vector (x, y, size, of);
+                reff->multiply_vector (x, y, size, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->divide_vector (y, x, size, of);
+                reff->divide_vector (y, x, size, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->clamp (y, size, -0.5f, 0.25f, of);
+                reff->clamp (y, size, -0.5f, 0.25f, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                kf->abs (y, size, of);
+                reff->abs (y, size, rf);
+                assert (memcmp (of, rf, sizeof (float) * size) == 0);
+                // fused or not
+                kf->multiply_add (x, y, x, size, of);
+                reff->multiply_add (x, y, x, size, rf);
+                for (size_t i = 0; i < size; i++)
+                    assert (fabsf (of[i] - rf[i]) <= 1e-6f);
+                kf->axpy (x, 0.3f, y, size, of);
+                reff->axpy (x, 0.3f, y, size, rf);
+                for (size_t i = 0; i < size; i++)
+                    assert (fabsf (of[i] - rf[i]) <= 1e-6f);
+
+                const double *u = xd + offset, *v = yd + offset;
+                double told = 1e-14 * (refd->sum_squares (u, size) + 2 * size + 1);
+                assert (fabs (kd->sum (u, size) - refd->sum (u, size)) <= told);
+                assert (fabs (kd->sum_squares (u, size) - refd->sum_squares (u, size)) <= told);
+                assert (fabs (kd->dot_product (u, v, size) - refd->dot_product (u, v, size)) <= told);
+                kd->add (u, size, 0.25, od);
+                refd->add (u, size, 0.25, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->multiply (u, size, -1.5, od);
+                refd->multiply (u, size, -1.5, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->sqrt (u, size, od);
+                refd->sqrt (u, size, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->add_vector (u, v, size, od);
+                refd->add_vector (u, v, size, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->subtract_vector (u, v, size, od);
+                refd->subtract_vector (u, v, size, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->multiply_vector (u, v, size, od);
+                refd->multiply_vector (u, v, size, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->divide_vector (v, u, size, od);
+                refd->divide_vector (v, u, size, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->clamp (v, size, -0.5, 0.25, od);
+                refd->clamp (v, size, -0.5, 0.25, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->abs (v, size, od);
+                refd->abs (v, size, rd);
+                assert (memcmp (od, rd, sizeof (double) * size) == 0);
+                kd->multiply_add (u, v, u, size, od);
+                refd->multiply_add (u, v, u, size, rd);
+                for (size_t i = 0; i < size; i++)
+                    assert (fabs (od[i] - rd[i]) <= 1e-14);
+                kd->axpy (u, 0.3, v, size, od);
+                refd->axpy (u, 0.3, v, size, rd);
+                for (size_t i = 0; i < size; i++)
+                    assert (fabs (od[i] - rd[i]) <= 1e-14);
+            }
+        }
+        // in place
+        memcpy (of, xf, sizeof (float) * max_size);
+        kf->add (of, max_size, 1, of);
+        reff->add (xf, max_size, 1, rf);
+        assert (memcmp (of, rf, sizeof (float) * max_size) == 0);
+
+        // clamp gives the low bound for NaN, like the reference
+        float nanf_values[37];
+        double nand_values[37];
+        for (size_t i = 0; i < 37; i++)
+            nanf_values[i] = nand_values[i] = (i % 3 == 0) ? NAN : yf[i];
+        kf->clamp (nanf_values, 37, -0.5f, 0.25f, of);
+        reff->clamp (nanf_values, 37, -0.5f, 0.25f, rf);
+        assert (memcmp (of, rf, sizeof (float) * 37) == 0);
+        assert (of[0] == -0.5f && of[36] == -0.5f);
+        kd->clamp (nand_values, 37, -0.5, 0.25, od);
+        refd->clamp (nand_values, 37, -0.5, 0.25, rd);
+        assert (memcmp (od, rd, sizeof (double) * 37) == 0);
+        assert (od[0] == -0.5 && od[36] == -0.5);
+    }
+
+    // 2. Strided forms on interleaved xyz against the contiguous ones, and
+    // in place
+    {
+        size_t n = 50;
+        float xyz[150], gain[50], out3[150], axis[50], expected[50];
+        for (size_t i = 0; i < 3 * n; i++)
+            xyz[i] = sinf (0.7f * i) * 2;
+        for (size_t i = 0; i < n; i++)
+            gain[i] = 1 + 0.01f * i;
+        for (size_t c = 0; c < 3; c++) {
+            for (size_t i = 0; i < n; i++)
+                axis[i] = xyz[3 * i + c];
+            vectorf_multiply_vector (axis, gain, n, expected);
+            vectorf_multiply_vector_strided (xyz + c, 3, gain, 1, n, out3 + c, 3);
+            for (size_t i = 0; i < n; i++)
+                assert (out3[3 * i + c] == expected[i]);
+            vectorf_clamp (axis, n, -1, 1, expected);
+            vectorf_clamp_strided (xyz + c, 3, n, -1, 1, out3 + c, 3);
+            for (size_t i = 0; i < n; i++)
+                assert (out3[3 * i + c] == expected[i]);
+            vectorf_axpy (axis, 2, gain, n, expected);
+            vectorf_axpy_strided (xyz + c, 3, 2, gain, 1, n, out3 + c, 3);
+            for (size_t i = 0; i < n; i++)
+                assert (fabsf (out3[3 * i + c] - expected[i]) <= 1e-6f);
+        }
+        vectorf_abs_strided (xyz, 3, n, xyz, 3);
+        for (size_t i = 0; i < n; i++)
+            assert (xyz[3 * i] == fabsf (sinf (0.7f * (3 * i)) * 2) && xyz[3 * i + 1] == sinf (0.7f * (3 * i + 1)) * 2);
+        memcpy (axis, gain, sizeof (axis));
+        vectorf_subtract_vector_inplace (axis, gain, n);
+        vectorf_multiply_add_inplace (axis, gain, gain, n);
+        for (size_t i = 0; i < n; i++)
+            assert (axis[i] == gain[i]);
+        vectorf_divide_vector_inplace (axis, gain, n);
+        assert (vectorf_sum (axis, n) == n);
+    }
+
+    // 3. Selection
+    vector_isa best = vector_isa_best ();
+    assert (vector_isa_active () == best);
+    assert (vector_isa_select (VECTOR_ISA_REFERENCE));
+    assert (vectorf_kernels_active () == reff);
+    assert (!vector_isa_select (VECTOR_ISA_COUNT));
+    assert (vector_isa_select (best));
+
+    // 4. Speed of each active kernel relative to the reference (informative)
+    size_t n = 4096, reps = 2000;
+    float *big = (float *) malloc (sizeof (float) * n);
+    float *big2 = (float *) malloc (sizeof (float) * n);
+    float *big_out = (float *) malloc (sizeof (float) * n);
+    assert (big && big2 && big_out);
+    for (size_t i = 0; i < n; i++) {
+        big[i] = 1.5f + sinf (0.01f * i);  // positive for sqrt and divide
+        big2[i] = cosf (0.01f * i);
+    }
+    const vectorf_kernels *active = vectorf_kernels_active ();
+    printf ("active: %s\n", vector_isa_name (best));
+    const char *names[] = {"sum", "sum_squares", "dot_product", "add", "multiply",
+                           "sqrt", "add_vector", "subtract_vector", "multiply_vector",
+                           "divide_vector", "multiply_add", "axpy", "clamp", "abs"};
+    for (int f = 0; f < (int) (sizeof (names) / sizeof (names[0])); f++) {
+        double elapsed[2];
+        volatile float sink = 0;
+        for (int k = 0; k < 2; k++) {
+            const vectorf_kernels *kernels = (k == 0) ? reff : active;
+            double start = vector_simd_seconds ();
+            for (size_t r = 0; r < reps; r++) {
+                switch (f) {
+                case 0: sink += kernels->sum (big, n); break;
+                case 1: sink += kernels->sum_squares (big, n); break;
+                case 2: sink += kernels->dot_product (big, big2, n); break;
+                case 3: kernels->add (big, n, 1.0f, big_out); break;
+                case 4: kernels->multiply (big, n, 1.0f, big_out); break;
+                case 5: kernels->sqrt (big, n, big_out); break;
+                case 6: kernels->add_vector (big, big2, n, big_out); break;
+                case 7: kernels->subtract_vector (big, big2, n, big_out); break;
+                case 8: kernels->multiply_vector (big, big2, n, big_out); break;
+                case 9: kernels->divide_vector (big2, big, n, big_out); break;
+                case 10: kernels->multiply_add (big, big2, big, n, big_out); break;
+                case 11: kernels->axpy (big, 0.5f, big2, n, big_out); break;
+                case 12: kernels->clamp (big2, n, -0.5f, 0.5f, big_out); break;
+                default: kernels->abs (big2, n, big_out); break;
+                }
+            }
+            elapsed[k] = vector_simd_seconds () - start;
+        }
+        (void) sink;
+        printf ("%s: %.1fx faster\n", names[f], elapsed[0] / (elapsed[1] + 1e-12));
+    }
+
+    free (xf);
+    free (yf);
+    free (of);
+    free (rf);
+    free (xd);
+    free (yd);
+    free (od);
+    free (rd);
+    free (big);
+    free (big2);
+    free (big_out);
+
+    printf ("OK\n");
+}
@@ -0,0 +1,99 @@
+/*  =========================================================================
+    vector_simd - vectorized kernels of vectorf and vectord, selected at
+                  runtime for the instruction sets of the CPU
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __VECTOR_SIMD_H__
+#define __VECTOR_SIMD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum {
+    VECTOR_ISA_REFERENCE = 0, // plain serial loops
+    VECTOR_ISA_SSE2,
+    VECTOR_ISA_AVX2,          // with FMA
+    VECTOR_ISA_AVX512,        // AVX-512F
+    VECTOR_ISA_NEON,
+    VECTOR_ISA_COUNT
+} vector_isa;
+
+typedef struct {
+    float (*sum) (const float *x, size_t size);
+    float (*sum_squares) (const float *x, size_t size);
+    float (*dot_product) (const float *x, const float *y, size_t size);
+    void (*add) (const float *x, size_t size, float value, float *output);
+    void (*multiply) (const float *x, size_t size, float value, float *output);
+    void (*sqrt) (const float *x, size_t size, float *output);
+    void (*add_vector) (const float *x, const float *y, size_t size, float *output);
+    void (*subtract_vector) (const float *x, const float *y, size_t size, float *output);
+    void (*multiply_vector) (const float *x, const float *y, size_t size, float *output);
+    void (*divide_vector) (const float *x, const float *y, size_t size, float *output);
+    void (*multiply_add) (const float *x, const float *y, const float *z, size_t size, float *output);
+    void (*axpy) (const float *x, float value, const float *y, size_t size, float *output);
+    void (*clamp) (const float *x, size_t size, float low, float high, float *output);
+    void (*abs) (const float *x, size_t size, float *output);
+} vectorf_kernels;
+
+typedef struct {
+    double (*sum) (const double *x, size_t size);
+    double (*sum_squares) (const double *x, size_t size);
+    double (*dot_product) (const double *x, const double *y, size_t size);
+    void (*add) (const double *x, size_t size, double value, double *output);
+    void (*multiply) (const double *x, size_t size, double value, double *output);
+    void (*sqrt) (const double *x, size_t size, double *output);
+    void (*add_vector) (const double *x, const double *y, size_t size, double *output);
+    void (*subtract_vector) (const double *x, const double *y, size_t size, double *output);
+    void (*multiply_vector) (const double *x, const double *y, size_t size, double *output);
+    void (*divide_vector) (const double *x, const double *y, size_t size, double *output);
+    void (*multiply_add) (const double *x, const double *y, const double *z, size_t size, double *output);
+    void (*axpy) (const double *x, double value, const double *y, size_t size, double *output);
+    void (*clamp) (const double *x, size_t size, double low, double high, double *output);
+    void (*abs) (const double *x, size_t size, double *output);
+} vectord_kernels;
+
+// Kernels used by vectorf functions. The best instruction set supported by
+// both the build and the CPU is detected on first use (CPUID on x86, NEON
+// is always there when built for it), and the table is cached until
+// vector_isa_select, so each call costs one load.
+const vectorf_kernels *vectorf_kernels_active (void);
+
+// Kernels used by vectord functions
+const vectord_kernels *vectord_kernels_active (void);
+
+// Kernels of given instruction set, NULL if not supported here
+const vectorf_kernels *vectorf_kernels_for (vector_isa isa);
+
+// Kernels of given instruction set, NULL if not supported here
+const vectord_kernels *vectord_kernels_for (vector_isa isa);
+
+// Instruction set in use
+vector_isa vector_isa_active (void);
+
+// Best instruction set supported by build and CPU
+vector_isa vector_isa_best (void);
+
+// Use given instruction set from now on, e.g. VECTOR_ISA_REFERENCE to
+// compare results. Return false (and change nothing) if not supported.
+bool vector_isa_select (vector_isa isa);
+
+// Name of instruction set
+const char *vector_isa_name (vector_isa isa);
+
+// Self test: every supported instruction set against the reference, and
+// speed of the active one
+void vector_simd_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,81 +10,98 @@
 #include <stdbool.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "vectord.h"
+#include "vector_simd.h"
 
 
 double vectord_mean (const double *self, size_t size) {
     assert (self);
-    double sum = 0.0;
-    for (size_t i = 0; i < size; i++)
-        sum += self[i];
-    return sum / size;
+    return vectord_kernels_active ()->sum (self, size) / size;
 }
 
 
 double vectord_sum (const double *self, size_t size) {
     assert (self);
-    double sum = 0.0;
-    for (size_t i = 0; i < size; i++)
-        sum += self[i];
-    return sum;
+    return vectord_kernels_active ()->sum (self, size);
 }
 
 
 double vectord_length (const double *self, size_t size) {
     assert (self);
-    double ss = 0.0;
-    for (size_t i = 0; i < size; i++)
-        ss += self[i] * self[i];
-    return sqrtf (ss);
+    return sqrt (vectord_kernels_active ()->sum_squares (self, size));
 }
 
 
 double vectord_power (const double *self, size_t size) {
     assert (self);
-    double ss = 0.0;
-    for (size_t i = 0; i < size; i++)
-        ss += self[i] * self[i];
-    return ss;
+    return vectord_kernels_active ()->sum_squares (self, size);
 }
 
 
 void vectord_sqrt (const double *self, size_t size, double *output) {
     assert (self);
     assert (output);
-    for (size_t i = 0; i < size; i++)
-        output[i] = sqrt(self[i]);
+    vectord_kernels_active ()->sqrt (self, size, output);
+}
+
+
+void vectord_log_fast (const double *self, size_t size, double *output) {
+    assert (self);
+    assert (output);
+    for (size_t i = 0; i < size; i++) {
+        // split x = m * 2^e with m in [sqrt(0.5), sqrt(2))
+        uint64_t bits;
+        memcpy (&bits, &self[i], sizeof (bits));
+        bits += 0x3ff0000000000000ULL - 0x3fe6a09e667f3bcdULL;
+        double e = (double) ((int64_t) (bits >> 52) - 0x3ff);
+        bits = (bits & 0x000fffffffffffffULL) + 0x3fe6a09e667f3bcdULL;
+        double m;
+        memcpy (&m, &bits, sizeof (m));
+
+        // log(1+f) by Cephes polynomial
+        double f = m - 1.0;
+        double z = f * f;
+        double y = 7.0376836292E-2;
+        y = y * f - 1.1514610310E-1;
+        y = y * f + 1.1676998740E-1;
+        y = y * f - 1.2420140846E-1;
+        y = y * f + 1.4249322787E-1;
+        y = y * f - 1.6668057665E-1;
+        y = y * f + 2.0000714765E-1;
+        y = y * f - 2.4999993993E-1;
+        y = y * f + 3.3333331174E-1;
+        y = y * f * z - 0.5 * z;
+        output[i] = f + y + e * 0.693147180559945309;
+    }
 }
 
 
 void vectord_add (const double *self, size_t size, double value, double *output) {
     assert (self);
     assert (output);
-    for (size_t i = 0; i < size; i++)
-        output[i] = self[i] + value;
+    vectord_kernels_active ()->add (self, size, value, output);
 }
 
 
 void vectord_add_inplace (double *self, size_t size, double value) {
     assert (self);
-    for (size_t i = 0; i < size; i++)
-        self[i] += value;
+    vectord_kernels_active ()->add (self, size, value, self);
 }
 
 
 void vectord_multiply (const double *self, size_t size, double value, double *output) {
     assert (self);
     assert (output);
-    for (size_t i = 0; i < size; i++)
-        output[i] = self[i] * value;
+    vectord_kernels_active ()->multiply (self, size, value, output);
 }
 
 
 void vectord_multiply_inplace (double *self, size_t size, double value) {
     assert (self);
-    for (size_t i = 0; i < size; i++)
-        self[i] *= value;
+    vectord_kernels_active ()->multiply (self, size, value, self);
 }
 
 
@@ -92,16 +109,14 @@ void vectord_remove_mean (const double *self, size_t size, double *output) {
     assert (self);
     assert (output);
     double mean = vectord_mean (self, size);
-    for (size_t i = 0; i < size; i++)
-        output[i] = self[i] - mean;
+    vectord_kernels_active ()->add (self, size, -mean, output);
 }
 
 
 void vectord_remove_mean_inplace (double *self, size_t size) {
     assert (self);
     double mean = vectord_mean (self, size);
-    for (size_t i = 0; i < size; i++)
-        self[i] -= mean;
+    vectord_kernels_active ()->add (self, size, -mean, self);
 }
 
 
@@ -115,15 +130,9 @@ void vectord_normalize_to_unit_length (const double *self,
     if (remove_mean) {
         vectord_remove_mean (self, size, output);
 
-        double length = 0.0;
-        for (size_t i = 0; i < size; i++)
-            length += output[i] * output[i];
-        length = sqrt (length);
-
-        if (length > 0) {
-            for (size_t i = 0; i < size; i++)
-                output[i] /= length;
-        }
+        double length = vectord_length (output, size);
+        if (length > 0)
+            vectord_multiply_inplace (output, size, 1/length);
     }
     else {
         double length = vectord_length (self, size);
@@ -150,8 +159,292 @@ void vectord_normalize_to_unit_length_inplace (double *self,
 double vectord_dot_product (const double *self, const double *vector2, size_t size) {
     assert (self);
     assert (vector2);
-    double result = 0.0;
+    return vectord_kernels_active ()->dot_product (self, vector2, size);
+}
+
+
+void vectord_add_vector (const double *self, const double *vector2, size_t size, double *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectord_kernels_active ()->add_vector (self, vector2, size, output);
+}
+
+
+void vectord_add_vector_inplace (double *self, const double *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectord_kernels_active ()->add_vector (self, vector2, size, self);
+}
+
+
+void vectord_add_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                 size_t size, double *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectord_kernels_active ()->add_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] + vector2[i * stride2];
+    }
+}
+
+
+void vectord_subtract_vector (const double *self, const double *vector2, size_t size, double *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectord_kernels_active ()->subtract_vector (self, vector2, size, output);
+}
+
+
+void vectord_subtract_vector_inplace (double *self, const double *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectord_kernels_active ()->subtract_vector (self, vector2, size, self);
+}
+
+
+void vectord_subtract_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                      size_t size, double *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectord_kernels_active ()->subtract_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] - vector2[i * stride2];
+    }
+}
+
+
+void vectord_multiply_vector (const double *self, const double *vector2, size_t size, double *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectord_kernels_active ()->multiply_vector (self, vector2, size, output);
+}
+
+
+void vectord_multiply_vector_inplace (double *self, const double *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectord_kernels_active ()->multiply_vector (self, vector2, size, self);
+}
+
+
+void vectord_multiply_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                      size_t size, double *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectord_kernels_active ()->multiply_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] * vector2[i * stride2];
+    }
+}
+
+
+void vectord_divide_vector (const double *self, const double *vector2, size_t size, double *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectord_kernels_active ()->divide_vector (self, vector2, size, output);
+}
+
+
+void vectord_divide_vector_inplace (double *self, const double *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectord_kernels_active ()->divide_vector (self, vector2, size, self);
+}
+
+
+void vectord_divide_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                    size_t size, double *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectord_kernels_active ()->divide_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] / vector2[i * stride2];
+    }
+}
+
+
+void vectord_multiply_add (const double *self, const double *vector2, const double *vector3, size_t size, double *output) {
+    assert (self);
+    assert (vector2);
+    assert (vector3);
+    assert (output);
+    vectord_kernels_active ()->multiply_add (self, vector2, vector3, size, output);
+}
+
+
+void vectord_multiply_add_inplace (double *self, const double *vector2, const double *vector3, size_t size) {
+    assert (self);
+    assert (vector2);
+    assert (vector3);
+    vectord_kernels_active ()->multiply_add (self, vector2, vector3, size, self);
+}
+
+
+void vectord_multiply_add_strided (const double *self, size_t stride,
+                                   const double *vector2, size_t stride2,
+                                   const double *vector3, size_t stride3,
+                                   size_t size, double *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (vector3);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && stride3 == 1 && output_stride == 1)
+        vectord_kernels_active ()->multiply_add (self, vector2, vector3, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] * vector2[i * stride2] + vector3[i * stride3];
+    }
+}
+
+
+void vectord_axpy (const double *self, double value, const double *vector2, size_t size, double *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectord_kernels_active ()->axpy (self, value, vector2, size, output);
+}
+
+
+void vectord_axpy_inplace (double *self, double value, const double *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectord_kernels_active ()->axpy (self, value, vector2, size, self);
+}
+
+
+void vectord_axpy_strided (const double *self, size_t stride, double value, const double *vector2, size_t stride2,
+                           size_t size, double *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectord_kernels_active ()->axpy (self, value, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = value * vector2[i * stride2] + self[i * stride];
+    }
+}
+
+
+void vectord_clamp (const double *self, size_t size, double low, double high, double *output) {
+    assert (self);
+    assert (output);
+    assert (low <= high);
+    vectord_kernels_active ()->clamp (self, size, low, high, output);
+}
+
+
+void vectord_clamp_inplace (double *self, size_t size, double low, double high) {
+    assert (self);
+    assert (low <= high);
+    vectord_kernels_active ()->clamp (self, size, low, high, self);
+}
+
+
+void vectord_clamp_strided (const double *self, size_t stride, size_t size, double low, double high,
+                            double *output, size_t output_stride) {
+    assert (self);
+    assert (output);
+    assert (low <= high);
+    if (stride == 1 && output_stride == 1)
+        vectord_kernels_active ()->clamp (self, size, low, high, output);
+    else {
+        for (size_t i = 0; i < size; i++) {
+            double v = (self[i * stride] > low) ? self[i * stride] : low;
+            output[i * output_stride] = (v < high) ? v : high;
+        }
+    }
+}
+
+
+void vectord_abs (const double *self, size_t size, double *output) {
+    assert (self);
+    assert (output);
+    vectord_kernels_active ()->abs (self, size, output);
+}
+
+
+void vectord_abs_inplace (double *self, size_t size) {
+    assert (self);
+    vectord_kernels_active ()->abs (self, size, self);
+}
+
+
+void vectord_abs_strided (const double *self, size_t stride, size_t size, double *output, size_t output_stride) {
+    assert (self);
+    assert (output);
+    if (stride == 1 && output_stride == 1)
+        vectord_kernels_active ()->abs (self, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = fabs (self[i * stride]);
+    }
+}
+
+
+void vectord_magnitude3 (const double *x, const double *y, const double *z, size_t size, double *output) {
+    assert (x);
+    assert (y);
+    assert (z);
+    assert (output);
+    for (size_t i = 0; i < size; i++)
+        output[i] = sqrt (x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+}
+
+
+void vectord_magnitude3_interleaved (const double *xyz, size_t size, double *output) {
+    assert (xyz);
+    assert (output);
+    for (size_t i = 0; i < size; i++) {
+        const double *v = xyz + 3 * i;
+        output[i] = sqrt (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+}
+
+
+// s / sqrt(s) with the reciprocal square root by bit trick (0 for s = 0)
+static inline double vectord_sqrt_fast (double s) {
+    uint64_t bits;
+    memcpy (&bits, &s, sizeof (bits));
+    bits = 0x5fe6eb50c7b537a9ULL - (bits >> 1);
+    double r;
+    memcpy (&r, &bits, sizeof (r));
+    r = r * (1.5 - 0.5 * s * r * r);
+    return s * r;
+}
+
+
+void vectord_magnitude3_fast (const double *x, const double *y, const double *z, size_t size, double *output) {
+    assert (x);
+    assert (y);
+    assert (z);
+    assert (output);
     for (size_t i = 0; i < size; i++)
-        result += self[i] * vector2[i];
-    return result;
+        output[i] = vectord_sqrt_fast (x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+}
+
+
+void vectord_magnitude3_interleaved_fast (const double *xyz, size_t size, double *output) {
+    assert (xyz);
+    assert (output);
+    for (size_t i = 0; i < size; i++) {
+        const double *v = xyz + 3 * i;
+        output[i] = vectord_sqrt_fast (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
 }
@@ -30,6 +30,10 @@ double vectord_power (const double *self, size_t size);
 // Sqrt
 void vectord_sqrt (const double *self, size_t size, double *output);
     
+// Natural logarithm (fast, branchless approximation for positive normal
+// numbers, about single precision accurate).
+void vectord_log_fast (const double *self, size_t size, double *output);
+
 // Add value
 // Return results in param output.
 void vectord_add (const double *self, size_t size, double value, double *output);
@@ -61,6 +65,82 @@ void vectord_normalize_to_unit_length_inplace (double *self, size_t size, bool r
 // Dot product with vectord which size is same with buffer
 double vectord_dot_product (const double *self, const double *vector2, size_t size);
 
+// Magnitude sqrt(x^2+y^2+z^2) of 3-axis samples stored as separate arrays
+// (structure of arrays).
+// Return results in param output (size points).
+void vectord_magnitude3 (const double *x, const double *y, const double *z, size_t size, double *output);
+
+// Magnitude of 3-axis samples stored interleaved as x0 y0 z0 x1 y1 z1 ...
+// (array of structures, size samples).
+// Return results in param output (size points).
+void vectord_magnitude3_interleaved (const double *xyz, size_t size, double *output);
+
+// Same as vectord_magnitude3 by fast reciprocal square root (bit trick and
+// one Newton step), relative error below 2e-3, without sqrt and division
+void vectord_magnitude3_fast (const double *x, const double *y, const double *z, size_t size, double *output);
+
+// Same as vectord_magnitude3_interleaved by fast reciprocal square root
+void vectord_magnitude3_interleaved_fast (const double *xyz, size_t size, double *output);
+
+
+// Element-wise operations between vectors of the same size.
+// Return results in param output, which may be any of the inputs. The
+// _inplace forms write into self.
+// The _strided forms read point i of each vector at i * its stride (and
+// write output at i * output_stride), so they work on one axis of
+// interleaved xyz data (stride 3) without copying it out; in place with
+// output = self and output_stride = stride. Unit strides run as the
+// contiguous forms, other strides are plain loops.
+
+// self + vector2
+void vectord_add_vector (const double *self, const double *vector2, size_t size, double *output);
+void vectord_add_vector_inplace (double *self, const double *vector2, size_t size);
+void vectord_add_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                 size_t size, double *output, size_t output_stride);
+
+// self - vector2
+void vectord_subtract_vector (const double *self, const double *vector2, size_t size, double *output);
+void vectord_subtract_vector_inplace (double *self, const double *vector2, size_t size);
+void vectord_subtract_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                      size_t size, double *output, size_t output_stride);
+
+// self * vector2
+void vectord_multiply_vector (const double *self, const double *vector2, size_t size, double *output);
+void vectord_multiply_vector_inplace (double *self, const double *vector2, size_t size);
+void vectord_multiply_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                      size_t size, double *output, size_t output_stride);
+
+// self / vector2
+void vectord_divide_vector (const double *self, const double *vector2, size_t size, double *output);
+void vectord_divide_vector_inplace (double *self, const double *vector2, size_t size);
+void vectord_divide_vector_strided (const double *self, size_t stride, const double *vector2, size_t stride2,
+                                    size_t size, double *output, size_t output_stride);
+
+// self * vector2 + vector3 (fused, with one rounding, where the CPU has FMA)
+void vectord_multiply_add (const double *self, const double *vector2, const double *vector3, size_t size, double *output);
+void vectord_multiply_add_inplace (double *self, const double *vector2, const double *vector3, size_t size);
+void vectord_multiply_add_strided (const double *self, size_t stride,
+                                   const double *vector2, size_t stride2,
+                                   const double *vector3, size_t stride3,
+                                   size_t size, double *output, size_t output_stride);
+
+// self + value * vector2 (axpy of BLAS, fused where the CPU has FMA)
+void vectord_axpy (const double *self, double value, const double *vector2, size_t size, double *output);
+void vectord_axpy_inplace (double *self, double value, const double *vector2, size_t size);
+void vectord_axpy_strided (const double *self, size_t stride, double value, const double *vector2, size_t stride2,
+                           size_t size, double *output, size_t output_stride);
+
+// Limit values to [low, high] (low for NaN)
+void vectord_clamp (const double *self, size_t size, double low, double high, double *output);
+void vectord_clamp_inplace (double *self, size_t size, double low, double high);
+void vectord_clamp_strided (const double *self, size_t stride, size_t size, double low, double high,
+                            double *output, size_t output_stride);
+
+// Absolute value
+void vectord_abs (const double *self, size_t size, double *output);
+void vectord_abs_inplace (double *self, size_t size);
+void vectord_abs_strided (const double *self, size_t stride, size_t size, double *output, size_t output_stride);
+
 
 #ifdef __cplusplus
 }
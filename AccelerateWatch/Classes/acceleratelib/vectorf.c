@@ -10,81 +10,98 @@
 #include <stdbool.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "vectorf.h"
+#include "vector_simd.h"
 
 
 float vectorf_mean (const float *self, size_t size) {
     assert (self);
-    float sum = 0.0;
-    for (size_t i = 0; i < size; i++)
-        sum += self[i];
-    return sum / size;
+    return vectorf_kernels_active ()->sum (self, size) / size;
 }
 
 
 float vectorf_sum (const float *self, size_t size) {
     assert (self);
-    float sum = 0.0;
-    for (size_t i = 0; i < size; i++)
-        sum += self[i];
-    return sum;
+    return vectorf_kernels_active ()->sum (self, size);
 }
 
 
 float vectorf_length (const float *self, size_t size) {
     assert (self);
-    float ss = 0.0;
-    for (size_t i = 0; i < size; i++)
-        ss += self[i] * self[i];
-    return sqrtf (ss);
+    return sqrtf (vectorf_kernels_active ()->sum_squares (self, size));
 }
 
 
 float vectorf_power (const float *self, size_t size) {
     assert (self);
-    float ss = 0.0;
-    for (size_t i = 0; i < size; i++)
-        ss += self[i] * self[i];
-    return ss;
+    return vectorf_kernels_active ()->sum_squares (self, size);
 }
 
 
 void vectorf_sqrt (const float *self, size_t size, float *output) {
     assert (self);
     assert (output);
-    for (size_t i = 0; i < size; i++)
-        output[i] = sqrtf(self[i]);
+    vectorf_kernels_active ()->sqrt (self, size, output);
+}
+
+
+void vectorf_log_fast (const float *self, size_t size, float *output) {
+    assert (self);
+    assert (output);
+    for (size_t i = 0; i < size; i++) {
+        // split x = m * 2^e with m in [sqrt(0.5), sqrt(2))
+        uint32_t bits;
+        memcpy (&bits, &self[i], sizeof (bits));
+        bits += 0x3f800000 - 0x3f3504f3;
+        float e = (float) ((int32_t) (bits >> 23) - 0x7f);
+        bits = (bits & 0x007fffff) + 0x3f3504f3;
+        float m;
+        memcpy (&m, &bits, sizeof (m));
+
+        // log(1+f) by Cephes polynomial
+        float f = m - 1.0f;
+        float z = f * f;
+        float y = 7.0376836292E-2f;
+        y = y * f - 1.1514610310E-1f;
+        y = y * f + 1.1676998740E-1f;
+        y = y * f - 1.2420140846E-1f;
+        y = y * f + 1.4249322787E-1f;
+        y = y * f - 1.6668057665E-1f;
+        y = y * f + 2.0000714765E-1f;
+        y = y * f - 2.4999993993E-1f;
+        y = y * f + 3.3333331174E-1f;
+        y = y * f * z - 0.5f * z;
+        output[i] = f + y + e * 0.693147180559945f;
+    }
 }
 
 
 void vectorf_add (const float *self, size_t size, float value, float *output) {
     assert (self);
     assert (output);
-    for (size_t i = 0; i < size; i++)
-        output[i] = self[i] + value;
+    vectorf_kernels_active ()->add (self, size, value, output);
 }
 
 
 void vectorf_add_inplace (float *self, size_t size, float value) {
     assert (self);
-    for (size_t i = 0; i < size; i++)
-        self[i] += value;
+    vectorf_kernels_active ()->add (self, size, value, self);
 }
 
 
 void vectorf_multiply (const float *self, size_t size, float value, float *output) {
     assert (self);
     assert (output);
-    for (size_t i = 0; i < size; i++)
-        output[i] = self[i] * value;
+    vectorf_kernels_active ()->multiply (self, size, value, output);
 }
 
 
 void vectorf_multiply_inplace (float *self, size_t size, float value) {
     assert (self);
-    for (size_t i = 0; i < size; i++)
-        self[i] *= value;
+    vectorf_kernels_active ()->multiply (self, size, value, self);
 }
 
 
@@ -92,16 +109,14 @@ void vectorf_remove_mean (const float *self, size_t size, float *output) {
     assert (self);
     assert (output);
     float mean = vectorf_mean (self, size);
-    for (size_t i = 0; i < size; i++)
-        output[i] = self[i] - mean;
+    vectorf_kernels_active ()->add (self, size, -mean, output);
 }
 
 
 void vectorf_remove_mean_inplace (float *self, size_t size) {
     assert (self);
     float mean = vectorf_mean (self, size);
-    for (size_t i = 0; i < size; i++)
-        self[i] -= mean;
+    vectorf_kernels_active ()->add (self, size, -mean, self);
 }
 
 
@@ -115,15 +130,9 @@ void vectorf_normalize_to_unit_length (const float *self,
     if (remove_mean) {
         vectorf_remove_mean (self, size, output);
 
-        float length = 0.0;
-        for (size_t i = 0; i < size; i++)
-            length += output[i] * output[i];
-        length = sqrt (length);
-        
-        if (length > 0) {
-            for (size_t i = 0; i < size; i++)
-                output[i] /= length;
-        }
+        float length = vectorf_length (output, size);
+        if (length > 0)
+            vectorf_multiply_inplace (output, size, 1/length);
     }
     else {
         float length = vectorf_length (self, size);
@@ -150,9 +159,292 @@ void vectorf_normalize_to_unit_length_inplace (float *self,
 float vectorf_dot_product (const float *self, const float *vector2, size_t size) {
     assert (self);
     assert (vector2);
-    float result = 0.0;
+    return vectorf_kernels_active ()->dot_product (self, vector2, size);
+}
+
+
+void vectorf_add_vector (const float *self, const float *vector2, size_t size, float *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectorf_kernels_active ()->add_vector (self, vector2, size, output);
+}
+
+
+void vectorf_add_vector_inplace (float *self, const float *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectorf_kernels_active ()->add_vector (self, vector2, size, self);
+}
+
+
+void vectorf_add_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                 size_t size, float *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectorf_kernels_active ()->add_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] + vector2[i * stride2];
+    }
+}
+
+
+void vectorf_subtract_vector (const float *self, const float *vector2, size_t size, float *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectorf_kernels_active ()->subtract_vector (self, vector2, size, output);
+}
+
+
+void vectorf_subtract_vector_inplace (float *self, const float *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectorf_kernels_active ()->subtract_vector (self, vector2, size, self);
+}
+
+
+void vectorf_subtract_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                      size_t size, float *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectorf_kernels_active ()->subtract_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] - vector2[i * stride2];
+    }
+}
+
+
+void vectorf_multiply_vector (const float *self, const float *vector2, size_t size, float *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectorf_kernels_active ()->multiply_vector (self, vector2, size, output);
+}
+
+
+void vectorf_multiply_vector_inplace (float *self, const float *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectorf_kernels_active ()->multiply_vector (self, vector2, size, self);
+}
+
+
+void vectorf_multiply_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                      size_t size, float *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectorf_kernels_active ()->multiply_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] * vector2[i * stride2];
+    }
+}
+
+
+void vectorf_divide_vector (const float *self, const float *vector2, size_t size, float *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectorf_kernels_active ()->divide_vector (self, vector2, size, output);
+}
+
+
+void vectorf_divide_vector_inplace (float *self, const float *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectorf_kernels_active ()->divide_vector (self, vector2, size, self);
+}
+
+
+void vectorf_divide_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                    size_t size, float *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectorf_kernels_active ()->divide_vector (self, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] / vector2[i * stride2];
+    }
+}
+
+
+void vectorf_multiply_add (const float *self, const float *vector2, const float *vector3, size_t size, float *output) {
+    assert (self);
+    assert (vector2);
+    assert (vector3);
+    assert (output);
+    vectorf_kernels_active ()->multiply_add (self, vector2, vector3, size, output);
+}
+
+
+void vectorf_multiply_add_inplace (float *self, const float *vector2, const float *vector3, size_t size) {
+    assert (self);
+    assert (vector2);
+    assert (vector3);
+    vectorf_kernels_active ()->multiply_add (self, vector2, vector3, size, self);
+}
+
+
+void vectorf_multiply_add_strided (const float *self, size_t stride,
+                                   const float *vector2, size_t stride2,
+                                   const float *vector3, size_t stride3,
+                                   size_t size, float *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (vector3);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && stride3 == 1 && output_stride == 1)
+        vectorf_kernels_active ()->multiply_add (self, vector2, vector3, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = self[i * stride] * vector2[i * stride2] + vector3[i * stride3];
+    }
+}
+
+
+void vectorf_axpy (const float *self, float value, const float *vector2, size_t size, float *output) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    vectorf_kernels_active ()->axpy (self, value, vector2, size, output);
+}
+
+
+void vectorf_axpy_inplace (float *self, float value, const float *vector2, size_t size) {
+    assert (self);
+    assert (vector2);
+    vectorf_kernels_active ()->axpy (self, value, vector2, size, self);
+}
+
+
+void vectorf_axpy_strided (const float *self, size_t stride, float value, const float *vector2, size_t stride2,
+                           size_t size, float *output, size_t output_stride) {
+    assert (self);
+    assert (vector2);
+    assert (output);
+    if (stride == 1 && stride2 == 1 && output_stride == 1)
+        vectorf_kernels_active ()->axpy (self, value, vector2, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = value * vector2[i * stride2] + self[i * stride];
+    }
+}
+
+
+void vectorf_clamp (const float *self, size_t size, float low, float high, float *output) {
+    assert (self);
+    assert (output);
+    assert (low <= high);
+    vectorf_kernels_active ()->clamp (self, size, low, high, output);
+}
+
+
+void vectorf_clamp_inplace (float *self, size_t size, float low, float high) {
+    assert (self);
+    assert (low <= high);
+    vectorf_kernels_active ()->clamp (self, size, low, high, self);
+}
+
+
+void vectorf_clamp_strided (const float *self, size_t stride, size_t size, float low, float high,
+                            float *output, size_t output_stride) {
+    assert (self);
+    assert (output);
+    assert (low <= high);
+    if (stride == 1 && output_stride == 1)
+        vectorf_kernels_active ()->clamp (self, size, low, high, output);
+    else {
+        for (size_t i = 0; i < size; i++) {
+            float v = (self[i * stride] > low) ? self[i * stride] : low;
+            output[i * output_stride] = (v < high) ? v : high;
+        }
+    }
+}
+
+
+void vectorf_abs (const float *self, size_t size, float *output) {
+    assert (self);
+    assert (output);
+    vectorf_kernels_active ()->abs (self, size, output);
+}
+
+
+void vectorf_abs_inplace (float *self, size_t size) {
+    assert (self);
+    vectorf_kernels_active ()->abs (self, size, self);
+}
+
+
+void vectorf_abs_strided (const float *self, size_t stride, size_t size, float *output, size_t output_stride) {
+    assert (self);
+    assert (output);
+    if (stride == 1 && output_stride == 1)
+        vectorf_kernels_active ()->abs (self, size, output);
+    else {
+        for (size_t i = 0; i < size; i++)
+            output[i * output_stride] = fabsf (self[i * stride]);
+    }
+}
+
+
+void vectorf_magnitude3 (const float *x, const float *y, const float *z, size_t size, float *output) {
+    assert (x);
+    assert (y);
+    assert (z);
+    assert (output);
+    for (size_t i = 0; i < size; i++)
+        output[i] = sqrtf (x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+}
+
+
+void vectorf_magnitude3_interleaved (const float *xyz, size_t size, float *output) {
+    assert (xyz);
+    assert (output);
+    for (size_t i = 0; i < size; i++) {
+        const float *v = xyz + 3 * i;
+        output[i] = sqrtf (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+}
+
+
+// s / sqrt(s) with the reciprocal square root by bit trick (0 for s = 0)
+static inline float vectorf_sqrt_fast (float s) {
+    uint32_t bits;
+    memcpy (&bits, &s, sizeof (bits));
+    bits = 0x5f375a86u - (bits >> 1);
+    float r;
+    memcpy (&r, &bits, sizeof (r));
+    r = r * (1.5f - 0.5f * s * r * r);
+    return s * r;
+}
+
+
+void vectorf_magnitude3_fast (const float *x, const float *y, const float *z, size_t size, float *output) {
+    assert (x);
+    assert (y);
+    assert (z);
+    assert (output);
     for (size_t i = 0; i < size; i++)
-        result += self[i] * vector2[i];
-    return result;
+        output[i] = vectorf_sqrt_fast (x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
 }
 
+
+void vectorf_magnitude3_interleaved_fast (const float *xyz, size_t size, float *output) {
+    assert (xyz);
+    assert (output);
+    for (size_t i = 0; i < size; i++) {
+        const float *v = xyz + 3 * i;
+        output[i] = vectorf_sqrt_fast (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+}
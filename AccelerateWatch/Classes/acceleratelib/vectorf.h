@@ -30,6 +30,10 @@ float vectorf_power (const float *self, size_t size);
 // Sqrt
 void vectorf_sqrt (const float *self, size_t size, float *output);
 
+// Natural logarithm (fast, branchless approximation for positive normal
+// numbers, about single precision accurate).
+void vectorf_log_fast (const float *self, size_t size, float *output);
+
 // Add value
 // Return results in param output.
 void vectorf_add (const float *self, size_t size, float value, float *output);
@@ -61,6 +65,82 @@ void vectorf_normalize_to_unit_length_inplace (float *self, size_t size, bool re
 // Dot product with another vector which size is same with vector
 float vectorf_dot_product (const float *self, const float *vector2, size_t size);
 
+// Magnitude sqrt(x^2+y^2+z^2) of 3-axis samples stored as separate arrays
+// (structure of arrays).
+// Return results in param output (size points).
+void vectorf_magnitude3 (const float *x, const float *y, const float *z, size_t size, float *output);
+
+// Magnitude of 3-axis samples stored interleaved as x0 y0 z0 x1 y1 z1 ...
+// (array of structures, size samples).
+// Return results in param output (size points).
+void vectorf_magnitude3_interleaved (const float *xyz, size_t size, float *output);
+
+// Same as vectorf_magnitude3 by fast reciprocal square root (bit trick and
+// one Newton step), relative error below 2e-3, without sqrt and division
+void vectorf_magnitude3_fast (const float *x, const float *y, const float *z, size_t size, float *output);
+
+// Same as vectorf_magnitude3_interleaved by fast reciprocal square root
+void vectorf_magnitude3_interleaved_fast (const float *xyz, size_t size, float *output);
+
+
+// Element-wise operations between vectors of the same size.
+// Return results in param output, which may be any of the inputs. The
+// _inplace forms write into self.
+// The _strided forms read point i of each vector at i * its stride (and
+// write output at i * output_stride), so they work on one axis of
+// interleaved xyz data (stride 3) without copying it out; in place with
+// output = self and output_stride = stride. Unit strides run as the
+// contiguous forms, other strides are plain loops.
+
+// self + vector2
+void vectorf_add_vector (const float *self, const float *vector2, size_t size, float *output);
+void vectorf_add_vector_inplace (float *self, const float *vector2, size_t size);
+void vectorf_add_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                 size_t size, float *output, size_t output_stride);
+
+// self - vector2
+void vectorf_subtract_vector (const float *self, const float *vector2, size_t size, float *output);
+void vectorf_subtract_vector_inplace (float *self, const float *vector2, size_t size);
+void vectorf_subtract_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                      size_t size, float *output, size_t output_stride);
+
+// self * vector2
+void vectorf_multiply_vector (const float *self, const float *vector2, size_t size, float *output);
+void vectorf_multiply_vector_inplace (float *self, const float *vector2, size_t size);
+void vectorf_multiply_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                      size_t size, float *output, size_t output_stride);
+
+// self / vector2
+void vectorf_divide_vector (const float *self, const float *vector2, size_t size, float *output);
+void vectorf_divide_vector_inplace (float *self, const float *vector2, size_t size);
+void vectorf_divide_vector_strided (const float *self, size_t stride, const float *vector2, size_t stride2,
+                                    size_t size, float *output, size_t output_stride);
+
+// self * vector2 + vector3 (fused, with one rounding, where the CPU has FMA)
+void vectorf_multiply_add (const float *self, const float *vector2, const float *vector3, size_t size, float *output);
+void vectorf_multiply_add_inplace (float *self, const float *vector2, const float *vector3, size_t size);
+void vectorf_multiply_add_strided (const float *self, size_t stride,
+                                   const float *vector2, size_t stride2,
+                                   const float *vector3, size_t stride3,
+                                   size_t size, float *output, size_t output_stride);
+
+// self + value * vector2 (axpy of BLAS, fused where the CPU has FMA)
+void vectorf_axpy (const float *self, float value, const float *vector2, size_t size, float *output);
+void vectorf_axpy_inplace (float *self, float value, const float *vector2, size_t size);
+void vectorf_axpy_strided (const float *self, size_t stride, float value, const float *vector2, size_t stride2,
+                           size_t size, float *output, size_t output_stride);
+
+// Limit values to [low, high] (low for NaN)
+void vectorf_clamp (const float *self, size_t size, float low, float high, float *output);
+void vectorf_clamp_inplace (float *self, size_t size, float low, float high);
+void vectorf_clamp_strided (const float *self, size_t stride, size_t size, float low, float high,
+                            float *output, size_t output_stride);
+
+// Absolute value
+void vectorf_abs (const float *self, size_t size, float *output);
+void vectorf_abs_inplace (float *self, size_t size);
+void vectorf_abs_strided (const float *self, size_t stride, size_t size, float *output, size_t output_stride);
+
 
 #ifdef __cplusplus
 }
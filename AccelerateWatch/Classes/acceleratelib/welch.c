@@ -0,0 +1,206 @@
+/*  =========================================================================
+    welch - streaming Welch power spectral density estimator
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "welch.h"
+#include "dsbuffer.h"
+
+
+struct _welch_t {
+    dsbuffer_t *buffer; // latest segment_size samples
+    size_t segment_size;
+    size_t hop_size;
+    size_t num_bins;
+    float fs;
+    float alpha;
+    float scale; // periodogram -> one-sided PSD
+    size_t countdown; // samples to push before next segment
+
+    dsbuffer_complex *spectrum; // FFT output of current segment
+    float *psd; // running average
+    size_t num_segments;
+};
+
+
+// Transform latest segment and fold it into the average
+static void welch_add_segment (welch_t *self) {
+    dsbuffer_fftr (self->buffer, self->spectrum);
+    self->num_segments++;
+
+    // running mean for equal weights, otherwise exponential decay. The first
+    // segment initializes the average in both cases.
+    float weight = (self->alpha > 0 && self->num_segments > 1) ?
+                   self->alpha : 1.0f / self->num_segments;
+
+    for (size_t k = 0; k < self->num_bins; k++) {
+        float re = self->spectrum[k].real, im = self->spectrum[k].imag;
+        float p = (re * re + im * im) * self->scale;
+        if (k > 0 && k < self->num_bins - 1)
+            p *= 2; // one-sided
+        self->psd[k] += weight * (p - self->psd[k]);
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+welch_t *welch_new (size_t segment_size,
+                    size_t overlap,
+                    window_type window,
+                    float window_param,
+                    float fs,
+                    float alpha) {
+    if (segment_size % 2 == 1) {
+        printf ("ERROR: segment size must be even.\n");
+        return NULL;
+    }
+    assert (overlap < segment_size);
+    assert (fs > 0);
+    assert (alpha >= 0 && alpha <= 1);
+
+    welch_t *self = (welch_t *) malloc (sizeof (welch_t));
+    assert (self);
+
+    self->buffer = dsbuffer_new (segment_size, true);
+    assert (self->buffer);
+    dsbuffer_setup_window (self->buffer, window, window_param);
+
+    self->segment_size = segment_size;
+    self->hop_size = segment_size - overlap;
+    self->num_bins = segment_size / 2 + 1;
+    self->fs = fs;
+    self->alpha = alpha;
+    self->scale = 1.0f / (fs * segment_size *
+                          dsbuffer_window_power_gain (self->buffer));
+
+    self->spectrum =
+        (dsbuffer_complex *) malloc (sizeof (dsbuffer_complex) * self->num_bins);
+    assert (self->spectrum);
+    self->psd = (float *) calloc (self->num_bins, sizeof (float));
+    assert (self->psd);
+
+    self->countdown = segment_size;
+    self->num_segments = 0;
+
+    return self;
+}
+
+
+bool welch_push (welch_t *self, float new_value) {
+    assert (self);
+    dsbuffer_push (self->buffer, new_value);
+    if (--self->countdown > 0)
+        return false;
+    self->countdown = self->hop_size;
+    welch_add_segment (self);
+    return true;
+}
+
+
+size_t welch_num_bins (welch_t *self) {
+    assert (self);
+    return self->num_bins;
+}
+
+
+size_t welch_num_segments (welch_t *self) {
+    assert (self);
+    return self->num_segments;
+}
+
+
+void welch_psd (welch_t *self, float *output) {
+    assert (self);
+    assert (output);
+    memcpy (output, self->psd, sizeof (float) * self->num_bins);
+}
+
+
+void welch_freq (welch_t *self, float *output) {
+    assert (self);
+    assert (output);
+    dsbuffer_fft_freq (self->buffer, self->fs, output);
+}
+
+
+void welch_clear (welch_t *self) {
+    assert (self);
+    dsbuffer_clear (self->buffer);
+    memset (self->psd, 0, sizeof (float) * self->num_bins);
+    self->countdown = self->segment_size;
+    self->num_segments = 0;
+}
+
+
+void welch_free (welch_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        welch_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void welch_free_unsafe (welch_t *self) {
+    assert (self);
+    dsbuffer_free (&self->buffer);
+    free (self->spectrum);
+    free (self->psd);
+    free (self);
+}
+
+
+void welch_test (void) {
+    // White noise of variance 1/12: PSD is flat at 2*(1/12)/fs one-sided,
+    // and integrates back to the variance.
+    size_t segment_size = 128;
+    float fs = 50.0;
+    welch_t *welch = welch_new (segment_size, segment_size / 2,
+                                WINDOW_HANN, 0, fs, 0);
+    assert (welch);
+
+    size_t num_samples = 64 * 1024;
+    for (size_t t = 0; t < num_samples; t++)
+        welch_push (welch, (float) rand () / RAND_MAX - 0.5f);
+    assert (welch_num_segments (welch) ==
+            (num_samples - segment_size) / (segment_size / 2) + 1);
+
+    size_t num_bins = welch_num_bins (welch);
+    float *psd = (float *) malloc (sizeof (float) * num_bins);
+    float *freq = (float *) malloc (sizeof (float) * num_bins);
+    assert (psd && freq);
+    welch_psd (welch, psd);
+    welch_freq (welch, freq);
+
+    float power = 0;
+    for (size_t k = 0; k < num_bins; k++)
+        power += psd[k] * (freq[1] - freq[0]);
+    assert (fabsf (power - 1.0f / 12) < 0.01f);
+    assert (fabsf (psd[num_bins / 2] - 2.0f / 12 / fs) < 0.2f * 2.0f / 12 / fs);
+
+    // exponential averaging follows a level change
+    welch_t *ewelch = welch_new (segment_size, 0, WINDOW_RECTANGULAR, 0, fs, 0.5);
+    assert (ewelch);
+    for (size_t t = 0; t < segment_size * 20; t++)
+        welch_push (ewelch, t < segment_size * 10 ? 1.0f : 2.0f);
+    welch_psd (ewelch, psd);
+    // DC bin of constant c: (c*N)^2 / (fs*N) = c^2*N/fs
+    assert (fabsf (psd[0] - 4.0f * segment_size / fs) < 1e-2f * psd[0]);
+
+    free (psd);
+    free (freq);
+    welch_free (&welch);
+    welch_free (&ewelch);
+    printf ("OK\n");
+}
@@ -0,0 +1,69 @@
+/*  =========================================================================
+    welch - streaming Welch power spectral density estimator
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __WELCH_H__
+#define __WELCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "window.h"
+
+typedef struct _welch_t welch_t;
+
+// Create a new welch object.
+// Every (segment_size - overlap) pushed samples, the periodogram of the
+// latest segment_size samples is computed once and added to the average.
+// Set alpha to 0 to average all segments equally, or in (0, 1] for an
+// exponentially weighted average where the newest segment has weight alpha.
+// segment_size must be even. window_param is beta for Kaiser window.
+welch_t *welch_new (size_t segment_size,
+                    size_t overlap,
+                    window_type window,
+                    float window_param,
+                    float fs,
+                    float alpha);
+
+// Destroy welch object
+void welch_free (welch_t **self_p);
+
+// Destroy welch object
+void welch_free_unsafe (welch_t *self);
+
+// Add new value. Return true if a new segment was averaged.
+bool welch_push (welch_t *self, float new_value);
+
+// Number of frequency bins, i.e. segment_size/2+1
+size_t welch_num_bins (welch_t *self);
+
+// Number of segments averaged so far
+size_t welch_num_segments (welch_t *self);
+
+// Get averaged one-sided PSD (no work other than copying).
+// Return results in param output (segment_size/2+1 points)
+void welch_psd (welch_t *self, float *output);
+
+// Get PSD frequencies
+// Return results in param output (segment_size/2+1 points)
+void welch_freq (welch_t *self, float *output);
+
+// Reset to zero data and no segments
+void welch_clear (welch_t *self);
+
+// Self test
+void welch_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
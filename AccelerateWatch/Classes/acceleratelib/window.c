@@ -0,0 +1,105 @@
+/*  =========================================================================
+    window - window functions for spectral analysis
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <assert.h>
+
+#include "window.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+// Generalized cosine window: sum_k (-1)^k a[k] cos(2*pi*k*n/N)
+static void window_cosine_sum (const double *a, size_t num_terms,
+                               size_t size, float *output) {
+    for (size_t n = 0; n < size; n++) {
+        double x = 2 * M_PI * n / size;
+        double w = 0.0, sign = 1.0;
+        for (size_t k = 0; k < num_terms; k++) {
+            w += sign * a[k] * cos (k * x);
+            sign = -sign;
+        }
+        output[n] = (float) w;
+    }
+}
+
+
+// Zeroth order modified Bessel function of the first kind (power series)
+static double window_bessel_i0 (double x) {
+    double sum = 1.0, term = 1.0, q = x * x / 4.0;
+    for (int k = 1; k < 50; k++) {
+        term *= q / ((double) k * k);
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+
+void window_fill (window_type type, size_t size, float param, float *output) {
+    assert (output);
+
+    static const double hann[] = {0.5, 0.5};
+    static const double hamming[] = {0.54, 0.46};
+    static const double blackman_harris[] = {0.35875, 0.48829, 0.14128, 0.01168};
+    static const double flat_top[] = {0.21557895, 0.41663158, 0.277263158,
+                                      0.083578947, 0.006947368};
+
+    switch (type) {
+        case WINDOW_HANN:
+            window_cosine_sum (hann, 2, size, output);
+            break;
+        case WINDOW_HAMMING:
+            window_cosine_sum (hamming, 2, size, output);
+            break;
+        case WINDOW_BLACKMAN_HARRIS:
+            window_cosine_sum (blackman_harris, 4, size, output);
+            break;
+        case WINDOW_FLAT_TOP:
+            window_cosine_sum (flat_top, 5, size, output);
+            break;
+        case WINDOW_KAISER: {
+            double denom = window_bessel_i0 (param);
+            for (size_t n = 0; n < size; n++) {
+                double r = 2.0 * n / size - 1.0;
+                output[n] = (float) (window_bessel_i0 (param * sqrt (1 - r * r)) / denom);
+            }
+            break;
+        }
+        case WINDOW_RECTANGULAR:
+        default:
+            for (size_t n = 0; n < size; n++)
+                output[n] = 1.0;
+            break;
+    }
+}
+
+
+float window_coherent_gain (const float *window, size_t size) {
+    assert (window);
+    assert (size > 0);
+    double sum = 0.0;
+    for (size_t n = 0; n < size; n++)
+        sum += window[n];
+    return (float) (sum / size);
+}
+
+
+float window_power_gain (const float *window, size_t size) {
+    assert (window);
+    assert (size > 0);
+    double ss = 0.0;
+    for (size_t n = 0; n < size; n++)
+        ss += window[n] * window[n];
+    return (float) (ss / size);
+}
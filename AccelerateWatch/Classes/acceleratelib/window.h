@@ -0,0 +1,46 @@
+/*  =========================================================================
+    window - window functions for spectral analysis
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __WINDOW_H__
+#define __WINDOW_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum {
+    WINDOW_RECTANGULAR = 0,
+    WINDOW_HANN,
+    WINDOW_HAMMING,
+    WINDOW_BLACKMAN_HARRIS, // 4-term, -92 dB sidelobes
+    WINDOW_KAISER,          // shape set by param beta
+    WINDOW_FLAT_TOP         // for amplitude-accurate peaks
+} window_type;
+
+// Generate window coefficients.
+// Periodic (DFT-even) windows are generated, as suited for spectral analysis.
+// param is beta for Kaiser window, and is ignored by the others.
+// Return results in param output (size points).
+void window_fill (window_type type, size_t size, float param, float *output);
+
+// Coherent gain of window, i.e. mean(w).
+// Divide amplitude spectra by it to read sinusoid amplitudes correctly.
+float window_coherent_gain (const float *window, size_t size);
+
+// Power gain of window, i.e. mean(w^2).
+// Divide power spectral density by it to keep noise power correct.
+float window_power_gain (const float *window, size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
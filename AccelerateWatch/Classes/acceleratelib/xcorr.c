@@ -0,0 +1,276 @@
+/*  =========================================================================
+    xcorr - cross-correlation and lag estimation between two signals
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "xcorr.h"
+#include "vectorf.h"
+#include "kissfft/kiss_fftr.h"
+
+
+struct _xcorr_t {
+    size_t size;
+    size_t max_lag;
+    bool use_fft;
+
+    // for FFT method
+    size_t nfft; // zero padded size >= size + max_lag
+    kiss_fftr_cfg fft_cfg;
+    kiss_fftr_cfg ifft_cfg;
+    kiss_fft_cpx *x_spectrum; // nfft/2+1 points
+    kiss_fft_cpx *y_spectrum; // nfft/2+1 points
+
+    // nfft (FFT method) or size (direct method) points of scratch
+    float *x_data;
+    float *y_data;
+
+    float *correlation; // 2*max_lag+1 points, for lag estimation
+};
+
+
+// Rough operation count of both methods
+static bool xcorr_fft_is_cheaper (size_t size, size_t max_lag, size_t nfft) {
+    double direct_cost = (double) size * (2 * max_lag + 1);
+    double fft_cost = 3.0 * nfft * (log2 ((double) nfft) + 2);
+    return fft_cost < direct_cost;
+}
+
+
+static void xcorr_compute_fft (xcorr_t *self, float *output) {
+    size_t nfft = self->nfft;
+    memset (self->x_data + self->size, 0, sizeof (float) * (nfft - self->size));
+    memset (self->y_data + self->size, 0, sizeof (float) * (nfft - self->size));
+
+    kiss_fftr (self->fft_cfg, self->x_data, self->x_spectrum);
+    kiss_fftr (self->fft_cfg, self->y_data, self->y_spectrum);
+
+    // conj(X) * Y, scaled for the inverse transform
+    float scale = 1.0f / nfft;
+    for (size_t k = 0; k < nfft/2+1; k++) {
+        kiss_fft_cpx a = self->x_spectrum[k], b = self->y_spectrum[k];
+        self->y_spectrum[k].r = (a.r * b.r + a.i * b.i) * scale;
+        self->y_spectrum[k].i = (a.r * b.i - a.i * b.r) * scale;
+    }
+    kiss_fftri (self->ifft_cfg, self->y_spectrum, self->x_data);
+
+    // positive lags at the start, negative lags wrapped to the end
+    output[self->max_lag] = self->x_data[0];
+    for (size_t k = 1; k <= self->max_lag; k++) {
+        output[self->max_lag + k] = self->x_data[k];
+        output[self->max_lag - k] = self->x_data[nfft - k];
+    }
+}
+
+
+static void xcorr_compute_direct (xcorr_t *self,
+                                  const float *x,
+                                  const float *y,
+                                  float *output) {
+    size_t n = self->size;
+    output[self->max_lag] = vectorf_dot_product (x, y, n);
+    for (size_t k = 1; k <= self->max_lag; k++) {
+        output[self->max_lag + k] = (k < n) ? vectorf_dot_product (x, y + k, n - k) : 0;
+        output[self->max_lag - k] = (k < n) ? vectorf_dot_product (x + k, y, n - k) : 0;
+    }
+}
+
+
+// Argmax with parabolic refinement
+static float xcorr_peak (xcorr_t *self, const float *r, float *peak_value) {
+    size_t num_lags = 2 * self->max_lag + 1;
+    size_t best = 0;
+    for (size_t k = 1; k < num_lags; k++)
+        if (r[k] > r[best])
+            best = k;
+
+    float delta = 0, value = r[best];
+    if (best > 0 && best + 1 < num_lags) {
+        float a = r[best-1], b = r[best], c = r[best+1];
+        float denom = a - 2 * b + c;
+        if (denom != 0) {
+            delta = 0.5f * (a - c) / denom;
+            value = b - 0.25f * (a - c) * delta;
+        }
+    }
+    if (peak_value)
+        *peak_value = value;
+    return (float) best - (float) self->max_lag + delta;
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+xcorr_t *xcorr_new (size_t size, size_t max_lag, xcorr_method method) {
+    assert (size > 0);
+
+    xcorr_t *self = (xcorr_t *) malloc (sizeof (xcorr_t));
+    assert (self);
+
+    self->size = size;
+    self->max_lag = max_lag;
+    self->nfft = kiss_fftr_next_fast_size_real ((int) (size + max_lag));
+    self->use_fft = (method == XCORR_FFT) ||
+                    (method == XCORR_AUTO &&
+                     xcorr_fft_is_cheaper (size, max_lag, self->nfft));
+
+    self->fft_cfg = NULL;
+    self->ifft_cfg = NULL;
+    self->x_spectrum = NULL;
+    self->y_spectrum = NULL;
+
+    size_t data_size = size;
+    if (self->use_fft) {
+        data_size = self->nfft;
+        self->fft_cfg = kiss_fftr_alloc ((int) self->nfft, 0, NULL, NULL);
+        self->ifft_cfg = kiss_fftr_alloc ((int) self->nfft, 1, NULL, NULL);
+        assert (self->fft_cfg && self->ifft_cfg);
+        self->x_spectrum =
+            (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * (self->nfft/2+1));
+        self->y_spectrum =
+            (kiss_fft_cpx *) malloc (sizeof (kiss_fft_cpx) * (self->nfft/2+1));
+        assert (self->x_spectrum && self->y_spectrum);
+    }
+    self->x_data = (float *) malloc (sizeof (float) * data_size);
+    self->y_data = (float *) malloc (sizeof (float) * data_size);
+    self->correlation = (float *) malloc (sizeof (float) * (2 * max_lag + 1));
+    assert (self->x_data && self->y_data && self->correlation);
+
+    return self;
+}
+
+
+bool xcorr_uses_fft (xcorr_t *self) {
+    assert (self);
+    return self->use_fft;
+}
+
+
+void xcorr_compute (xcorr_t *self, const float *x, const float *y, float *output) {
+    assert (self);
+    assert (x);
+    assert (y);
+    assert (output);
+
+    if (self->use_fft) {
+        memcpy (self->x_data, x, sizeof (float) * self->size);
+        memcpy (self->y_data, y, sizeof (float) * self->size);
+        xcorr_compute_fft (self, output);
+    }
+    else
+        xcorr_compute_direct (self, x, y, output);
+}
+
+
+void xcorr_compute_buffers (xcorr_t *self, dsbuffer_t *x, dsbuffer_t *y, float *output) {
+    assert (self);
+    assert (x);
+    assert (y);
+    assert (output);
+    assert (dsbuffer_size (x) == self->size);
+    assert (dsbuffer_size (y) == self->size);
+
+    dsbuffer_dump (x, self->x_data);
+    dsbuffer_dump (y, self->y_data);
+    if (self->use_fft)
+        xcorr_compute_fft (self, output);
+    else
+        xcorr_compute_direct (self, self->x_data, self->y_data, output);
+}
+
+
+float xcorr_best_lag (xcorr_t *self, const float *x, const float *y, float *peak_value) {
+    assert (self);
+    xcorr_compute (self, x, y, self->correlation);
+    return xcorr_peak (self, self->correlation, peak_value);
+}
+
+
+float xcorr_best_lag_buffers (xcorr_t *self, dsbuffer_t *x, dsbuffer_t *y, float *peak_value) {
+    assert (self);
+    xcorr_compute_buffers (self, x, y, self->correlation);
+    return xcorr_peak (self, self->correlation, peak_value);
+}
+
+
+void xcorr_free (xcorr_t **self_p) {
+    assert (self_p);
+    if (*self_p) {
+        xcorr_free_unsafe (*self_p);
+        *self_p = NULL;
+    }
+}
+
+
+void xcorr_free_unsafe (xcorr_t *self) {
+    assert (self);
+    if (self->fft_cfg)
+        kiss_fftr_free (self->fft_cfg);
+    if (self->ifft_cfg)
+        kiss_fftr_free (self->ifft_cfg);
+    free (self->x_spectrum);
+    free (self->y_spectrum);
+    free (self->x_data);
+    free (self->y_data);
+    free (self->correlation);
+    free (self);
+}
+
+
+void xcorr_test (void) {
+    // y is x delayed by 7.3 samples
+    size_t size = 200, max_lag = 20;
+    float *x = (float *) malloc (sizeof (float) * size);
+    float *y = (float *) malloc (sizeof (float) * size);
+    float *r_direct = (float *) malloc (sizeof (float) * (2 * max_lag + 1));
+    float *r_fft = (float *) malloc (sizeof (float) * (2 * max_lag + 1));
+    assert (x && y && r_direct && r_fft);
+    for (size_t t = 0; t < size; t++) {
+        x[t] = expf (-powf ((t - 80.0f) / 6, 2));
+        y[t] = expf (-powf ((t - 87.3f) / 6, 2));
+    }
+
+    xcorr_t *direct = xcorr_new (size, max_lag, XCORR_DIRECT);
+    xcorr_t *fft = xcorr_new (size, max_lag, XCORR_FFT);
+    assert (direct && fft);
+    assert (!xcorr_uses_fft (direct) && xcorr_uses_fft (fft));
+
+    xcorr_compute (direct, x, y, r_direct);
+    xcorr_compute (fft, x, y, r_fft);
+    for (size_t k = 0; k < 2 * max_lag + 1; k++)
+        assert (fabsf (r_direct[k] - r_fft[k]) < 1e-4);
+
+    assert (fabsf (xcorr_best_lag (direct, x, y, NULL) - 7.3f) < 0.1f);
+    assert (fabsf (xcorr_best_lag (fft, x, y, NULL) - 7.3f) < 0.1f);
+    assert (fabsf (xcorr_best_lag (fft, y, x, NULL) + 7.3f) < 0.1f);
+
+    // buffers, one of them wrapped around
+    dsbuffer_t *bx = dsbuffer_new (size, false);
+    dsbuffer_t *by = dsbuffer_new (size, true);
+    assert (bx && by);
+    for (size_t t = 0; t < size; t++)
+        dsbuffer_push (bx, x[t]);
+    for (size_t t = 0; t < 2 * size; t++)
+        dsbuffer_push (by, y[t % size]);
+    assert (fabsf (xcorr_best_lag_buffers (fft, bx, by, NULL) - 7.3f) < 0.1f);
+    assert (fabsf (xcorr_best_lag_buffers (direct, bx, by, NULL) - 7.3f) < 0.1f);
+
+    dsbuffer_free (&bx);
+    dsbuffer_free (&by);
+    xcorr_free (&direct);
+    xcorr_free (&fft);
+    free (x);
+    free (y);
+    free (r_direct);
+    free (r_fft);
+    printf ("OK\n");
+}
@@ -0,0 +1,64 @@
+/*  =========================================================================
+    xcorr - cross-correlation and lag estimation between two signals
+
+    Copyright (c) 2016, Yang LIU <gloolar [at] gmail [dot] com>
+    =========================================================================
+*/
+
+#ifndef __XCORR_H__
+#define __XCORR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "dsbuffer.h"
+
+typedef struct _xcorr_t xcorr_t;
+
+typedef enum {
+    XCORR_AUTO = 0, // pick the cheaper of the two below
+    XCORR_DIRECT,   // one dot product per lag, O(N * lags)
+    XCORR_FFT       // zero padded FFT, O(N log N)
+} xcorr_method;
+
+// Create a new xcorr object for signals of size points and lags within
+// [-max_lag, max_lag]. Plans and scratch are allocated here and reused.
+xcorr_t *xcorr_new (size_t size, size_t max_lag, xcorr_method method);
+
+// Destroy xcorr object
+void xcorr_free (xcorr_t **self_p);
+
+// Destroy xcorr object
+void xcorr_free_unsafe (xcorr_t *self);
+
+// Whether FFT method is used
+bool xcorr_uses_fft (xcorr_t *self);
+
+// Cross-correlation r[k] = sum_t x[t] * y[t+k] for k = -max_lag ... max_lag.
+// Return results in param output (2*max_lag+1 points, output[max_lag] is
+// lag 0). A positive peak lag means y is delayed relative to x.
+void xcorr_compute (xcorr_t *self, const float *x, const float *y, float *output);
+
+// Same as xcorr_compute on the data of two buffers of size points
+void xcorr_compute_buffers (xcorr_t *self, dsbuffer_t *x, dsbuffer_t *y, float *output);
+
+// Lag of maximum cross-correlation, refined to sub-sample by parabolic
+// interpolation. Maximum value is returned in param peak_value if not NULL.
+float xcorr_best_lag (xcorr_t *self, const float *x, const float *y, float *peak_value);
+
+// Same as xcorr_best_lag on the data of two buffers of size points
+float xcorr_best_lag_buffers (xcorr_t *self, dsbuffer_t *x, dsbuffer_t *y, float *peak_value);
+
+// Self test
+void xcorr_test (void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif